@@ -6,15 +6,25 @@
 #define WSONTEST_BENCH_H
 
 #include <time.h>
+#include <stdint.h>
 
 namespace bench{
 
+   /**
+    * monotonic, not affected by wall clock adjust
+    * */
    inline double now_ms(void) {
         struct timespec res;
-        clock_gettime(CLOCK_REALTIME, &res);
+        clock_gettime(CLOCK_MONOTONIC, &res);
         return 1000.0 * res.tv_sec + (double) res.tv_nsec / 1e6;
     }
 
+   inline uint64_t now_ns(void) {
+        struct timespec res;
+        clock_gettime(CLOCK_MONOTONIC, &res);
+        return 1000000000ULL * res.tv_sec + res.tv_nsec;
+    }
+
 }
 
 
@@ -0,0 +1,151 @@
+//
+// parallel batch decoder test
+//
+
+#include "wson/wson.h"
+#include "wson/wson_parser.h"
+#include "wson/wson_batch_decoder.h"
+#include "bench.h"
+#include <stdio.h>
+#include <atomic>
+
+
+static void push_record(wson_buffer* buffer, int i){
+    uint16_t key[2] = {'i', 'd'};
+    uint16_t tags[4] = {'t', 'a', 'g', 's'};
+    wson_push_type_map(buffer, 2);
+    wson_push_property(buffer, key, sizeof(key));
+    wson_push_type_int(buffer, i);
+    wson_push_property(buffer, tags, sizeof(tags));
+    wson_push_type_array(buffer, 3);
+    wson_push_type_double(buffer, i*0.5);
+    wson_push_type_boolean(buffer, i % 2);
+    wson_push_type_string(buffer, tags, sizeof(tags));
+}
+
+static int record_id(wson_parser& parser){
+    int id = -1;
+    uint8_t type = parser.nextType();
+    if(!parser.isMap(type)){
+        parser.skipValue(type);
+        return id;
+    }
+    int size = parser.nextMapSize();
+    for(int i=0; i<size; i++){
+        std::string key = parser.nextMapKeyUTF8();
+        uint8_t valueType = parser.nextType();
+        if(key == "id"){
+            id = (int)parser.nextNumber(valueType);
+        }else{
+            parser.skipValue(valueType);
+        }
+    }
+    return id;
+}
+
+void test_batch_container(){
+    int count = 20000;
+    wson_buffer* buffer = wson_buffer_new();
+    wson_push_type_array(buffer, count);
+    for(int i=0; i<count; i++){
+        push_record(buffer, i);
+    }
+    wson_thread_pool pool(4);
+    wson_batch_decoder decoder(&pool, 4096);
+    uint64_t expect = 0;
+    bool inOrder = true;
+    bool success = decoder.decode<int>((const char*)buffer->data, buffer->position, WSON_BATCH_CONTAINER, record_id,
+                                       [&](uint64_t index, int& id){
+        if(index != expect || id != (int)index){
+            inOrder = false;
+        }
+        expect++;
+    }, true);
+    if(success && inOrder && expect == (uint64_t)count){
+        printf("pass test_batch_container \n");
+    }else{
+        printf("failed test_batch_container %d %d \n", success, (int)expect);
+    }
+    wson_buffer_free(buffer);
+}
+
+void test_batch_record_stream(){
+    int count = 20000;
+    wson_buffer* buffer = wson_buffer_new();
+    for(int i=0; i<count; i++){
+        push_record(buffer, i);
+    }
+    wson_thread_pool pool(4);
+    wson_batch_decoder decoder(&pool, 4096);
+    std::vector<std::string> jsons(count);
+    std::atomic<int> delivered(0);
+    double start = bench::now_ms();
+    bool success = decoder.toJSON((const char*)buffer->data, buffer->position, WSON_BATCH_RECORD_STREAM,
+                                  [&](uint64_t index, std::string& json){
+        jsons[index].swap(json);
+        delivered++;
+    }, false);
+    double used = bench::now_ms() - start;
+
+    wson_parser parser((const char*)buffer->data, buffer->position);
+    for(int i=0; i<count; i++){
+        if(parser.nextStringUTF8(parser.nextType()) != jsons[i]){
+            success = false;
+        }
+    }
+    if(success && delivered == count && decoder.recordCount() == (uint64_t)count){
+        printf("pass test_batch_record_stream used %f ms \n", used);
+    }else{
+        printf("failed test_batch_record_stream %d %d \n", success, delivered.load());
+    }
+
+    buffer->position -= 3;
+    if(decoder.toJSON((const char*)buffer->data, buffer->position, WSON_BATCH_RECORD_STREAM,
+                      [](uint64_t, std::string&){}, true)){
+        printf("failed test_batch_record_stream truncated \n");
+    }
+    wson_buffer_free(buffer);
+}
+
+/**
+ * decode and wait from inside a task of single thread pool, caller must help instead of deadlock
+ * */
+void test_batch_nested(){
+    int count = 2000;
+    wson_buffer* buffer = wson_buffer_new();
+    wson_push_type_array(buffer, count);
+    for(int i=0; i<count; i++){
+        push_record(buffer, i);
+    }
+    wson_thread_pool pool(1);
+    wson_batch_decoder decoder(&pool, 512);
+    std::atomic<int> delivered(0);
+    std::atomic<int> nested(0);
+    bool success = false;
+    pool.submit([&]{
+        success = decoder.decode<int>((const char*)buffer->data, buffer->position, WSON_BATCH_CONTAINER, record_id,
+                                      [&](uint64_t, int&){
+            delivered++;
+        }, true);
+        for(int i=0; i<8; i++){
+            pool.submit([&]{
+                nested++;
+            });
+        }
+        pool.wait();
+    });
+    pool.wait();
+    if(success && delivered == count && nested == 8){
+        printf("pass test_batch_nested \n");
+    }else{
+        printf("failed test_batch_nested %d %d %d \n", success, delivered.load(), nested.load());
+    }
+    wson_buffer_free(buffer);
+}
+
+int main(){
+    test_batch_container();
+    test_batch_record_stream();
+    test_batch_nested();
+    return 0;
+}
@@ -0,0 +1,508 @@
+//
+// benchmark over real corpora, result json can be diffed between runs to catch regression.
+// usage: wson_bench [--json file] [--repeat n] [--min-ms ms] [--sweep] [--sweep-size 1M] [file.wson ...]
+// --sweep run generated documents along depth, fan-out, string length, script and number type instead of corpora.
+//
+
+#include "wson/wson.h"
+#include "wson/wson_parser.h"
+#include "wson/wson_util.h"
+#include "bench.h"
+#include "wson_generator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef WSON_CORPUS_DIR
+#define WSON_CORPUS_DIR "../java/src/test/resources"
+#endif
+
+/**
+ * count heap allocation. wson_buffer and parser use malloc and realloc, on glibc they are
+ * interposed and counted, operator new goes through the counted malloc. other libc only
+ * count c++ new, allocs_per_op then misses buffer growth.
+ * */
+static uint64_t allocations = 0;
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) noexcept{
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept{
+    allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept{
+    allocations++;
+    return __libc_realloc(ptr, size);
+}
+}
+#define WSON_BENCH_COUNT_NEW  0
+#else
+#define WSON_BENCH_COUNT_NEW  1
+#endif
+
+void* operator new(size_t size){
+    if(WSON_BENCH_COUNT_NEW){
+        allocations++;
+    }
+    void* ptr = malloc(size > 0 ? size : 1);
+    if(!ptr){
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept{
+    free(ptr);
+}
+
+static volatile uint64_t sink = 0;
+
+struct bench_options {
+    int repeat = 7;
+    double minMs = 50;
+    const char* json = nullptr;
+    bool sweep = false;
+    uint64_t sweepSize = 1024*1024;
+};
+
+struct bench_result {
+    std::string corpus;
+    std::string name;
+    uint64_t bytes;
+    uint64_t iterations;
+    double nsPerOp;
+    double minNsPerOp;
+    double maxNsPerOp;
+    double mbPerSecond;
+    double allocsPerOp;
+};
+
+struct bench_corpus {
+    std::string name;
+    std::vector<char> data;
+};
+
+/**
+ * decoded value, used as encode input
+ * */
+struct bench_value {
+    uint8_t type;
+    int64_t integer;
+    double number;
+    std::vector<uint8_t> bytes;
+    std::vector<std::vector<uint8_t>> keys;
+    std::vector<bench_value> children;
+};
+
+static bool read_file(const std::string& path, std::vector<char>& data){
+    FILE* file = fopen(path.c_str(), "rb");
+    if(!file){
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data.resize(size > 0 ? size : 0);
+    bool success = fread(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    return success;
+}
+
+/**
+ * run func in batch, batch is doubled until it takes minMs, which is also warmup,
+ * then repeat batch, median ns per op is reported
+ * */
+template<typename Func>
+static bench_result run_bench(const bench_corpus& corpus, const char* name, uint64_t bytes,
+                              const bench_options& options, Func func){
+    uint64_t iterations = 1;
+    while(true){
+        uint64_t start = bench::now_ns();
+        for(uint64_t i=0; i<iterations; i++){
+            func();
+        }
+        double used = (bench::now_ns() - start)/1e6;
+        if(used >= options.minMs || iterations >= (1ULL << 30)){
+            break;
+        }
+        iterations *= 2;
+    }
+    std::vector<double> samples;
+    uint64_t allocationCount = 0;
+    for(int r=0; r<options.repeat; r++){
+        uint64_t startAllocations = allocations;
+        uint64_t start = bench::now_ns();
+        for(uint64_t i=0; i<iterations; i++){
+            func();
+        }
+        uint64_t used = bench::now_ns() - start;
+        allocationCount += allocations - startAllocations;
+        samples.push_back((double)used/iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+    bench_result result;
+    result.corpus = corpus.name;
+    result.name = name;
+    result.bytes = bytes;
+    result.iterations = iterations;
+    result.nsPerOp = samples[samples.size()/2];
+    result.minNsPerOp = samples.front();
+    result.maxNsPerOp = samples.back();
+    result.mbPerSecond = bytes/(1024.0*1024.0)/(result.nsPerOp/1e9);
+    result.allocsPerOp = (double)allocationCount/(iterations*options.repeat);
+    printf("%-24s %-14s %12.1f ns/op %10.2f MB/s %8.2f allocs/op \n", result.corpus.c_str(), name,
+           result.nsPerOp, result.mbPerSecond, result.allocsPerOp);
+    return result;
+}
+
+static void read_value(wson_buffer* buffer, bench_value& value){
+    value.type = (uint8_t)wson_next_type(buffer);
+    value.integer = 0;
+    value.number = 0;
+    switch (value.type) {
+        case WSON_STRING_TYPE:
+        case WSON_NUMBER_BIG_INT_TYPE:
+        case WSON_NUMBER_BIG_DECIMAL_TYPE:
+        case WSON_EXTEND_TYPE:{
+                uint32_t length = wson_next_uint(buffer);
+                uint8_t* bytes = wson_next_bts(buffer, length);
+                value.bytes.assign(bytes, bytes + length);
+            }
+            break;
+        case WSON_NUMBER_INT_TYPE:
+            value.integer = wson_next_int(buffer);
+            break;
+        case WSON_NUMBER_LONG_TYPE:
+            value.integer = wson_next_long(buffer);
+            break;
+        case WSON_NUMBER_FLOAT_TYPE:
+            value.number = wson_next_float(buffer);
+            break;
+        case WSON_NUMBER_DOUBLE_TYPE:
+            value.number = wson_next_double(buffer);
+            break;
+        case WSON_MAP_TYPE:{
+                uint32_t count = wson_next_uint(buffer);
+                value.keys.resize(count);
+                value.children.resize(count);
+                for(uint32_t i=0; i<count; i++){
+                    uint32_t length = wson_next_uint(buffer);
+                    uint8_t* key = wson_next_bts(buffer, length);
+                    value.keys[i].assign(key, key + length);
+                    read_value(buffer, value.children[i]);
+                }
+            }
+            break;
+        case WSON_ARRAY_TYPE:{
+                uint32_t count = wson_next_uint(buffer);
+                value.children.resize(count);
+                for(uint32_t i=0; i<count; i++){
+                    read_value(buffer, value.children[i]);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void encode_value(wson_buffer* buffer, const bench_value& value){
+    switch (value.type) {
+        case WSON_STRING_TYPE:
+            wson_push_type_string(buffer, value.bytes.data(), (int32_t)value.bytes.size());
+            break;
+        case WSON_NUMBER_BIG_INT_TYPE:
+        case WSON_NUMBER_BIG_DECIMAL_TYPE:
+            wson_push_type(buffer, value.type);
+            wson_push_uint(buffer, (uint32_t)value.bytes.size());
+            wson_push_bytes(buffer, value.bytes.data(), (int32_t)value.bytes.size());
+            break;
+        case WSON_EXTEND_TYPE:
+            wson_push_type_extend(buffer, value.bytes.data(), (int32_t)value.bytes.size());
+            break;
+        case WSON_NUMBER_INT_TYPE:
+            wson_push_type_int(buffer, (int32_t)value.integer);
+            break;
+        case WSON_NUMBER_LONG_TYPE:
+            wson_push_type_long(buffer, value.integer);
+            break;
+        case WSON_NUMBER_FLOAT_TYPE:
+            wson_push_type_float(buffer, (float)value.number);
+            break;
+        case WSON_NUMBER_DOUBLE_TYPE:
+            wson_push_type_double(buffer, value.number);
+            break;
+        case WSON_MAP_TYPE:
+            wson_push_type_map(buffer, (uint32_t)value.children.size());
+            for(size_t i=0; i<value.children.size(); i++){
+                wson_push_property(buffer, value.keys[i].data(), (int32_t)value.keys[i].size());
+                encode_value(buffer, value.children[i]);
+            }
+            break;
+        case WSON_ARRAY_TYPE:
+            wson_push_type_array(buffer, (uint32_t)value.children.size());
+            for(size_t i=0; i<value.children.size(); i++){
+                encode_value(buffer, value.children[i]);
+            }
+            break;
+        case WSON_BOOLEAN_TYPE_TRUE:
+        case WSON_BOOLEAN_TYPE_FALSE:
+        case WSON_NULL_TYPE:
+            wson_push_type(buffer, value.type);
+            break;
+        default:
+            wson_push_type_null(buffer);
+            break;
+    }
+}
+
+static void collect_strings(const bench_value& value, std::vector<const std::vector<uint8_t>*>& strings){
+    if(value.type == WSON_STRING_TYPE){
+        strings.push_back(&value.bytes);
+    }
+    for(size_t i=0; i<value.keys.size(); i++){
+        strings.push_back(&value.keys[i]);
+    }
+    for(size_t i=0; i<value.children.size(); i++){
+        collect_strings(value.children[i], strings);
+    }
+}
+
+/**
+ * walk every value, string is converted to utf-8 like a real consumer
+ * */
+static uint64_t decode_value(wson_parser& parser){
+    uint8_t type = parser.nextType();
+    uint64_t sum = 0;
+    if(parser.isMap(type)){
+        int size = parser.nextMapSize();
+        for(int i=0; i<size; i++){
+            sum += parser.nextMapKeyUTF8().size();
+            sum += decode_value(parser);
+        }
+    }else if(parser.isArray(type)){
+        int size = parser.nextArraySize();
+        for(int i=0; i<size; i++){
+            sum += decode_value(parser);
+        }
+    }else if(parser.isString(type)){
+        sum += parser.nextStringUTF8(type).size();
+    }else if(parser.isNumber(type)){
+        sum += (uint64_t)parser.nextNumber(type);
+    }else if(parser.isBool(type)){
+        sum += parser.nextBool(type);
+    }else{
+        parser.skipValue(type);
+    }
+    return sum;
+}
+
+static void bench_corpus_all(const bench_corpus& corpus, const bench_options& options, std::vector<bench_result>& results){
+    const char* data = corpus.data.data();
+    int length = (int)corpus.data.size();
+    uint64_t bytes = corpus.data.size();
+
+    results.push_back(run_bench(corpus, "decode", bytes, options, [&](){
+        wson_parser parser(data, length);
+        sink += decode_value(parser);
+    }));
+
+    results.push_back(run_bench(corpus, "skip", bytes, options, [&](){
+        wson_parser parser(data, length);
+        parser.skipValue(parser.nextType());
+        sink += parser.getState();
+    }));
+
+    results.push_back(run_bench(corpus, "toJSON", bytes, options, [&](){
+        wson_parser parser(data, length);
+        sink += parser.toStringUTF8().size();
+    }));
+
+    bench_value root;
+    wson_buffer* source = wson_buffer_from((void*)data, length);
+    read_value(source, root);
+    free(source);
+    wson_buffer* buffer = wson_buffer_new();
+    results.push_back(run_bench(corpus, "encode", bytes, options, [&](){
+        buffer->position = 0;
+        encode_value(buffer, root);
+        sink += buffer->position;
+    }));
+    wson_buffer_free(buffer);
+
+    std::vector<const std::vector<uint8_t>*> strings;
+    collect_strings(root, strings);
+    uint64_t utf16Bytes = 0;
+    uint32_t maxLength = 0;
+    for(size_t i=0; i<strings.size(); i++){
+        utf16Bytes += strings[i]->size();
+        maxLength = std::max(maxLength, (uint32_t)strings[i]->size());
+    }
+    std::vector<char> utf8(maxLength*2 + 8);
+    std::vector<uint16_t> utf16(maxLength + 8);
+    std::vector<std::string> utf8Strings;
+    for(size_t i=0; i<strings.size(); i++){
+        int size = wson::utf16_convert_to_utf8_cstr((uint16_t*)strings[i]->data(), (int)strings[i]->size()/2, utf8.data());
+        utf8Strings.push_back(std::string(utf8.data(), size));
+    }
+    results.push_back(run_bench(corpus, "utf16_to_utf8", utf16Bytes, options, [&](){
+        for(size_t i=0; i<strings.size(); i++){
+            sink += wson::utf16_convert_to_utf8_cstr((uint16_t*)strings[i]->data(), (int)strings[i]->size()/2, utf8.data());
+        }
+    }));
+    results.push_back(run_bench(corpus, "utf8_to_utf16", utf16Bytes, options, [&](){
+        for(size_t i=0; i<utf8Strings.size(); i++){
+            sink += wson::utf8_convert_to_utf16(utf8Strings[i].data(), (int)utf8Strings[i].size(), utf16.data());
+        }
+    }));
+}
+
+static bool write_json(const char* path, const std::vector<bench_result>& results){
+    FILE* file = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if(!file){
+        return false;
+    }
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for(size_t i=0; i<results.size(); i++){
+        const bench_result& result = results[i];
+        fprintf(file, "    {\"corpus\": \"%s\", \"name\": \"%s\", \"bytes\": %llu, \"iterations\": %llu, "
+                      "\"ns_per_op\": %.1f, \"min_ns_per_op\": %.1f, \"max_ns_per_op\": %.1f, "
+                      "\"mb_per_s\": %.2f, \"allocs_per_op\": %.2f}%s\n",
+                result.corpus.c_str(), result.name.c_str(), (unsigned long long)result.bytes,
+                (unsigned long long)result.iterations, result.nsPerOp, result.minNsPerOp, result.maxNsPerOp,
+                result.mbPerSecond, result.allocsPerOp, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    if(file != stdout){
+        fclose(file);
+    }
+    return true;
+}
+
+static void add_generated(std::vector<bench_corpus>& corpora, const std::string& name,
+                          const wson_generator_options& options, uint64_t size){
+    wson_generator generator(options);
+    wson_buffer* buffer = wson_buffer_new();
+    generator.generate(buffer, size);
+    bench_corpus corpus;
+    corpus.name = name;
+    corpus.data.assign((char*)buffer->data, (char*)buffer->data + buffer->position);
+    corpora.push_back(corpus);
+    wson_buffer_free(buffer);
+}
+
+/**
+ * one dimension changed at a time, others keep generator default
+ * */
+static void add_sweep(std::vector<bench_corpus>& corpora, uint64_t size){
+    char name[64];
+    int depths[] = {1, 2, 4, 8, 16};
+    for(int depth : depths){
+        wson_generator_options options;
+        options.depth = depth;
+        options.fanout = 4;
+        snprintf(name, sizeof(name), "gen_depth_%d", depth);
+        add_generated(corpora, name, options, size);
+    }
+    int fanouts[] = {2, 8, 32, 128};
+    for(int fanout : fanouts){
+        wson_generator_options options;
+        options.depth = 2;
+        options.fanout = fanout;
+        snprintf(name, sizeof(name), "gen_fanout_%d", fanout);
+        add_generated(corpora, name, options, size);
+    }
+    int stringLengths[] = {4, 16, 64, 256};
+    for(int stringLength : stringLengths){
+        wson_generator_options options;
+        options.stringLength = stringLength;
+        options.strings = 1;
+        options.ints = options.longs = options.doubles = options.bools = options.nulls = 0;
+        snprintf(name, sizeof(name), "gen_string_%d", stringLength);
+        add_generated(corpora, name, options, size);
+    }
+    const char* scripts[] = {"ascii", "latin", "cjk", "emoji"};
+    for(int i=0; i<4; i++){
+        wson_generator_options options;
+        options.ascii = i == 0;
+        options.latin = i == 1;
+        options.cjk = i == 2;
+        options.emoji = i == 3;
+        options.strings = 1;
+        options.ints = options.longs = options.doubles = options.bools = options.nulls = 0;
+        snprintf(name, sizeof(name), "gen_script_%s", scripts[i]);
+        add_generated(corpora, name, options, size);
+    }
+    const char* numbers[] = {"int", "long", "double"};
+    for(int i=0; i<3; i++){
+        wson_generator_options options;
+        options.strings = options.bools = options.nulls = 0;
+        options.ints = i == 0;
+        options.longs = i == 1;
+        options.doubles = i == 2;
+        snprintf(name, sizeof(name), "gen_number_%s", numbers[i]);
+        add_generated(corpora, name, options, size);
+    }
+}
+
+int main(int argc, char** argv){
+    bench_options options;
+    std::vector<std::string> files;
+    for(int i=1; i<argc; i++){
+        std::string arg = argv[i];
+        if(arg == "--json" && i + 1 < argc){
+            options.json = argv[++i];
+        }else if(arg == "--repeat" && i + 1 < argc){
+            options.repeat = std::max(1, atoi(argv[++i]));
+        }else if(arg == "--min-ms" && i + 1 < argc){
+            options.minMs = atof(argv[++i]);
+        }else if(arg == "--sweep"){
+            options.sweep = true;
+        }else if(arg == "--sweep-size" && i + 1 < argc){
+            options.sweepSize = wson_generator_parse_size(argv[++i]);
+        }else{
+            files.push_back(arg);
+        }
+    }
+    if(files.empty() && !options.sweep){
+        files.push_back(std::string(WSON_CORPUS_DIR) + "/weex2.wson");
+        files.push_back(std::string(WSON_CORPUS_DIR) + "/data.wson");
+        files.push_back(std::string(WSON_CORPUS_DIR) + "/bug/bigUnicode.wson");
+    }
+    std::vector<bench_corpus> corpora;
+    for(size_t i=0; i<files.size(); i++){
+        bench_corpus corpus;
+        size_t slash = files[i].find_last_of('/');
+        corpus.name = slash == std::string::npos ? files[i] : files[i].substr(slash + 1);
+        if(!read_file(files[i], corpus.data) || corpus.data.empty()){
+            printf("failed read corpus %s \n", files[i].c_str());
+            return 1;
+        }
+        corpora.push_back(corpus);
+    }
+    if(options.sweep){
+        add_sweep(corpora, options.sweepSize);
+    }
+    std::vector<bench_result> results;
+    for(size_t i=0; i<corpora.size(); i++){
+        bench_corpus_all(corpora[i], options, results);
+    }
+    if(options.json && !write_json(options.json, results)){
+        printf("failed write json %s \n", options.json);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+//
+// binary extend type in parser and base64 json rendering
+//
+
+#include "wson/wson.h"
+#include "wson/wson_parser.h"
+#include "wson/wson_util.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+
+static std::string reference_base64(const uint8_t* data, size_t length){
+    static const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for(size_t i=0; i<length; i+=3){
+        uint32_t triple = data[i] << 16;
+        size_t remain = length - i;
+        if(remain > 1){
+            triple |= data[i + 1] << 8;
+        }
+        if(remain > 2){
+            triple |= data[i + 2];
+        }
+        out.push_back(chars[(triple >> 18) & 0x3F]);
+        out.push_back(chars[(triple >> 12) & 0x3F]);
+        out.push_back(remain > 1 ? chars[(triple >> 6) & 0x3F] : '=');
+        out.push_back(remain > 2 ? chars[triple & 0x3F] : '=');
+    }
+    return out;
+}
+
+void test_base64(){
+    std::string hello;
+    wson::str_append_base64(hello, (const uint8_t*)"hello world", 11);
+    bool success = hello == "aGVsbG8gd29ybGQ=";
+    std::vector<uint8_t> data(1024*64 + 7);
+    uint32_t state = 2463534242u;
+    for(size_t i=0; i<data.size(); i++){
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        data[i] = (uint8_t)state;
+    }
+    for(size_t length=0; length<=100 && success; length++){
+        std::string out = "prefix";
+        wson::str_append_base64(out, data.data() + length%5, length);
+        success = out == "prefix" + reference_base64(data.data() + length%5, length);
+    }
+    std::string big;
+    wson::str_append_base64(big, data.data(), data.size());
+    success = success && big == reference_base64(data.data(), data.size());
+    if(success){
+        printf("pass test_base64 \n");
+    }else{
+        printf("failed test_base64 \n");
+    }
+}
+
+void test_binary_parse(){
+    uint8_t bytes[5] = {0x00, 0xFF, 0x10, 'w', 's'};
+    uint16_t key[1] = {'b'};
+    uint16_t other[1] = {'n'};
+    wson_buffer* buffer = wson_buffer_new();
+    wson_push_type_map(buffer, 2);
+    wson_push_property(buffer, key, sizeof(key));
+    wson_push_type_extend(buffer, bytes, sizeof(bytes));
+    wson_push_property(buffer, other, sizeof(other));
+    wson_push_type_int(buffer, 7);
+
+    wson_parser parser((const char*)buffer->data, buffer->position);
+    std::string json = parser.toStringUTF8();
+    bool success = json == "{\"b\":\"AP8Qd3M=\",\"n\":7}";
+
+    parser.nextType();
+    parser.nextMapSize();
+    parser.nextMapKeyUTF8();
+    uint8_t type = parser.nextType();
+    uint32_t length = 0;
+    const uint8_t* view = parser.isBinary(type) ? parser.nextBytes(type, length) : nullptr;
+    success = success && length == sizeof(bytes) && memcmp(view, bytes, length) == 0
+              && view > (const uint8_t*)buffer->data && view < (const uint8_t*)buffer->data + buffer->position
+              && parser.nextMapKeyUTF8() == "n" && parser.nextNumber(parser.nextType()) == 7;
+
+    parser.resetState();
+    parser.skipValue(parser.nextType());
+    success = success && parser.getState() == (int)buffer->position;
+    if(success){
+        printf("pass test_binary_parse \n");
+    }else{
+        printf("failed test_binary_parse %s \n", json.c_str());
+    }
+    wson_buffer_free(buffer);
+}
+
+int main(){
+    test_base64();
+    test_binary_parse();
+    return 0;
+}
@@ -0,0 +1,162 @@
+//
+// block stream round trip test
+//
+
+#include "wson/wson.h"
+#include "wson/wson_parser.h"
+#include "wson/wson_block_stream.h"
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+
+static void push_record(wson_buffer* buffer, int i){
+    uint16_t key[2] = {'i', 'd'};
+    uint16_t name[4] = {'w', 's', 'o', 'n'};
+    wson_push_type_map(buffer, 2);
+    wson_push_property(buffer, key, sizeof(key));
+    wson_push_type_int(buffer, i);
+    wson_push_uint(buffer, sizeof(name));
+    wson_push_bytes(buffer, name, sizeof(name));
+    wson_push_type_string(buffer, name, sizeof(name));
+}
+
+static int record_id(const uint8_t* data, uint32_t length){
+    wson_parser parser((const char*)data, (int)length);
+    if(!parser.isMap(parser.nextType())){
+        return -1;
+    }
+    parser.nextMapSize();
+    parser.nextMapKeyUTF8();
+    return (int)parser.nextNumber(parser.nextType());
+}
+
+static void write_records(wson_block_writer& writer, int count){
+    wson_buffer* record = wson_buffer_new();
+    for(int i=0; i<count; i++){
+        record->position = 0;
+        push_record(record, i);
+        writer.addRecord(record->data, record->position);
+    }
+    wson_buffer_free(record);
+}
+
+void test_block_stream_memory(){
+    wson_buffer* stream = wson_buffer_new();
+    wson_block_writer writer(stream, 1024);
+    write_records(writer, 1000);
+    writer.finish();
+
+    wson_block_reader reader((const char*)stream->data, stream->position);
+    if(!reader.isValid() || reader.recordCount() != 1000 || reader.blockCount() < 2){
+        printf("failed test_block_stream_memory index %d %d \n", reader.blockCount(), (int)reader.recordCount());
+        wson_buffer_free(stream);
+        return;
+    }
+
+    wson_thread_pool pool(4);
+    std::vector<std::vector<uint8_t> > blocks;
+    if(!reader.readBlocks(0, reader.blockCount(), blocks, &pool)){
+        printf("failed test_block_stream_memory readBlocks \n");
+        wson_buffer_free(stream);
+        return;
+    }
+    int expect = 0;
+    for(size_t i=0; i<blocks.size(); i++){
+        wson_parser parser((const char*)blocks[i].data(), (int)blocks[i].size());
+        while(parser.hasNext()){
+            int start = parser.getState();
+            parser.skipValue(parser.nextType());
+            int id = record_id(blocks[i].data() + start, parser.getState() - start);
+            if(id != expect){
+                printf("failed test_block_stream_memory record %d %d \n", id, expect);
+                wson_buffer_free(stream);
+                return;
+            }
+            expect++;
+        }
+    }
+
+    std::vector<uint8_t> record;
+    if(!reader.readRecord(777, record) || record_id(record.data(), (uint32_t)record.size()) != 777){
+        printf("failed test_block_stream_memory readRecord \n");
+        wson_buffer_free(stream);
+        return;
+    }
+
+    const wson_block_info& info = reader.blockInfo(1);
+    ((uint8_t*)stream->data)[info.offset + WSON_BLOCK_FRAME_SIZE + info.compressedLength/2] ^= 0x5A;
+    std::vector<uint8_t> corrupted;
+    if(reader.readBlock(1, corrupted) || !reader.readBlock(0, corrupted)){
+        printf("failed test_block_stream_memory checksum \n");
+        wson_buffer_free(stream);
+        return;
+    }
+    printf("pass test_block_stream_memory %d blocks \n", reader.blockCount());
+    wson_buffer_free(stream);
+}
+
+void test_block_stream_file(){
+    FILE* file = tmpfile();
+    if(!file){
+        printf("failed test_block_stream_file tmpfile \n");
+        return;
+    }
+    {
+        wson_block_writer writer(file, 4096);
+        write_records(writer, 5000);
+        writer.finish();
+    }
+    wson_block_reader reader(file);
+    std::vector<uint8_t> record;
+    if(reader.isValid()
+       && reader.recordCount() == 5000
+       && reader.readRecord(4999, record)
+       && record_id(record.data(), (uint32_t)record.size()) == 4999){
+        printf("pass test_block_stream_file %d blocks \n", reader.blockCount());
+    }else{
+        printf("failed test_block_stream_file \n");
+    }
+    fclose(file);
+}
+
+/**
+ * pool shared with a task that only finishes after readBlocks returns, readBlocks must wait own blocks only
+ */
+void test_block_stream_shared_pool(){
+    wson_buffer* stream = wson_buffer_new();
+    wson_block_writer writer(stream, 1024);
+    write_records(writer, 1000);
+    writer.finish();
+    wson_block_reader reader((const char*)stream->data, stream->position);
+    wson_thread_pool pool(2);
+    std::atomic<bool> started(false);
+    std::atomic<bool> released(false);
+    pool.submit([&started, &released]{
+        started.store(true);
+        while(!released.load()){
+            std::this_thread::yield();
+        }
+    });
+    while(!started.load()){
+        std::this_thread::yield();
+    }
+    std::vector<std::vector<uint8_t> > blocks;
+    bool success = reader.readBlocks(0, reader.blockCount(), blocks, &pool)
+                   && blocks.size() == reader.blockCount();
+    released.store(true);
+    pool.wait();
+    if(success){
+        printf("pass test_block_stream_shared_pool \n");
+    }else{
+        printf("failed test_block_stream_shared_pool \n");
+    }
+    wson_buffer_free(stream);
+}
+
+int main(){
+    test_block_stream_memory();
+    test_block_stream_file();
+    test_block_stream_shared_pool();
+    return 0;
+}
@@ -0,0 +1,198 @@
+//
+// binary diff and patch test
+//
+
+#include "wson/wson.h"
+#include "wson/wson_parser.h"
+#include "wson/wson_diff.h"
+#include <stdio.h>
+
+
+static void push_key(wson_buffer* buffer, const char* key){
+    uint16_t utf16[64];
+    int length = (int)strlen(key);
+    for(int i=0; i<length; i++){
+        utf16[i] = (uint8_t)key[i];
+    }
+    wson_push_property(buffer, utf16, length*sizeof(uint16_t));
+}
+
+static void push_string(wson_buffer* buffer, const char* value){
+    uint16_t utf16[64];
+    int length = (int)strlen(value);
+    for(int i=0; i<length; i++){
+        utf16[i] = (uint8_t)value[i];
+    }
+    wson_push_type_string(buffer, utf16, length*sizeof(uint16_t));
+}
+
+/**
+ * {"title": title, "items":[{"id":i, "text":"item"}...], "extra"?: true}
+ * */
+static wson_buffer* build_document(const char* title, int items, int changedItem, bool extra){
+    wson_buffer* buffer = wson_buffer_new();
+    wson_push_type_map(buffer, extra ? 3 : 2);
+    push_key(buffer, "title");
+    push_string(buffer, title);
+    push_key(buffer, "items");
+    wson_push_type_array(buffer, items);
+    for(int i=0; i<items; i++){
+        wson_push_type_map(buffer, 2);
+        push_key(buffer, "id");
+        wson_push_type_int(buffer, i);
+        push_key(buffer, "text");
+        push_string(buffer, i == changedItem ? "changed" : "item");
+    }
+    if(extra){
+        push_key(buffer, "extra");
+        wson_push_type_boolean(buffer, 1);
+    }
+    return buffer;
+}
+
+static void check_round_trip(const char* name, wson_buffer* oldDoc, wson_buffer* newDoc, uint32_t maxPatchSize){
+    wson_buffer* patch = wson_diff(oldDoc->data, oldDoc->position, newDoc->data, newDoc->position);
+    if(!patch){
+        printf("failed %s diff \n", name);
+        return;
+    }
+    wson_buffer* result = wson_patch(oldDoc->data, oldDoc->position, patch->data, patch->position);
+    if(result && result->position == newDoc->position
+       && memcmp(result->data, newDoc->data, newDoc->position) == 0
+       && patch->position <= maxPatchSize){
+        printf("pass %s patch %d bytes document %d bytes \n", name, patch->position, newDoc->position);
+    }else{
+        wson_parser parser((const char*)patch->data, patch->position);
+        printf("failed %s patch %s \n", name, parser.toStringUTF8().c_str());
+    }
+    if(result){
+        wson_buffer_free(result);
+    }
+    wson_buffer_free(patch);
+}
+
+void test_diff_one_field(){
+    wson_buffer* oldDoc = build_document("hello", 1000, -1, false);
+    wson_buffer* newDoc = build_document("hello", 1000, 500, false);
+    check_round_trip("test_diff_one_field", oldDoc, newDoc, 64);
+    wson_buffer_free(oldDoc);
+    wson_buffer_free(newDoc);
+}
+
+void test_diff_add_remove_key(){
+    wson_buffer* oldDoc = build_document("hello", 10, -1, false);
+    wson_buffer* newDoc = build_document("world", 10, -1, true);
+    check_round_trip("test_diff_add_key", oldDoc, newDoc, 64);
+    check_round_trip("test_diff_remove_key", newDoc, oldDoc, 64);
+    wson_buffer_free(oldDoc);
+    wson_buffer_free(newDoc);
+}
+
+void test_diff_array_length(){
+    wson_buffer* oldDoc = build_document("hello", 10, -1, false);
+    wson_buffer* newDoc = build_document("hello", 12, -1, false);
+    check_round_trip("test_diff_array_append", oldDoc, newDoc, 128);
+    check_round_trip("test_diff_array_truncate", newDoc, oldDoc, 64);
+    wson_buffer_free(oldDoc);
+    wson_buffer_free(newDoc);
+}
+
+void test_diff_same_and_replace(){
+    wson_buffer* oldDoc = build_document("hello", 10, -1, false);
+    wson_buffer* newDoc = wson_buffer_new();
+    wson_push_type_array(newDoc, 1);
+    wson_push_type_null(newDoc);
+    check_round_trip("test_diff_same", oldDoc, oldDoc, 2);
+    check_round_trip("test_diff_replace_root", oldDoc, newDoc, 16);
+    wson_buffer_free(oldDoc);
+    wson_buffer_free(newDoc);
+}
+
+/**
+ * {"a":1, "b":2, "c":3} with keys in given order
+ * */
+static wson_buffer* build_ordered_map(const char* keys){
+    wson_buffer* buffer = wson_buffer_new();
+    int length = (int)strlen(keys);
+    wson_push_type_map(buffer, length);
+    for(int i=0; i<length; i++){
+        char key[2] = {keys[i], 0};
+        push_key(buffer, key);
+        wson_push_type_int(buffer, keys[i] - 'a');
+    }
+    return buffer;
+}
+
+void test_diff_key_order(){
+    wson_buffer* oldDoc = build_ordered_map("abc");
+    wson_buffer* reorder = build_ordered_map("cab");
+    wson_buffer* insert = build_ordered_map("adbc");
+    wson_buffer* removeInsert = build_ordered_map("dac");
+    check_round_trip("test_diff_key_reorder", oldDoc, reorder, 64);
+    check_round_trip("test_diff_key_insert_middle", oldDoc, insert, 64);
+    check_round_trip("test_diff_key_remove_insert", oldDoc, removeInsert, 64);
+    check_round_trip("test_diff_key_reorder_back", reorder, oldDoc, 64);
+    wson_buffer_free(oldDoc);
+    wson_buffer_free(reorder);
+    wson_buffer_free(insert);
+    wson_buffer_free(removeInsert);
+}
+
+void test_patch_malformed(){
+    wson_buffer* oldDoc = build_document("hello", 10, -1, false);
+    wson_buffer* newDoc = build_document("hello", 10, 5, true);
+    wson_buffer* patch = wson_diff(oldDoc->data, oldDoc->position, newDoc->data, newDoc->position);
+    bool success = patch != nullptr;
+    for(uint32_t length=0; success && length<patch->position; length++){
+        wson_buffer* result = wson_patch(oldDoc->data, oldDoc->position, patch->data, length);
+        if(result){
+            success = false;
+            wson_buffer_free(result);
+        }
+        wson_buffer* truncated = wson_diff(oldDoc->data, length, newDoc->data, newDoc->position);
+        if(truncated){
+            success = false;
+            wson_buffer_free(truncated);
+        }
+    }
+
+    /** [[0, [5], 1]] append index with gap after old end */
+    wson_buffer* array = wson_buffer_new();
+    wson_push_type_array(array, 2);
+    wson_push_type_int(array, 1);
+    wson_push_type_int(array, 2);
+    wson_buffer* sparse = wson_buffer_new();
+    wson_push_type_array(sparse, 1);
+    wson_push_type_array(sparse, 3);
+    wson_push_type_int(sparse, WSON_PATCH_SET);
+    wson_push_type_array(sparse, 1);
+    wson_push_type_int(sparse, 5);
+    wson_push_type_int(sparse, 1);
+    wson_buffer* result = wson_patch(array->data, array->position, sparse->data, sparse->position);
+    if(result){
+        success = false;
+        wson_buffer_free(result);
+    }
+    if(success){
+        printf("pass test_patch_malformed \n");
+    }else{
+        printf("failed test_patch_malformed \n");
+    }
+    if(patch){
+        wson_buffer_free(patch);
+    }
+    wson_buffer_free(array);
+    wson_buffer_free(sparse);
+    wson_buffer_free(oldDoc);
+    wson_buffer_free(newDoc);
+}
+
+int main(){
+    test_diff_one_field();
+    test_diff_add_remove_key();
+    test_diff_array_length();
+    test_diff_same_and_replace();
+    test_diff_key_order();
+    test_patch_malformed();
+    return 0;
+}
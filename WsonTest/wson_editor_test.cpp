@@ -0,0 +1,150 @@
+//
+// in place splice editor test
+//
+
+#include "wson/wson.h"
+#include "wson/wson_parser.h"
+#include "wson/wson_editor.h"
+#include "bench.h"
+#include <stdio.h>
+
+
+static void push_key(wson_buffer* buffer, const char* key){
+    uint16_t utf16[64];
+    int length = (int)strlen(key);
+    for(int i=0; i<length; i++){
+        utf16[i] = (uint8_t)key[i];
+    }
+    wson_push_property(buffer, utf16, length*sizeof(uint16_t));
+}
+
+/**
+ * {"name":"wson", "items":[0, 1, ... items-1], "tail":true}
+ * */
+static wson_buffer* build_document(int items, int firstItem, bool hasName){
+    wson_buffer* buffer = wson_buffer_new();
+    wson_push_type_map(buffer, hasName ? 3 : 2);
+    if(hasName){
+        uint16_t name[4] = {'w', 's', 'o', 'n'};
+        push_key(buffer, "name");
+        wson_push_type_string(buffer, name, sizeof(name));
+    }
+    push_key(buffer, "items");
+    wson_push_type_array(buffer, items);
+    for(int i=0; i<items; i++){
+        wson_push_type_int(buffer, firstItem + i);
+    }
+    push_key(buffer, "tail");
+    wson_push_type_boolean(buffer, 1);
+    return buffer;
+}
+
+static bool same_bytes(wson_buffer* a, wson_buffer* b){
+    return a->position == b->position && memcmp(a->data, b->data, a->position) == 0;
+}
+
+void test_editor_varint_resize(){
+    wson_buffer* doc = build_document(127, 1, true);
+    wson_buffer* value = wson_buffer_new();
+    wson_push_type_int(value, 0);
+    wson_editor editor(doc);
+    bool success = editor.insert(wson_path().key("items").index(0), value);
+    wson_buffer* expect = build_document(128, 0, true);
+    if(success && same_bytes(doc, expect)){
+        printf("pass test_editor_varint_resize insert \n");
+    }else{
+        printf("failed test_editor_varint_resize insert \n");
+    }
+    success = editor.remove(wson_path().key("items").index(0));
+    wson_buffer* origin = build_document(127, 1, true);
+    if(success && same_bytes(doc, origin)){
+        printf("pass test_editor_varint_resize remove \n");
+    }else{
+        printf("failed test_editor_varint_resize remove \n");
+    }
+    wson_buffer_free(doc);
+    wson_buffer_free(value);
+    wson_buffer_free(expect);
+    wson_buffer_free(origin);
+}
+
+void test_editor_map_key(){
+    wson_buffer* doc = build_document(3, 0, true);
+    wson_editor editor(doc);
+    bool success = editor.remove(wson_path().key("name"));
+    wson_buffer* expect = build_document(3, 0, false);
+    if(!success || !same_bytes(doc, expect)){
+        printf("failed test_editor_map_key remove \n");
+    }
+    wson_buffer* value = wson_buffer_new();
+    wson_push_type_null(value);
+    success = editor.set(wson_path().key("extra"), value) && !editor.insert(wson_path().key("tail"), value);
+    wson_parser parser((const char*)doc->data, doc->position);
+    std::string json = parser.toStringUTF8();
+    if(success && json == "{\"items\":[0,1,2],\"tail\":true,\"extra\":\"\"}"){
+        printf("pass test_editor_map_key \n");
+    }else{
+        printf("failed test_editor_map_key %s \n", json.c_str());
+    }
+    wson_buffer_free(doc);
+    wson_buffer_free(expect);
+    wson_buffer_free(value);
+}
+
+void test_editor_big_document(){
+    wson_buffer* doc = build_document(250*1000, 0, true);
+    wson_buffer* value = wson_buffer_new();
+    uint16_t name[6] = {'e', 'd', 'i', 't', 'o', 'r'};
+    wson_push_type_string(value, name, sizeof(name));
+    wson_editor editor(doc);
+    double start = bench::now_ms();
+    bool success = editor.set(wson_path().key("name"), value);
+    double used = bench::now_ms() - start;
+    wson_parser parser((const char*)doc->data, doc->position);
+    parser.nextType();
+    parser.nextMapSize();
+    parser.nextMapKeyUTF8();
+    std::string updated = parser.nextStringUTF8(parser.nextType());
+    if(success && updated == "editor"){
+        printf("pass test_editor_big_document %d bytes used %f ms \n", doc->position, used);
+    }else{
+        printf("failed test_editor_big_document %s \n", updated.c_str());
+    }
+    wson_buffer_free(doc);
+    wson_buffer_free(value);
+}
+
+/**
+ * every truncated prefix must fail without reading past it, buffer is left unchanged
+ */
+void test_editor_truncated(){
+    wson_buffer* doc = build_document(3, 0, true);
+    wson_buffer* value = wson_buffer_new();
+    wson_push_type_null(value);
+    bool success = true;
+    for(uint32_t length=0; length<doc->position && success; length++){
+        uint8_t* data = (uint8_t*)malloc(length > 0 ? length : 1);
+        memcpy(data, doc->data, length);
+        wson_buffer truncated = {data, length, length};
+        wson_editor editor(&truncated);
+        success = !editor.set(wson_path().key("tail"), value)
+                  && !editor.remove(wson_path().key("tail"))
+                  && truncated.position == length && memcmp(data, doc->data, length) == 0;
+        free(truncated.data);
+    }
+    if(success){
+        printf("pass test_editor_truncated \n");
+    }else{
+        printf("failed test_editor_truncated \n");
+    }
+    wson_buffer_free(doc);
+    wson_buffer_free(value);
+}
+
+int main(){
+    test_editor_varint_resize();
+    test_editor_map_key();
+    test_editor_big_document();
+    test_editor_truncated();
+    return 0;
+}
@@ -0,0 +1,102 @@
+//
+// generate synthetic wson file
+// usage: wson_gen -o file [--size 64K|10M|2G] [--seed n] [--depth n] [--fanout n] [--container p] [--array p]
+//        [--keys n] [--key-reuse p] [--string-length n] [--script ascii:latin:cjk:emoji]
+//        [--values string:int:long:double:bool:null]
+//
+
+#include "wson_generator.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int parse_weights(const char* text, double* weights, int count){
+    int parsed = 0;
+    const char* start = text;
+    while(parsed < count && *start){
+        char* end = nullptr;
+        weights[parsed++] = strtod(start, &end);
+        if(!end || *end != ':'){
+            break;
+        }
+        start = end + 1;
+    }
+    return parsed;
+}
+
+static void usage(){
+    printf("usage: wson_gen -o file [--size 64K|10M|2G] [--seed n] [--depth n] [--fanout n] [--container p] [--array p]\n"
+           "       [--keys n] [--key-reuse p] [--string-length n] [--script ascii:latin:cjk:emoji]\n"
+           "       [--values string:int:long:double:bool:null]\n");
+}
+
+int main(int argc, char** argv){
+    wson_generator_options options;
+    const char* output = nullptr;
+    uint64_t size = 1024*1024;
+    for(int i=1; i<argc; i++){
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(!value){
+            usage();
+            return 1;
+        }
+        i++;
+        if(strcmp(arg, "-o") == 0){
+            output = value;
+        }else if(strcmp(arg, "--size") == 0){
+            size = wson_generator_parse_size(value);
+        }else if(strcmp(arg, "--seed") == 0){
+            options.seed = strtoull(value, nullptr, 10);
+        }else if(strcmp(arg, "--depth") == 0){
+            options.depth = atoi(value);
+        }else if(strcmp(arg, "--fanout") == 0){
+            options.fanout = atoi(value);
+        }else if(strcmp(arg, "--container") == 0){
+            options.containerRatio = atof(value);
+        }else if(strcmp(arg, "--array") == 0){
+            options.arrayRatio = atof(value);
+        }else if(strcmp(arg, "--keys") == 0){
+            options.keyCount = atoi(value);
+        }else if(strcmp(arg, "--key-reuse") == 0){
+            options.keyReuse = atof(value);
+        }else if(strcmp(arg, "--string-length") == 0){
+            options.stringLength = atoi(value);
+        }else if(strcmp(arg, "--script") == 0){
+            double weights[4] = {0, 0, 0, 0};
+            parse_weights(value, weights, 4);
+            options.ascii = weights[0];
+            options.latin = weights[1];
+            options.cjk = weights[2];
+            options.emoji = weights[3];
+        }else if(strcmp(arg, "--values") == 0){
+            double weights[6] = {0, 0, 0, 0, 0, 0};
+            parse_weights(value, weights, 6);
+            options.strings = weights[0];
+            options.ints = weights[1];
+            options.longs = weights[2];
+            options.doubles = weights[3];
+            options.bools = weights[4];
+            options.nulls = weights[5];
+        }else{
+            usage();
+            return 1;
+        }
+    }
+    if(!output || size == 0){
+        usage();
+        return 1;
+    }
+    FILE* file = fopen(output, "wb");
+    if(!file){
+        printf("failed open %s \n", output);
+        return 1;
+    }
+    wson_generator generator(options);
+    bool success = generator.generate(file, size);
+    success = fclose(file) == 0 && success;
+    if(!success){
+        printf("failed write %s \n", output);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+//
+// seeded synthetic wson document generator
+//
+
+#include "wson_generator.h"
+#include <stdlib.h>
+
+/**
+ * documents sampled to estimate document size for target bytes
+ * */
+#define WSON_GENERATOR_SAMPLE_COUNT 8
+
+wson_generator::wson_generator(const wson_generator_options &options) {
+    this->options = options;
+    this->state = options.seed*0x9E3779B97F4A7C15ULL + 0x2545F4914F6CDD1DULL;
+    if(this->state == 0){
+        this->state = 0x2545F4914F6CDD1DULL;
+    }
+    int keyCount = options.keyCount > 0 ? options.keyCount : 1;
+    keys.resize(keyCount);
+    for(int i=0; i<keyCount; i++){
+        randomChars(keys[i], 3 + uniform(10), true);
+    }
+}
+
+/**
+ * xorshift64*, own generator so output not depend on std library distribution
+ * */
+uint64_t wson_generator::next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state*0x2545F4914F6CDD1DULL;
+}
+
+uint32_t wson_generator::uniform(uint32_t bound) {
+    if(bound <= 1){
+        return 0;
+    }
+    return (uint32_t)(((next() >> 32)*bound) >> 32);
+}
+
+bool wson_generator::chance(double probability) {
+    return (next() >> 11)*(1.0/9007199254740992.0) < probability;
+}
+
+int wson_generator::pick(const double *weights, int count) {
+    double total = 0;
+    for(int i=0; i<count; i++){
+        total += weights[i] > 0 ? weights[i] : 0;
+    }
+    double point = (next() >> 11)*(1.0/9007199254740992.0)*total;
+    for(int i=0; i<count; i++){
+        if(weights[i] <= 0){
+            continue;
+        }
+        if(point < weights[i]){
+            return i;
+        }
+        point -= weights[i];
+    }
+    return 0;
+}
+
+void wson_generator::randomChars(std::vector<uint16_t> &chars, uint32_t length, bool asciiOnly) {
+    double weights[4] = {options.ascii, options.latin, options.cjk, options.emoji};
+    chars.clear();
+    while(chars.size() < length){
+        int script = asciiOnly ? 0 : pick(weights, 4);
+        switch (script) {
+            case 1:
+                chars.push_back((uint16_t)(0xC0 + uniform(0x40)));
+                break;
+            case 2:
+                chars.push_back((uint16_t)(0x4E00 + uniform(0x5200)));
+                break;
+            case 3:{
+                    uint32_t code = 0x1F600 + uniform(0x50) - 0x10000;
+                    chars.push_back((uint16_t)(0xD800 + (code >> 10)));
+                    chars.push_back((uint16_t)(0xDC00 + (code & 0x3FF)));
+                }
+                break;
+            default:
+                chars.push_back((uint16_t)((asciiOnly ? 'a' : 0x20) + uniform(asciiOnly ? 26 : 0x5F)));
+                break;
+        }
+    }
+}
+
+void wson_generator::pushString(wson_buffer *buffer, bool isKey) {
+    if(isKey){
+        if(chance(options.keyReuse)){
+            const std::vector<uint16_t>& key = keys[uniform((uint32_t)keys.size())];
+            wson_push_property(buffer, key.data(), (int32_t)(key.size()*sizeof(uint16_t)));
+            return;
+        }
+        randomChars(chars, 3 + uniform(10), true);
+        wson_push_property(buffer, chars.data(), (int32_t)(chars.size()*sizeof(uint16_t)));
+        return;
+    }
+    uint32_t maxLength = options.stringLength > 0 ? 2*options.stringLength : 1;
+    randomChars(chars, 1 + uniform(maxLength), false);
+    wson_push_type_string(buffer, chars.data(), (int32_t)(chars.size()*sizeof(uint16_t)));
+}
+
+void wson_generator::pushLeaf(wson_buffer *buffer) {
+    double weights[6] = {options.strings, options.ints, options.longs, options.doubles, options.bools, options.nulls};
+    switch (pick(weights, 6)) {
+        case 0:
+            pushString(buffer, false);
+            break;
+        case 1:{
+                /** varied varint width, small value is most common */
+                uint32_t bits = 1 + uniform(31);
+                int32_t num = (int32_t)(next() & ((1ULL << bits) - 1));
+                wson_push_type_int(buffer, chance(0.2) ? -num : num);
+            }
+            break;
+        case 2:
+            wson_push_type_long(buffer, (int64_t)next());
+            break;
+        case 3:
+            wson_push_type_double(buffer, ((int64_t)(next() >> 11) - (1LL << 52))/1048576.0);
+            break;
+        case 4:
+            wson_push_type_boolean(buffer, chance(0.5) ? 1 : 0);
+            break;
+        default:
+            wson_push_type_null(buffer);
+            break;
+    }
+}
+
+void wson_generator::pushValue(wson_buffer *buffer, int level) {
+    if(level > 0 && (level >= options.depth || !chance(options.containerRatio)
+                     || flushed + buffer->position - documentStart >= documentBudget)){
+        pushLeaf(buffer);
+        return;
+    }
+    uint32_t fanout = options.fanout > 0 ? options.fanout : 1;
+    uint32_t count = fanout/2 + uniform(fanout + 1);
+    if(chance(options.arrayRatio)){
+        wson_push_type_array(buffer, count);
+        for(uint32_t i=0; i<count; i++){
+            pushValue(buffer, level + 1);
+        }
+    }else{
+        wson_push_type_map(buffer, count);
+        for(uint32_t i=0; i<count; i++){
+            pushString(buffer, true);
+            pushValue(buffer, level + 1);
+        }
+    }
+}
+
+void wson_generator::generate(wson_buffer *buffer) {
+    pushDocument(buffer, UINT64_MAX);
+}
+
+void wson_generator::pushDocument(wson_buffer *buffer, uint64_t budget) {
+    documentStart = flushed + buffer->position;
+    documentBudget = budget;
+    pushValue(buffer, 0);
+    documentBudget = UINT64_MAX;
+}
+
+uint32_t wson_generator::documentCount(uint64_t targetBytes) {
+    /** sample on copy, so sampling not change generated bytes */
+    wson_generator sampler(*this);
+    wson_buffer* sample = wson_buffer_new();
+    for(int i=0; i<WSON_GENERATOR_SAMPLE_COUNT; i++){
+        sampler.generate(sample);
+    }
+    uint64_t documentSize = sample->position/WSON_GENERATOR_SAMPLE_COUNT;
+    wson_buffer_free(sample);
+    uint64_t count = targetBytes/(documentSize > 0 ? documentSize : 1);
+    if(count < 1){
+        count = 1;
+    }
+    if(count > 0xFFFFFFFFULL){
+        count = 0xFFFFFFFFULL;
+    }
+    return (uint32_t)count;
+}
+
+void wson_generator::generate(wson_buffer *buffer, uint64_t targetBytes) {
+    uint32_t count = documentCount(targetBytes);
+    uint64_t end = buffer->position + targetBytes;
+    wson_push_type_array(buffer, count);
+    for(uint32_t i=0; i<count; i++){
+        uint64_t left = end > buffer->position ? end - buffer->position : 0;
+        pushDocument(buffer, left/(count - i));
+    }
+}
+
+bool wson_generator::generate(FILE *file, uint64_t targetBytes) {
+    uint32_t count = documentCount(targetBytes);
+    wson_buffer* buffer = wson_buffer_new();
+    wson_push_type_array(buffer, count);
+    bool success = true;
+    flushed = 0;
+    for(uint32_t i=0; i<count && success; i++){
+        uint64_t written = flushed + buffer->position;
+        uint64_t left = targetBytes > written ? targetBytes - written : 0;
+        pushDocument(buffer, left/(count - i));
+        if(buffer->position >= 64*1024 || i + 1 == count){
+            success = fwrite(buffer->data, 1, buffer->position, file) == buffer->position;
+            flushed += buffer->position;
+            buffer->position = 0;
+        }
+    }
+    flushed = 0;
+    wson_buffer_free(buffer);
+    return success;
+}
+
+uint64_t wson_generator_parse_size(const char *size) {
+    char* end = nullptr;
+    double value = strtod(size, &end);
+    uint64_t unit = 1;
+    if(end){
+        switch (*end) {
+            case 'k':
+            case 'K':
+                unit = 1024;
+                break;
+            case 'm':
+            case 'M':
+                unit = 1024*1024;
+                break;
+            case 'g':
+            case 'G':
+                unit = 1024ULL*1024*1024;
+                break;
+            default:
+                break;
+        }
+    }
+    return value > 0 ? (uint64_t)(value*unit) : 0;
+}
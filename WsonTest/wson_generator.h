@@ -0,0 +1,94 @@
+//
+// seeded synthetic wson document generator, for scaling study over depth, fan-out,
+// key set, string length and script, number type distribution.
+// same seed and options generate same bytes on every platform.
+//
+
+#ifndef WSONTEST_WSON_GENERATOR_H
+#define WSONTEST_WSON_GENERATOR_H
+
+#include "wson/wson.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+struct wson_generator_options {
+    uint64_t seed = 1;
+    /** max container nesting of one document */
+    int depth = 4;
+    /** mean children of container, actual is uniform in [fanout/2, fanout*3/2] */
+    int fanout = 8;
+    /** probability child is container when depth allowed */
+    double containerRatio = 0.3;
+    /** probability container is array, else map */
+    double arrayRatio = 0.3;
+    /** key set size, and probability map key is picked from key set, else a fresh key */
+    int keyCount = 64;
+    double keyReuse = 0.9;
+    /** mean string length in utf-16 chars, actual is uniform in [1, 2*stringLength] */
+    int stringLength = 16;
+    /** script weights of string chars: ascii, latin-1, cjk, emoji (surrogate pair) */
+    double ascii = 1;
+    double latin = 0;
+    double cjk = 0;
+    double emoji = 0;
+    /** leaf value type weights */
+    double strings = 4;
+    double ints = 3;
+    double longs = 1;
+    double doubles = 1;
+    double bools = 1;
+    double nulls = 0.5;
+};
+
+class wson_generator {
+
+public:
+    explicit wson_generator(const wson_generator_options& options);
+
+    /**
+     * append one document
+     * */
+    void generate(wson_buffer* buffer);
+
+    /**
+     * append array of documents, about targetBytes in total. every document gets share of bytes left,
+     * past its share no container is opened, so deep or wide options never run far over target
+     * */
+    void generate(wson_buffer* buffer, uint64_t targetBytes);
+
+    /**
+     * write array of documents about targetBytes to file, only one document is in memory,
+     * so target can be gigabytes. return false on write failure.
+     * */
+    bool generate(FILE* file, uint64_t targetBytes);
+
+private:
+    uint64_t next();
+    uint32_t uniform(uint32_t bound);
+    bool chance(double probability);
+    int pick(const double* weights, int count);
+
+    void pushValue(wson_buffer* buffer, int level);
+    void pushDocument(wson_buffer* buffer, uint64_t budget);
+    void pushLeaf(wson_buffer* buffer);
+    void pushString(wson_buffer* buffer, bool isKey);
+    void randomChars(std::vector<uint16_t>& chars, uint32_t length, bool asciiOnly);
+    uint32_t documentCount(uint64_t targetBytes);
+
+    wson_generator_options options;
+    uint64_t state;
+    std::vector<std::vector<uint16_t>> keys;
+    std::vector<uint16_t> chars;
+    /** bytes written before current document, buffer may be flushed while document is written */
+    uint64_t documentStart = 0;
+    uint64_t documentBudget = UINT64_MAX;
+    uint64_t flushed = 0;
+};
+
+/**
+ * parse size like 64K, 10M, 2G
+ * */
+uint64_t wson_generator_parse_size(const char* size);
+
+#endif //WSONTEST_WSON_GENERATOR_H
@@ -0,0 +1,75 @@
+//
+// synthetic generator test, same seed same bytes, generated size stays near target at any depth
+//
+
+#include "wson/wson.h"
+#include "wson_generator.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+
+static bool read_file(FILE* file, std::vector<char>& data){
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data.resize(size > 0 ? size : 0);
+    return fread(data.data(), 1, data.size(), file) == data.size();
+}
+
+void test_generator_same_seed(){
+    wson_generator_options options;
+    options.seed = 42;
+    options.depth = 6;
+    options.cjk = 1;
+    options.emoji = 0.2;
+    wson_generator first(options);
+    wson_generator second(options);
+    wson_buffer* firstBuffer = wson_buffer_new();
+    wson_buffer* secondBuffer = wson_buffer_new();
+    first.generate(firstBuffer, 256*1024);
+    second.generate(secondBuffer, 256*1024);
+
+    /** file output is same bytes as buffer output */
+    wson_generator third(options);
+    FILE* file = tmpfile();
+    std::vector<char> data;
+    bool success = file && third.generate(file, 256*1024) && read_file(file, data);
+    if(file){
+        fclose(file);
+    }
+    if(success && firstBuffer->position == secondBuffer->position
+       && memcmp(firstBuffer->data, secondBuffer->data, firstBuffer->position) == 0
+       && data.size() == firstBuffer->position
+       && memcmp(data.data(), firstBuffer->data, data.size()) == 0){
+        printf("pass test_generator_same_seed %d bytes \n", firstBuffer->position);
+    }else{
+        printf("failed test_generator_same_seed %d %d %d \n", firstBuffer->position, secondBuffer->position, (int)data.size());
+    }
+    wson_buffer_free(firstBuffer);
+    wson_buffer_free(secondBuffer);
+}
+
+void test_generator_target_at_depth(){
+    int depths[] = {1, 4, 8, 16};
+    for(int i=0; i<4; i++){
+        wson_generator_options options;
+        options.depth = depths[i];
+        wson_generator generator(options);
+        wson_buffer* buffer = wson_buffer_new();
+        uint64_t target = 100*1024;
+        generator.generate(buffer, target);
+        if(buffer->position <= target*5/4 && buffer->position >= target/4){
+            printf("pass test_generator_target_at_depth %d %d bytes \n", depths[i], buffer->position);
+        }else{
+            printf("failed test_generator_target_at_depth %d %d bytes \n", depths[i], buffer->position);
+        }
+        wson_buffer_free(buffer);
+    }
+}
+
+int main(){
+    test_generator_same_seed();
+    test_generator_target_at_depth();
+    return 0;
+}
@@ -0,0 +1,173 @@
+//
+// content hash and semantic equal test
+//
+
+#include "wson/wson.h"
+#include "wson/wson_hash.h"
+#include "bench.h"
+#include <stdio.h>
+
+
+static void push_key(wson_buffer* buffer, const char* key){
+    uint16_t utf16[64];
+    int length = (int)strlen(key);
+    for(int i=0; i<length; i++){
+        utf16[i] = (uint8_t)key[i];
+    }
+    wson_push_property(buffer, utf16, length*sizeof(uint16_t));
+}
+
+/**
+ * {"id":id, "score":score, "tags":[...]} with keys in given order, score pushed as int or double
+ */
+static void push_item(wson_buffer* buffer, int id, bool reverse, bool doubleScore){
+    wson_push_type_map(buffer, 3);
+    for(int i=0; i<3; i++){
+        int field = reverse ? 2 - i : i;
+        if(field == 0){
+            push_key(buffer, "id");
+            wson_push_type_int(buffer, id);
+        }else if(field == 1){
+            push_key(buffer, "score");
+            if(doubleScore){
+                wson_push_type_double(buffer, id*2);
+            }else{
+                wson_push_type_long(buffer, id*2);
+            }
+        }else{
+            push_key(buffer, "tags");
+            wson_push_type_array(buffer, 2);
+            wson_push_type_boolean(buffer, 1);
+            wson_push_type_null(buffer);
+        }
+    }
+}
+
+static wson_buffer* build_document(int items, bool reverse, bool doubleScore, int changedItem){
+    wson_buffer* buffer = wson_buffer_new();
+    wson_push_type_array(buffer, items);
+    for(int i=0; i<items; i++){
+        push_item(buffer, i == changedItem ? -1 : i, reverse, doubleScore);
+    }
+    return buffer;
+}
+
+void test_hash_map_order(){
+    wson_buffer* a = build_document(100, false, false, -1);
+    wson_buffer* b = build_document(100, true, false, -1);
+    bool success = wson_hash64(a->data, a->position) == wson_hash64(b->data, b->position)
+                   && wson_hash64(a->data, a->position, WSON_HASH_ORDERED) != wson_hash64(b->data, b->position, WSON_HASH_ORDERED)
+                   && wson_equal(a->data, a->position, b->data, b->position)
+                   && !wson_equal(a->data, a->position, b->data, b->position, WSON_HASH_ORDERED);
+    if(success){
+        printf("pass test_hash_map_order \n");
+    }else{
+        printf("failed test_hash_map_order \n");
+    }
+    wson_buffer_free(a);
+    wson_buffer_free(b);
+}
+
+void test_hash_number_canonical(){
+    wson_buffer* a = build_document(100, false, false, -1);
+    wson_buffer* b = build_document(100, false, true, -1);
+    wson_buffer* half = wson_buffer_new();
+    wson_push_type_double(half, 0.5);
+    wson_buffer* zero = wson_buffer_new();
+    wson_push_type_int(zero, 0);
+    wson_hash128_t hashA = wson_hash128(a->data, a->position);
+    wson_hash128_t hashB = wson_hash128(b->data, b->position);
+    bool success = hashA.low == hashB.low && hashA.high == hashB.high
+                   && wson_equal(a->data, a->position, b->data, b->position)
+                   && !wson_equal(half->data, half->position, zero->data, zero->position)
+                   && wson_hash64(half->data, half->position) != wson_hash64(zero->data, zero->position);
+    if(success){
+        printf("pass test_hash_number_canonical \n");
+    }else{
+        printf("failed test_hash_number_canonical \n");
+    }
+    wson_buffer_free(a);
+    wson_buffer_free(b);
+    wson_buffer_free(half);
+    wson_buffer_free(zero);
+}
+
+void test_hash_changed_value(){
+    wson_buffer* a = build_document(1000, false, false, -1);
+    wson_buffer* b = build_document(1000, true, false, 999);
+    bool success = wson_hash64(a->data, a->position) != wson_hash64(b->data, b->position)
+                   && !wson_equal(a->data, a->position, b->data, b->position);
+    if(success){
+        printf("pass test_hash_changed_value \n");
+    }else{
+        printf("failed test_hash_changed_value \n");
+    }
+    wson_buffer_free(a);
+    wson_buffer_free(b);
+}
+
+void test_hash_speed(){
+    wson_buffer* a = build_document(200*1000, false, false, -1);
+    wson_buffer* b = build_document(200*1000, true, true, -1);
+    double start = bench::now_ms();
+    uint64_t hash = wson_hash64(a->data, a->position);
+    double hashUsed = bench::now_ms() - start;
+    start = bench::now_ms();
+    bool equal = wson_equal(a->data, a->position, b->data, b->position);
+    double equalUsed = bench::now_ms() - start;
+    if(equal && hash == wson_hash64(b->data, b->position)){
+        printf("pass test_hash_speed %d bytes hash used %f ms equal used %f ms \n", a->position, hashUsed, equalUsed);
+    }else{
+        printf("failed test_hash_speed \n");
+    }
+    wson_buffer_free(a);
+    wson_buffer_free(b);
+}
+
+/**
+ * every truncated prefix must hash different from whole value and never equal it, without reading past it.
+ * nesting deeper than limit is malformed instead of overflowing stack
+ */
+void test_hash_truncated(){
+    wson_buffer* a = build_document(3, false, false, -1);
+    wson_buffer* b = build_document(3, true, true, -1);
+    uint64_t hash = wson_hash64(a->data, a->position);
+    bool success = true;
+    for(uint32_t length=0; length<a->position && success; length++){
+        uint8_t* prefix = (uint8_t*)malloc(length > 0 ? length : 1);
+        memcpy(prefix, a->data, length);
+        success = wson_hash64(prefix, length) != hash
+                  && wson_hash64(prefix, length, WSON_HASH_ORDERED) != wson_hash64(a->data, a->position, WSON_HASH_ORDERED)
+                  && !wson_equal(prefix, length, b->data, b->position)
+                  && !wson_equal(b->data, b->position, prefix, length);
+        free(prefix);
+    }
+    wson_buffer* deep = wson_buffer_new();
+    for(int i=0; i<100*1000; i++){
+        wson_push_type_array(deep, 1);
+    }
+    wson_push_type_null(deep);
+    wson_buffer* other = wson_buffer_new();
+    wson_push_bytes(other, deep->data, deep->position - 1);
+    wson_push_type_boolean(other, 1);
+    success = success && !wson_equal(deep->data, deep->position, other->data, other->position)
+              && wson_hash64(deep->data, deep->position) == wson_hash64(other->data, other->position);
+    if(success){
+        printf("pass test_hash_truncated \n");
+    }else{
+        printf("failed test_hash_truncated \n");
+    }
+    wson_buffer_free(a);
+    wson_buffer_free(b);
+    wson_buffer_free(deep);
+    wson_buffer_free(other);
+}
+
+int main(){
+    test_hash_map_order();
+    test_hash_number_canonical();
+    test_hash_changed_value();
+    test_hash_speed();
+    test_hash_truncated();
+    return 0;
+}
@@ -0,0 +1,132 @@
+//
+// parallel encoder must be byte identical with sequential encoder
+//
+
+#include "wson/wson.h"
+#include "wson/wson_parallel_encoder.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+static void push_element(wson_buffer* buffer, uint32_t index){
+    if(index % 3 == 0){
+        wson_push_type_int(buffer, (int32_t)index*7 - 1000);
+    }else if(index % 3 == 1){
+        wson_push_type_double(buffer, index/3.0);
+    }else{
+        uint16_t name[3] = {'e', (uint16_t)('a' + index % 26), (uint16_t)(0x4E00 + index % 100)};
+        wson_push_type_string(buffer, name, sizeof(name));
+    }
+}
+
+static void push_entry(wson_buffer* buffer, uint32_t index){
+    char ascii[16];
+    uint16_t key[16];
+    int length = snprintf(ascii, sizeof(ascii), "k%u", index);
+    for(int i=0; i<length; i++){
+        key[i] = (uint8_t)ascii[i];
+    }
+    wson_push_property(buffer, key, length*sizeof(uint16_t));
+    push_element(buffer, index);
+}
+
+static bool same_bytes(wson_buffer* a, wson_buffer* b){
+    return a->position == b->position && memcmp(a->data, b->data, a->position) == 0;
+}
+
+void test_parallel_array(){
+    uint32_t count = 2*1000*1000;
+    wson_buffer* sequential = wson_buffer_new();
+    double start = bench::now_ms();
+    wson_push_type_array(sequential, count);
+    for(uint32_t i=0; i<count; i++){
+        push_element(sequential, i);
+    }
+    double sequentialUsed = bench::now_ms() - start;
+
+    wson_thread_pool pool(4);
+    wson_parallel_encoder encoder(&pool);
+    wson_buffer* parallel = wson_buffer_new();
+    start = bench::now_ms();
+    encoder.pushArray(parallel, count, push_element);
+    double parallelUsed = bench::now_ms() - start;
+    if(same_bytes(sequential, parallel)){
+        printf("pass test_parallel_array sequential %f ms parallel %f ms \n", sequentialUsed, parallelUsed);
+    }else{
+        printf("failed test_parallel_array %d %d \n", sequential->position, parallel->position);
+    }
+
+    FILE* file = tmpfile();
+    int64_t written = encoder.writeArray(fileno(file), count, push_element);
+    char* bts = (char*)malloc(sequential->position);
+    fseek(file, 0, SEEK_SET);
+    size_t read = fread(bts, 1, sequential->position, file);
+    if(written == sequential->position && read == sequential->position
+       && memcmp(bts, sequential->data, sequential->position) == 0){
+        printf("pass test_parallel_array writev \n");
+    }else{
+        printf("failed test_parallel_array writev %lld \n", (long long)written);
+    }
+    free(bts);
+    fclose(file);
+    wson_buffer_free(sequential);
+    wson_buffer_free(parallel);
+}
+
+void test_parallel_map(){
+    uint32_t size = 100*1000;
+    wson_buffer* sequential = wson_buffer_new();
+    wson_push_type_map(sequential, size);
+    for(uint32_t i=0; i<size; i++){
+        push_entry(sequential, i);
+    }
+    wson_thread_pool pool(3);
+    wson_parallel_encoder encoder(&pool, 1000);
+    wson_buffer* parallel = wson_buffer_new();
+    wson_push_type_null(parallel);
+    encoder.pushMap(parallel, size, push_entry);
+    parallel->position -= 1;
+    memmove(parallel->data, (uint8_t*)parallel->data + 1, parallel->position);
+    if(same_bytes(sequential, parallel)){
+        printf("pass test_parallel_map \n");
+    }else{
+        printf("failed test_parallel_map %d %d \n", sequential->position, parallel->position);
+    }
+    wson_buffer_free(sequential);
+    wson_buffer_free(parallel);
+}
+
+/**
+ * encoder called from pool task, single worker must run own chunks instead of blocking
+ */
+void test_parallel_nested(){
+    uint32_t count = 10*1000;
+    wson_buffer* sequential = wson_buffer_new();
+    wson_push_type_array(sequential, count);
+    for(uint32_t i=0; i<count; i++){
+        push_element(sequential, i);
+    }
+    wson_thread_pool pool(1);
+    wson_buffer* parallel = wson_buffer_new();
+    pool.submit([&pool, parallel, count]{
+        wson_parallel_encoder encoder(&pool, 100);
+        encoder.pushArray(parallel, count, push_element);
+    });
+    pool.wait();
+    if(same_bytes(sequential, parallel)){
+        printf("pass test_parallel_nested \n");
+    }else{
+        printf("failed test_parallel_nested %d %d \n", sequential->position, parallel->position);
+    }
+    wson_buffer_free(sequential);
+    wson_buffer_free(parallel);
+}
+
+int main(){
+    test_parallel_array();
+    test_parallel_map();
+    test_parallel_nested();
+    return 0;
+}
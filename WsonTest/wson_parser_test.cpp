@@ -26,20 +26,6 @@ void test_big_unicode(){
 }
 
 
-void test_bench_example(){
-    const char* data = FileUtils::readFile("/Users/furture/code/pack/java/src/test/resources/weex2.wson");
-    wson_parser parser(data);
-    double start = bench::now_ms();
-    for(int i=0; i<100000; i++){
-        int type = parser.nextType();
-        parser.nextStringUTF8(type);
-        parser.resetState();
-    }
-    printf("bench end used %f ms \n", (bench::now_ms() - start));
-
-    free((void*)data);
-}
-
 void test_map_example(){
     const char* data = FileUtils::readFile("/Users/furture/code/pack/java/src/test/resources/weex2.wson");
     wson_parser parser(data);
@@ -109,6 +95,65 @@ void test_quote_example(){
     printf("toString %s \n", parser.toStringUTF8().c_str());
 }
 
+void test_reserved_map_size(){
+    wson_buffer* buffer = wson_buffer_new();
+    uint16_t key[1] = {'a'};
+    uint32_t position = wson_push_type_map_reserve(buffer);
+    uint32_t size = 0;
+    for(int i=0; i<300; i++){
+        if(i % 3 == 0){
+            continue;
+        }
+        key[0] = (uint16_t)(0x100 + i);
+        wson_push_property(buffer, key, sizeof(key));
+        wson_push_type_int(buffer, i);
+        size++;
+    }
+    wson_patch_uint_fixed(buffer, position, size);
+    wson_parser parser((const char*)buffer->data, buffer->position);
+    int type = parser.nextType();
+    bool success = parser.isMap(type) && parser.nextMapSize() == (int)size
+                   && position + WSON_UINT_FIXED_SIZE == (uint32_t)parser.getState();
+    if(success){
+        for(uint32_t i=0; i<size; i++){
+            parser.nextMapKeyUTF8();
+            parser.skipValue(parser.nextType());
+        }
+        success = parser.getState() == (int)buffer->position;
+    }
+    if(success){
+        printf("pass test_reserved_map_size \n");
+    }else{
+        printf("failed test_reserved_map_size \n");
+    }
+    wson_buffer_free(buffer);
+}
+
+void test_push_nulls(){
+    wson_buffer* buffer = wson_buffer_new();
+    wson_push_type_array(buffer, 5000);
+    wson_push_type_nulls(buffer, 2000);
+    wson_push_type_int(buffer, 7);
+    wson_push_type_nulls(buffer, 0);
+    wson_push_type_nulls(buffer, 2999);
+    wson_parser parser((const char*)buffer->data, buffer->position);
+    bool success = parser.isArray(parser.nextType()) && parser.nextArraySize() == 5000;
+    for(int i=0; i<5000 && success; i++){
+        uint8_t type = parser.nextType();
+        success = i == 2000 ? parser.nextNumber(type) == 7 : parser.isNull(type);
+    }
+    success = success && parser.getState() == (int)buffer->position;
+    uint32_t position = buffer->position;
+    success = success && !wson_push_type_nulls(buffer, UINT32_MAX) && buffer->position == position;
+    success = success && !wson_push_type_nulls(buffer, UINT32_MAX - position + 1) && buffer->position == position;
+    if(success){
+        printf("pass test_push_nulls \n");
+    }else{
+        printf("failed test_push_nulls \n");
+    }
+    wson_buffer_free(buffer);
+}
+
 void test_next_line_example(){
     const char* data = FileUtils::readFile("/Users/furture/code/pack/java/src/test/resources/plus/parser.wson");
     wson_parser parser(data);
@@ -117,8 +162,9 @@ void test_next_line_example(){
 
 
 int main(){
+    test_reserved_map_size();
+    test_push_nulls();
     test_add_element_example();
-    test_bench_example();
     test_big_unicode();
     test_map_example();
     test_array_example();
@@ -0,0 +1,85 @@
+//
+// instrumentation counters test, built with WSON_STATS
+//
+
+#include "wson/wson.h"
+#include "wson/wson_parser.h"
+#include "wson/wson_stats.h"
+#include <stdio.h>
+
+
+void test_stats_encode(){
+    wson_stats_reset();
+    wson_buffer* buffer = wson_buffer_new();
+    uint16_t key[2] = {'i', 'd'};
+    wson_push_type_map(buffer, 1);
+    wson_push_property(buffer, key, sizeof(key));
+    wson_push_type_array(buffer, 200);
+    for(int i=0; i<200; i++){
+        wson_push_type_int(buffer, i);
+    }
+    wson_stats stats;
+    wson_stats_snapshot(&stats);
+    /** int 0..63 zigzag to one byte varint, 64..199 to two */
+    bool success = stats.encodeValues[WSON_NUMBER_INT_TYPE] == 200
+                   && stats.encodeBytes[WSON_NUMBER_INT_TYPE] == 200 + 64 + 136*2
+                   && stats.encodeValues[WSON_MAP_TYPE] == 1 && stats.encodeBytes[WSON_ARRAY_TYPE] == 3
+                   && stats.encodePropertyBytes == 1 + sizeof(key)
+                   && stats.encodeVarints[1] == 64 + 2 && stats.encodeVarints[2] == 136 + 1;
+    if(success){
+        printf("pass test_stats_encode \n");
+    }else{
+        printf("failed test_stats_encode int %llu bytes %llu \n",
+               (unsigned long long)stats.encodeValues[WSON_NUMBER_INT_TYPE],
+               (unsigned long long)stats.encodeBytes[WSON_NUMBER_INT_TYPE]);
+    }
+    wson_buffer_free(buffer);
+}
+
+void test_stats_decode_and_resize(){
+    wson_buffer* buffer = wson_buffer_new();
+    uint16_t text[256];
+    for(int i=0; i<256; i++){
+        text[i] = 'a' + i%26;
+    }
+    wson_stats_reset();
+    wson_push_type_array(buffer, 100);
+    for(int i=0; i<100; i++){
+        wson_push_type_string(buffer, text, sizeof(text));
+    }
+    wson_stats stats;
+    wson_stats_snapshot(&stats);
+    uint64_t resizes = stats.bufferResizes;
+    uint64_t resizeBytes = stats.bufferResizeBytes;
+
+    wson_stats_reset();
+    wson_parser parser((const char*)buffer->data, buffer->position);
+    parser.nextType();
+    int size = parser.nextArraySize();
+    for(int i=0; i<size; i++){
+        parser.nextStringUTF8(parser.nextType());
+    }
+    wson_stats_snapshot(&stats);
+    bool success = resizes > 0 && resizeBytes > 0
+                   && stats.decodeValues[WSON_STRING_TYPE] == 100
+                   && stats.decodeBytes[WSON_STRING_TYPE] == 100*(1 + 2 + sizeof(text))
+                   && stats.decodeValues[WSON_ARRAY_TYPE] == 1
+                   && stats.decodingBufferGrows > 0;
+    if(success){
+        printf("pass test_stats_decode_and_resize resize %llu copied %llu bytes \n",
+               (unsigned long long)resizes, (unsigned long long)resizeBytes);
+    }else{
+        printf("failed test_stats_decode_and_resize \n");
+    }
+    wson_buffer_free(buffer);
+}
+
+int main(){
+    if(!wson_stats_enabled()){
+        printf("failed wson stats not enabled \n");
+        return 1;
+    }
+    test_stats_encode();
+    test_stats_decode_and_resize();
+    return 0;
+}
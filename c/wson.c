@@ -3,6 +3,7 @@
 //
 
 #include "wson.h"
+#include "wson_stats.h"
 #include <stdio.h>
 
 
@@ -23,7 +24,19 @@ union float_number{
                                            msg_buffer_resize(buffer, (uint32_t)(size));\
                                       }}
 
+#ifdef WSON_STATS
+wson_stats wson_stats_counters;
+#define WSON_STATS_BEGIN  uint32_t statsStart = buffer->position;
+#define WSON_STATS_ENCODE(type)  {WSON_STATS_ADD(encodeValues[(uint8_t)(type)], 1);\
+                                  WSON_STATS_ADD(encodeBytes[(uint8_t)(type)], buffer->position - statsStart);}
+#else
+#define WSON_STATS_BEGIN
+#define WSON_STATS_ENCODE(type)
+#endif
+
 static inline void msg_buffer_resize(wson_buffer* buffer, uint32_t size){
+    WSON_STATS_ADD(bufferResizes, 1);
+    WSON_STATS_ADD(bufferResizeBytes, buffer->position);
     if(size < buffer->length){
          if(buffer->length < 1024*16){
             size = 1024*16;
@@ -88,6 +101,26 @@ inline void wson_push_uint(wson_buffer *buffer, uint32_t num){
     }while((num >>= 7) != 0);
     data[size - 1] &=0x7F;
     buffer->position += size;
+    WSON_STATS_ADD(encodeVarints[size], 1);
+}
+
+static inline void msg_buffer_varint_fixed(uint8_t* data, uint32_t num){
+    for(int i=0; i<WSON_UINT_FIXED_SIZE - 1; i++){
+        data[i] = (uint8_t)((num & 0x7F) | 0x80);
+        num >>= 7;
+    }
+    data[WSON_UINT_FIXED_SIZE - 1] = (uint8_t)(num & 0x0F);
+}
+
+void wson_push_uint_fixed(wson_buffer *buffer, uint32_t num){
+    WSON_BUFFER_ENSURE_SIZE(WSON_UINT_FIXED_SIZE);
+    msg_buffer_varint_fixed((uint8_t*)buffer->data + buffer->position, num);
+    buffer->position += WSON_UINT_FIXED_SIZE;
+    WSON_STATS_ADD(encodeVarints[WSON_UINT_FIXED_SIZE], 1);
+}
+
+void wson_patch_uint_fixed(wson_buffer *buffer, uint32_t position, uint32_t num){
+    msg_buffer_varint_fixed((uint8_t*)buffer->data + position, num);
 }
 
 inline void wson_push_byte(wson_buffer *buffer, uint8_t bt){
@@ -106,6 +139,7 @@ inline void wson_push_type(wson_buffer *buffer, uint8_t bt){
 
 
 inline void wson_push_type_boolean(wson_buffer *buffer, uint8_t value){
+    WSON_STATS_BEGIN
       WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t) + sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     if(value){
@@ -114,96 +148,158 @@ inline void wson_push_type_boolean(wson_buffer *buffer, uint8_t value){
         *data = WSON_BOOLEAN_TYPE_FALSE;
     }
     buffer->position += sizeof(uint8_t);
+    WSON_STATS_ENCODE(*data);
  }
 
 
 inline void wson_push_type_int(wson_buffer *buffer, int32_t num){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_NUMBER_INT_TYPE;
     buffer->position += (sizeof(uint8_t));
     wson_push_int(buffer, num);
+    WSON_STATS_ENCODE(WSON_NUMBER_INT_TYPE);
 }
 
 inline void wson_push_type_float(wson_buffer *buffer, float num){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_NUMBER_FLOAT_TYPE;
     buffer->position += (sizeof(uint8_t));
     wson_push_float(buffer, num);
+    WSON_STATS_ENCODE(WSON_NUMBER_FLOAT_TYPE);
 }
 
 inline void wson_push_type_double(wson_buffer *buffer, double num){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_NUMBER_DOUBLE_TYPE;
     buffer->position += (sizeof(uint8_t));
     wson_push_double(buffer, num);
+    WSON_STATS_ENCODE(WSON_NUMBER_DOUBLE_TYPE);
 }
 
 
 
 inline void wson_push_type_long(wson_buffer *buffer, int64_t num){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_NUMBER_LONG_TYPE;
     buffer->position += (sizeof(uint8_t));
     wson_push_ulong(buffer, num);
+    WSON_STATS_ENCODE(WSON_NUMBER_LONG_TYPE);
 }
 
 inline void wson_push_type_string(wson_buffer *buffer, const void *src, int32_t length){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_STRING_TYPE;
     buffer->position += (sizeof(uint8_t));
     wson_push_uint(buffer, length);
     wson_push_bytes(buffer, src, length);
+    WSON_STATS_ENCODE(WSON_STRING_TYPE);
 }
 
 inline void wson_push_property(wson_buffer *buffer, const void *src, int32_t length){
+    WSON_STATS_BEGIN
     wson_push_uint(buffer, length);
     wson_push_bytes(buffer, src, length);
+#ifdef WSON_STATS
+    WSON_STATS_ADD(encodePropertyBytes, buffer->position - statsStart);
+#endif
 }
 
 inline void wson_push_type_string_length(wson_buffer *buffer, int32_t length){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_STRING_TYPE;
     buffer->position += (sizeof(uint8_t));
     wson_push_uint(buffer, length);
+    WSON_STATS_ENCODE(WSON_STRING_TYPE);
 }
 
 inline void wson_push_type_null(wson_buffer *buffer){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_NULL_TYPE;
     buffer->position += (sizeof(uint8_t));
+    WSON_STATS_ENCODE(WSON_NULL_TYPE);
+}
+
+bool wson_push_type_nulls(wson_buffer *buffer, uint32_t count){
+    if(count == 0){
+        return true;
+    }
+    if(count > buffer->length - buffer->position){
+        uint64_t size = (uint64_t)buffer->position + count + WSON_BUFFER_SIZE;
+        if(size > UINT32_MAX){
+            return false;
+        }
+        void* data = realloc(buffer->data, (size_t)size);
+        if(data == NULL){
+            return false;
+        }
+        WSON_STATS_ADD(bufferResizes, 1);
+        WSON_STATS_ADD(bufferResizeBytes, buffer->position);
+        buffer->data = data;
+        buffer->length = (uint32_t)size;
+    }
+    memset((uint8_t*)buffer->data + buffer->position, WSON_NULL_TYPE, count);
+    buffer->position += count;
+    WSON_STATS_ADD(encodeValues[WSON_NULL_TYPE], count);
+    WSON_STATS_ADD(encodeBytes[WSON_NULL_TYPE], count);
+    return true;
 }
 
 inline void wson_push_type_map(wson_buffer *buffer, uint32_t size){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_MAP_TYPE;
     buffer->position += (sizeof(uint8_t));
     wson_push_uint(buffer, size);
+    WSON_STATS_ENCODE(WSON_MAP_TYPE);
+}
+
+uint32_t wson_push_type_map_reserve(wson_buffer *buffer){
+    WSON_STATS_BEGIN
+    WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
+    uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
+    *data = WSON_MAP_TYPE;
+    buffer->position += (sizeof(uint8_t));
+    uint32_t position = buffer->position;
+    wson_push_uint_fixed(buffer, 0);
+    WSON_STATS_ENCODE(WSON_MAP_TYPE);
+    return position;
 }
 
 inline void wson_push_type_array(wson_buffer *buffer, uint32_t size){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_ARRAY_TYPE;
     buffer->position += (sizeof(uint8_t));
     wson_push_uint(buffer, size);
+    WSON_STATS_ENCODE(WSON_ARRAY_TYPE);
 }
 
 
 inline void wson_push_type_extend(wson_buffer *buffer, const void *src, int32_t length){
+    WSON_STATS_BEGIN
     WSON_BUFFER_ENSURE_SIZE(sizeof(uint8_t));
     uint8_t* data = ((uint8_t*)buffer->data + buffer->position);
     *data = WSON_EXTEND_TYPE;
     buffer->position += (sizeof(uint8_t));
     wson_push_uint(buffer, length);
     wson_push_bytes(buffer, src, length);
+    WSON_STATS_ENCODE(WSON_EXTEND_TYPE);
 }
 
 inline void wson_push_ensure_size(wson_buffer *buffer, uint32_t dataSize){
@@ -251,9 +347,56 @@ inline void wson_push_bytes(wson_buffer *buffer, const void *src, int32_t length
     buffer->position += length;
 }
 
+#ifdef WSON_STATS
+/**
+ * peek value own size after tag, varint is read without counting it
+ * */
+static void wson_stats_decode_value(wson_buffer *buffer, uint8_t type){
+    uint8_t* data = (uint8_t*)buffer->data;
+    uint32_t position = buffer->position;
+    uint32_t size = sizeof(uint8_t);
+    uint32_t varint = 0;
+    uint32_t varintSize = 0;
+    if(type == WSON_STRING_TYPE || type == WSON_NUMBER_BIG_INT_TYPE || type == WSON_NUMBER_BIG_DECIMAL_TYPE
+       || type == WSON_EXTEND_TYPE || type == WSON_NUMBER_INT_TYPE || type == WSON_MAP_TYPE || type == WSON_ARRAY_TYPE){
+        while(position + varintSize < buffer->length && varintSize < 5){
+            uint8_t chunk = data[position + varintSize];
+            varint |= (uint32_t)(chunk & 0x7F) << (7*varintSize);
+            varintSize++;
+            if((chunk & 0x80) == 0){
+                break;
+            }
+        }
+        size += varintSize;
+    }
+    switch (type) {
+        case WSON_STRING_TYPE:
+        case WSON_NUMBER_BIG_INT_TYPE:
+        case WSON_NUMBER_BIG_DECIMAL_TYPE:
+        case WSON_EXTEND_TYPE:
+            size += varint;
+            break;
+        case WSON_NUMBER_FLOAT_TYPE:
+            size += sizeof(float);
+            break;
+        case WSON_NUMBER_DOUBLE_TYPE:
+        case WSON_NUMBER_LONG_TYPE:
+            size += sizeof(uint64_t);
+            break;
+        default:
+            break;
+    }
+    WSON_STATS_ADD(decodeValues[type], 1);
+    WSON_STATS_ADD(decodeBytes[type], size);
+}
+#endif
+
 inline int8_t wson_next_type(wson_buffer *buffer){
     int8_t* ptr = (int8_t*)((uint8_t*)buffer->data + buffer->position);
     buffer->position += sizeof(int8_t);
+#ifdef WSON_STATS
+    wson_stats_decode_value(buffer, (uint8_t)*ptr);
+#endif
     return *ptr;
 }
 
@@ -273,6 +416,7 @@ uint32_t wson_next_uint(wson_buffer *buffer){
     uint32_t num = *ptr;
     if((num & 0x80) == 0){
         buffer->position +=1;
+        WSON_STATS_ADD(decodeVarints[1], 1);
         return  num;
     }
     num &=0x7F;
@@ -280,12 +424,14 @@ uint32_t wson_next_uint(wson_buffer *buffer){
     num |= (chunk & 0x7F) << 7;
     if((chunk & 0x80) == 0){
         buffer->position += 2;
+        WSON_STATS_ADD(decodeVarints[2], 1);
         return  num;
     }
     chunk = ptr[2];
     num |= (chunk & 0x7F) << 14;
     if((chunk & 0x80) == 0){
         buffer->position += 3;
+        WSON_STATS_ADD(decodeVarints[3], 1);
         return  num;
     }
 
@@ -293,11 +439,13 @@ uint32_t wson_next_uint(wson_buffer *buffer){
     num |= (chunk & 0x7F) << 21;
     if((chunk & 0x80) == 0){
         buffer->position += 4;
+        WSON_STATS_ADD(decodeVarints[4], 1);
         return  num;
     }
     chunk = ptr[4];
     num |= (chunk & 0x0F) << 28;
     buffer->position += 5;
+    WSON_STATS_ADD(decodeVarints[5], 1);
     return  num;
 }
 
@@ -346,6 +494,45 @@ inline bool wson_has_next(wson_buffer *buffer){
     return buffer->position < buffer->length;
 }
 
+void wson_skip_value(wson_buffer *buffer){
+    uint8_t type = (uint8_t)wson_next_type(buffer);
+    switch (type) {
+        case WSON_STRING_TYPE:
+        case WSON_NUMBER_BIG_INT_TYPE:
+        case WSON_NUMBER_BIG_DECIMAL_TYPE:
+        case WSON_EXTEND_TYPE:
+            buffer->position += wson_next_uint(buffer);
+            return;
+        case WSON_NUMBER_INT_TYPE:
+            wson_next_uint(buffer);
+            return;
+        case WSON_NUMBER_FLOAT_TYPE:
+            buffer->position += sizeof(float);
+            return;
+        case WSON_NUMBER_DOUBLE_TYPE:
+        case WSON_NUMBER_LONG_TYPE:
+            buffer->position += sizeof(uint64_t);
+            return;
+        case WSON_MAP_TYPE:{
+                uint32_t length = wson_next_uint(buffer);
+                for(uint32_t i=0; i<length; i++){
+                    buffer->position += wson_next_uint(buffer);
+                    wson_skip_value(buffer);
+                }
+            }
+            return;
+        case WSON_ARRAY_TYPE:{
+                uint32_t length = wson_next_uint(buffer);
+                for(uint32_t i=0; i<length; i++){
+                    wson_skip_value(buffer);
+                }
+            }
+            return;
+        default:
+            return;
+    }
+}
+
 void wson_buffer_free(wson_buffer *buffer){
     if(buffer->data){
         free(buffer->data);
@@ -357,3 +544,32 @@ void wson_buffer_free(wson_buffer *buffer){
     }
 }
 
+
+void wson_stats_snapshot(wson_stats* stats){
+#ifdef WSON_STATS
+    uint64_t* from = (uint64_t*)&wson_stats_counters;
+    uint64_t* to = (uint64_t*)stats;
+    for(size_t i=0; i<sizeof(wson_stats)/sizeof(uint64_t); i++){
+        to[i] = __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+    }
+#else
+    memset(stats, 0, sizeof(wson_stats));
+#endif
+}
+
+void wson_stats_reset(void){
+#ifdef WSON_STATS
+    uint64_t* counters = (uint64_t*)&wson_stats_counters;
+    for(size_t i=0; i<sizeof(wson_stats)/sizeof(uint64_t); i++){
+        __atomic_store_n(&counters[i], 0, __ATOMIC_RELAXED);
+    }
+#endif
+}
+
+bool wson_stats_enabled(void){
+#ifdef WSON_STATS
+    return true;
+#else
+    return false;
+#endif
+}
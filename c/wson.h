@@ -76,12 +76,23 @@ void wson_push_type_float(wson_buffer *buffer, float num);
 void wson_push_type_double(wson_buffer *buffer, double num);
 void wson_push_type_string(wson_buffer *buffer, const void *src, int32_t length);
 void wson_push_type_null(wson_buffer *buffer);
+/**
+ * push count null values at once, such as holes of sparse array,
+ * return false and push nothing if buffer can not grow to hold count bytes
+ * */
+bool wson_push_type_nulls(wson_buffer *buffer, uint32_t count);
 void wson_push_type_map(wson_buffer *buffer, uint32_t size);
 void wson_push_type_array(wson_buffer *buffer, uint32_t size);
 void wson_push_type_extend(wson_buffer *buffer, const void *src, int32_t length);
 void wson_push_ensure_size(wson_buffer *buffer, uint32_t dataSize);
 void wson_push_type_string_length(wson_buffer *buffer, int32_t length);
 void wson_push_property(wson_buffer *buffer, const void *src, int32_t length);
+
+/**
+ * push map type with a fixed width size slot, return slot position for wson_patch_uint_fixed.
+ * used when map size is known only after entries are pushed, so entries can be encoded in one pass.
+ * */
+uint32_t wson_push_type_map_reserve(wson_buffer *buffer);
     
 /**
  * push int, varint uint byte int double bts to buffer, without type signature
@@ -95,6 +106,13 @@ void wson_push_float(wson_buffer *buffer, float num);
 void wson_push_ulong(wson_buffer *buffer, uint64_t num);
 void wson_push_bytes(wson_buffer *buffer, const void *src, int32_t length);
 
+/**
+ * varint padded to WSON_UINT_FIXED_SIZE bytes, decode as normal varint, can be rewritten in place
+ * */
+#define WSON_UINT_FIXED_SIZE 5
+void wson_push_uint_fixed(wson_buffer *buffer, uint32_t num);
+void wson_patch_uint_fixed(wson_buffer *buffer, uint32_t position, uint32_t num);
+
 
 /**
  * free  buffer
@@ -116,6 +134,11 @@ uint64_t wson_next_ulong(wson_buffer *buffer);
 uint8_t* wson_next_bts(wson_buffer *buffer, uint32_t length);
 bool wson_has_next(wson_buffer *buffer);
 
+/**
+ * skip one value from current position, include type signature
+ * */
+void wson_skip_value(wson_buffer *buffer);
+
 
 /** constructor with data */
 wson_buffer* wson_buffer_from(void* data, uint32_t length);
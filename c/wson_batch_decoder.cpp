@@ -0,0 +1,151 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "wson_batch_decoder.h"
+#include <stdint.h>
+
+/**
+ * record files may be bigger than wson_buffer can address, so split walks with 64 bit offset and checks bounds
+ * */
+static inline bool batch_next_uint(const uint8_t* data, uint64_t length, uint64_t& position, uint32_t& num){
+    num = 0;
+    for(int shift=0; shift<35; shift+=7){
+        if(position >= length){
+            return false;
+        }
+        uint8_t chunk = data[position++];
+        num |= ((uint32_t)(chunk & 0x7F)) << shift;
+        if((chunk & 0x80) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool batch_skip_value(const uint8_t* data, uint64_t length, uint64_t& position){
+    if(position >= length){
+        return false;
+    }
+    uint8_t type = data[position++];
+    uint32_t size = 0;
+    switch (type) {
+        case WSON_STRING_TYPE:
+        case WSON_NUMBER_BIG_INT_TYPE:
+        case WSON_NUMBER_BIG_DECIMAL_TYPE:
+        case WSON_EXTEND_TYPE:
+            if(!batch_next_uint(data, length, position, size)){
+                return false;
+            }
+            position += size;
+            return position <= length;
+        case WSON_NUMBER_INT_TYPE:
+            return batch_next_uint(data, length, position, size);
+        case WSON_NUMBER_FLOAT_TYPE:
+            position += sizeof(float);
+            return position <= length;
+        case WSON_NUMBER_DOUBLE_TYPE:
+        case WSON_NUMBER_LONG_TYPE:
+            position += sizeof(uint64_t);
+            return position <= length;
+        case WSON_NULL_TYPE:
+        case WSON_BOOLEAN_TYPE_TRUE:
+        case WSON_BOOLEAN_TYPE_FALSE:
+            return true;
+        case WSON_MAP_TYPE:{
+                if(!batch_next_uint(data, length, position, size)){
+                    return false;
+                }
+                for(uint32_t i=0; i<size; i++){
+                    uint32_t keyLength = 0;
+                    if(!batch_next_uint(data, length, position, keyLength)){
+                        return false;
+                    }
+                    position += keyLength;
+                    if(!batch_skip_value(data, length, position)){
+                        return false;
+                    }
+                }
+            }
+            return true;
+        case WSON_ARRAY_TYPE:{
+                if(!batch_next_uint(data, length, position, size)){
+                    return false;
+                }
+                for(uint32_t i=0; i<size; i++){
+                    if(!batch_skip_value(data, length, position)){
+                        return false;
+                    }
+                }
+            }
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+
+wson_batch_decoder::wson_batch_decoder(wson_thread_pool *pool, uint32_t chunkSize) {
+    this->pool = pool;
+    this->chunkSize = chunkSize > 0 ? std::min(chunkSize, (uint32_t)INT32_MAX) : WSON_BATCH_DEFAULT_CHUNK_SIZE;
+}
+
+bool wson_batch_decoder::split(const char *data, uint64_t length, int mode, std::vector<wson_batch_chunk> &chunks) {
+    const uint8_t* bts = (const uint8_t*)data;
+    uint64_t position = 0;
+    uint64_t count = UINT64_MAX;
+    chunks.clear();
+    records = 0;
+    if(mode == WSON_BATCH_CONTAINER){
+        uint32_t size = 0;
+        if(length == 0 || bts[position++] != WSON_ARRAY_TYPE
+           || !batch_next_uint(bts, length, position, size)){
+            return false;
+        }
+        count = size;
+    }
+    wson_batch_chunk chunk = {0, position, 0, 0};
+    while(records < count && position < length){
+        uint64_t start = position;
+        if(!batch_skip_value(bts, length, position) || position - start > INT32_MAX){
+            return false;
+        }
+        /** one record never straddles two chunks, a big record is a chunk on its own */
+        if(chunk.recordCount > 0 && (position - chunk.offset > chunkSize || position - chunk.offset > INT32_MAX)){
+            chunks.push_back(chunk);
+            chunk.firstRecord = records;
+            chunk.offset = start;
+            chunk.recordCount = 0;
+        }
+        chunk.length = (uint32_t)(position - chunk.offset);
+        chunk.recordCount++;
+        records++;
+    }
+    if(chunk.recordCount > 0){
+        chunks.push_back(chunk);
+    }
+    return count == UINT64_MAX || records == count;
+}
+
+bool wson_batch_decoder::toJSON(const char *data, uint64_t length, int mode,
+                                std::function<void(uint64_t, std::string &)> consumer, bool ordered) {
+    return decode<std::string>(data, length, mode, [](wson_parser& parser){
+        return parser.nextStringUTF8(parser.nextType());
+    }, consumer, ordered);
+}
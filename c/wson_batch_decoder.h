@@ -0,0 +1,184 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * parallel batch decode for big record files. input is split by record boundaries into chunks,
+ * chunks are decoded on work stealing pool, results delivered in record order or as soon as decoded.
+ * */
+
+#ifndef WSON_BATCH_DECODER_H
+#define WSON_BATCH_DECODER_H
+
+#include "wson.h"
+#include "wson_parser.h"
+#include "wson_thread_pool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * record stream is wson values one after another, container is one top level array, every element is record
+ * */
+#define WSON_BATCH_RECORD_STREAM  0
+#define WSON_BATCH_CONTAINER      1
+
+#define WSON_BATCH_DEFAULT_CHUNK_SIZE  (256*1024)
+
+/**
+ * ordered decode keeps at most window chunks per worker decoded ahead of consumer, so memory stays bounded
+ * */
+#define WSON_BATCH_REORDER_WINDOW  4
+
+struct wson_batch_chunk {
+    uint64_t firstRecord;
+    uint64_t offset;
+    uint32_t length;
+    uint32_t recordCount;
+};
+
+class wson_batch_decoder {
+
+public:
+    /**
+     * chunkSize is approximate bytes of records decoded by one task, at most INT32_MAX as parser length is int
+     * */
+    wson_batch_decoder(wson_thread_pool* pool, uint32_t chunkSize = WSON_BATCH_DEFAULT_CHUNK_SIZE);
+
+    /**
+     * split data into chunks on record boundaries, return false if data is truncated, mode not match
+     * or one record is bigger than INT32_MAX
+     * */
+    bool split(const char* data, uint64_t length, int mode, std::vector<wson_batch_chunk>& chunks);
+
+    /**
+     * decode every record with decoder on pool. decoder reads exactly one value from parser.
+     * ordered consumer is called on caller thread in record order,
+     * unordered consumer is called on worker threads as soon as chunk decoded and must be thread safe.
+     * safe to call from a task of the same pool, waiting caller runs queued tasks instead of blocking.
+     * */
+    template<typename T>
+    bool decode(const char* data, uint64_t length, int mode,
+                std::function<T(wson_parser& parser)> decoder,
+                std::function<void(uint64_t index, T& value)> consumer, bool ordered);
+
+    /**
+     * convert every record to json string
+     * */
+    bool toJSON(const char* data, uint64_t length, int mode,
+                std::function<void(uint64_t index, std::string& json)> consumer, bool ordered);
+
+    inline uint64_t recordCount(){
+        return records;
+    }
+
+private:
+    wson_thread_pool* pool;
+    uint32_t chunkSize;
+    uint64_t records = 0;
+};
+
+
+template<typename T>
+bool wson_batch_decoder::decode(const char *data, uint64_t length, int mode,
+                                std::function<T(wson_parser &)> decoder,
+                                std::function<void(uint64_t, T &)> consumer, bool ordered) {
+    std::vector<wson_batch_chunk> chunks;
+    if(!split(data, length, mode, chunks)){
+        return false;
+    }
+    struct chunk_result {
+        std::vector<T> values;
+        bool done = false;
+    };
+    std::vector<chunk_result> results(ordered ? chunks.size() : 0);
+    std::mutex lock;
+    std::condition_variable condition;
+    size_t finished = 0;
+    size_t submitted = 0;
+    auto submitChunk = [&](size_t i){
+        pool->submit([&, i]{
+            const wson_batch_chunk& chunk = chunks[i];
+            wson_parser parser(data + chunk.offset, (int)chunk.length);
+            std::vector<T> values;
+            values.reserve(chunk.recordCount);
+            for(uint32_t r=0; r<chunk.recordCount; r++){
+                values.push_back(decoder(parser));
+            }
+            if(!ordered){
+                for(uint32_t r=0; r<chunk.recordCount; r++){
+                    consumer(chunk.firstRecord + r, values[r]);
+                }
+            }
+            std::unique_lock<std::mutex> guard(lock);
+            if(ordered){
+                results[i].values.swap(values);
+                results[i].done = true;
+            }
+            finished++;
+            condition.notify_all();
+        });
+    };
+    /** help the pool while waiting, once nothing is queued every own task is running and will notify */
+    auto await = [&](const std::function<bool()>& ready){
+        for(;;){
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                if(ready()){
+                    return;
+                }
+            }
+            if(!pool->runOne()){
+                std::unique_lock<std::mutex> guard(lock);
+                condition.wait(guard, ready);
+                return;
+            }
+        }
+    };
+    size_t window = chunks.size();
+    if(ordered){
+        window = (size_t)std::max(pool->threadCount(), 1)*WSON_BATCH_REORDER_WINDOW;
+    }
+    for(; submitted < chunks.size() && submitted < window; submitted++){
+        submitChunk(submitted);
+    }
+    if(ordered){
+        for(size_t i=0; i<chunks.size(); i++){
+            std::vector<T> values;
+            await([&]{ return results[i].done; });
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                values.swap(results[i].values);
+            }
+            if(submitted < chunks.size()){
+                submitChunk(submitted++);
+            }
+            for(size_t r=0; r<values.size(); r++){
+                consumer(chunks[i].firstRecord + r, values[r]);
+            }
+        }
+    }
+    await([&]{ return finished == submitted; });
+    return true;
+}
+
+#endif //WSON_BATCH_DECODER_H
@@ -0,0 +1,385 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "wson_block_stream.h"
+#include "wson_parser.h"
+#include <zlib.h>
+#include <condition_variable>
+#include <mutex>
+
+static const uint8_t WSON_BLOCK_MAGIC[4] = {'W', 'S', 'B', '1'};
+static const uint8_t WSON_BLOCK_INDEX_MAGIC[4] = {'W', 'S', 'B', 'I'};
+
+static inline void block_put_u32(uint8_t* data, uint32_t num){
+    data[0] = (uint8_t)((num >> 24) & 0xFF);
+    data[1] = (uint8_t)((num >> 16) & 0xFF);
+    data[2] = (uint8_t)((num >> 8) & 0xFF);
+    data[3] = (uint8_t)(num & 0xFF);
+}
+
+static inline void block_put_u64(uint8_t* data, uint64_t num){
+    block_put_u32(data, (uint32_t)(num >> 32));
+    block_put_u32(data + 4, (uint32_t)(num & 0xFFFFFFFF));
+}
+
+static inline uint32_t block_get_u32(const uint8_t* data){
+    return (((uint32_t)data[0]) << 24)
+           + (((uint32_t)data[1]) << 16)
+           + (((uint32_t)data[2]) << 8)
+           + ((uint32_t)data[3]);
+}
+
+static inline uint64_t block_get_u64(const uint8_t* data){
+    return (((uint64_t)block_get_u32(data)) << 32) + block_get_u32(data + 4);
+}
+
+static inline uint32_t block_crc32(const uint8_t* data, uint32_t length){
+    return (uint32_t)crc32(crc32(0L, Z_NULL, 0), data, length);
+}
+
+
+wson_block_writer::wson_block_writer(FILE *file, uint32_t blockSize, int level) {
+    this->file = file;
+    this->buffer = nullptr;
+    this->blockSize = blockSize > 0 ? blockSize : WSON_BLOCK_DEFAULT_SIZE;
+    this->level = level;
+    pending.reserve(this->blockSize + 1024);
+    write(WSON_BLOCK_MAGIC, sizeof(WSON_BLOCK_MAGIC));
+}
+
+wson_block_writer::wson_block_writer(wson_buffer *buffer, uint32_t blockSize, int level) {
+    this->file = nullptr;
+    this->buffer = buffer;
+    this->blockSize = blockSize > 0 ? blockSize : WSON_BLOCK_DEFAULT_SIZE;
+    this->level = level;
+    pending.reserve(this->blockSize + 1024);
+    write(WSON_BLOCK_MAGIC, sizeof(WSON_BLOCK_MAGIC));
+}
+
+wson_block_writer::~wson_block_writer() {
+    if(!finished){
+        finish();
+    }
+}
+
+bool wson_block_writer::write(const void *data, uint32_t length) {
+    if(file){
+        if(fwrite(data, 1, length, file) != length){
+            return false;
+        }
+    }else{
+        wson_push_bytes(buffer, data, length);
+    }
+    offset += length;
+    return true;
+}
+
+bool wson_block_writer::addRecord(const void *data, uint32_t length) {
+    if(finished){
+        return false;
+    }
+    const uint8_t* bts = (const uint8_t*)data;
+    pending.insert(pending.end(), bts, bts + length);
+    pendingRecords++;
+    records++;
+    if(pending.size() >= blockSize){
+        return flushBlock();
+    }
+    return true;
+}
+
+bool wson_block_writer::flushBlock() {
+    if(pendingRecords == 0){
+        return true;
+    }
+    uLongf compressedLength = compressBound((uLong)pending.size());
+    compressed.resize(compressedLength);
+    if(compress2(compressed.data(), &compressedLength, pending.data(), (uLong)pending.size(), level) != Z_OK){
+        return false;
+    }
+    wson_block_info info;
+    info.offset = offset;
+    info.firstRecord = records - pendingRecords;
+    info.compressedLength = (uint32_t)compressedLength;
+    info.rawLength = (uint32_t)pending.size();
+    info.recordCount = pendingRecords;
+    info.checksum = block_crc32(pending.data(), info.rawLength);
+
+    uint8_t frame[WSON_BLOCK_FRAME_SIZE];
+    block_put_u32(frame, info.compressedLength);
+    block_put_u32(frame + 4, info.rawLength);
+    block_put_u32(frame + 8, info.recordCount);
+    block_put_u32(frame + 12, info.checksum);
+    if(!write(frame, WSON_BLOCK_FRAME_SIZE) || !write(compressed.data(), info.compressedLength)){
+        return false;
+    }
+    blocks.push_back(info);
+    pending.clear();
+    pendingRecords = 0;
+    return true;
+}
+
+bool wson_block_writer::finish() {
+    if(finished){
+        return false;
+    }
+    bool success = flushBlock();
+    finished = true;
+    uint64_t indexOffset = offset;
+    std::vector<uint8_t> index(blocks.size()*WSON_BLOCK_INDEX_ENTRY_SIZE);
+    uint8_t* entry = index.data();
+    for(size_t i=0; i<blocks.size(); i++){
+        wson_block_info& info = blocks[i];
+        block_put_u64(entry, info.offset);
+        block_put_u64(entry + 8, info.firstRecord);
+        block_put_u32(entry + 16, info.compressedLength);
+        block_put_u32(entry + 20, info.rawLength);
+        block_put_u32(entry + 24, info.recordCount);
+        block_put_u32(entry + 28, info.checksum);
+        entry += WSON_BLOCK_INDEX_ENTRY_SIZE;
+    }
+    uint8_t trailer[WSON_BLOCK_TRAILER_SIZE];
+    block_put_u32(trailer, (uint32_t)blocks.size());
+    block_put_u64(trailer + 4, indexOffset);
+    block_put_u32(trailer + 12, block_crc32(index.data(), (uint32_t)index.size()));
+    memcpy(trailer + 16, WSON_BLOCK_INDEX_MAGIC, sizeof(WSON_BLOCK_INDEX_MAGIC));
+    if(index.size() > 0){
+        success = write(index.data(), (uint32_t)index.size()) && success;
+    }
+    success = write(trailer, WSON_BLOCK_TRAILER_SIZE) && success;
+    if(file){
+        fflush(file);
+    }
+    return success;
+}
+
+
+wson_block_reader::wson_block_reader(const char *data, uint64_t length) {
+    this->data = (const uint8_t*)data;
+    this->length = length;
+    this->file = nullptr;
+    this->valid = loadIndex();
+}
+
+wson_block_reader::wson_block_reader(FILE *file) {
+    this->data = nullptr;
+    this->length = 0;
+    this->file = file;
+    if(file && fseeko(file, 0, SEEK_END) == 0){
+        off_t end = ftello(file);
+        if(end > 0){
+            this->length = (uint64_t)end;
+        }
+    }
+    this->valid = loadIndex();
+}
+
+wson_block_reader::~wson_block_reader() {
+    data = nullptr;
+    file = nullptr;
+}
+
+bool wson_block_reader::readBytes(uint64_t offset, uint32_t size, std::vector<uint8_t> &out, const uint8_t **ptr) {
+    if(offset > length || length - offset < size){
+        return false;
+    }
+    if(data){
+        *ptr = data + offset;
+        return true;
+    }
+    out.resize(size);
+    std::unique_lock<std::mutex> guard(fileLock);
+    if(fseeko(file, (off_t)offset, SEEK_SET) != 0){
+        return false;
+    }
+    if(size > 0 && fread(out.data(), 1, size, file) != size){
+        return false;
+    }
+    *ptr = out.data();
+    return true;
+}
+
+bool wson_block_reader::loadIndex() {
+    if(length < WSON_BLOCK_HEADER_SIZE + WSON_BLOCK_TRAILER_SIZE){
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    const uint8_t* ptr = nullptr;
+    if(!readBytes(0, WSON_BLOCK_HEADER_SIZE, bytes, &ptr)
+       || memcmp(ptr, WSON_BLOCK_MAGIC, sizeof(WSON_BLOCK_MAGIC)) != 0){
+        return false;
+    }
+    if(!readBytes(length - WSON_BLOCK_TRAILER_SIZE, WSON_BLOCK_TRAILER_SIZE, bytes, &ptr)
+       || memcmp(ptr + 16, WSON_BLOCK_INDEX_MAGIC, sizeof(WSON_BLOCK_INDEX_MAGIC)) != 0){
+        return false;
+    }
+    uint32_t count = block_get_u32(ptr);
+    indexOffset = block_get_u64(ptr + 4);
+    uint32_t indexChecksum = block_get_u32(ptr + 12);
+    uint64_t indexLength = ((uint64_t)count)*WSON_BLOCK_INDEX_ENTRY_SIZE;
+    if(indexOffset < WSON_BLOCK_HEADER_SIZE
+       || indexOffset + indexLength + WSON_BLOCK_TRAILER_SIZE != length){
+        return false;
+    }
+    if(!readBytes(indexOffset, (uint32_t)indexLength, bytes, &ptr)
+       || block_crc32(ptr, (uint32_t)indexLength) != indexChecksum){
+        return false;
+    }
+    blocks.resize(count);
+    records = 0;
+    for(uint32_t i=0; i<count; i++){
+        const uint8_t* entry = ptr + ((size_t)i)*WSON_BLOCK_INDEX_ENTRY_SIZE;
+        wson_block_info& info = blocks[i];
+        info.offset = block_get_u64(entry);
+        info.firstRecord = block_get_u64(entry + 8);
+        info.compressedLength = block_get_u32(entry + 16);
+        info.rawLength = block_get_u32(entry + 20);
+        info.recordCount = block_get_u32(entry + 24);
+        info.checksum = block_get_u32(entry + 28);
+        if(info.firstRecord != records
+           || info.offset + WSON_BLOCK_FRAME_SIZE + info.compressedLength > indexOffset){
+            blocks.clear();
+            return false;
+        }
+        records += info.recordCount;
+    }
+    return true;
+}
+
+int32_t wson_block_reader::findBlock(uint64_t record) {
+    if(record >= records){
+        return -1;
+    }
+    uint32_t low = 0;
+    uint32_t high = (uint32_t)blocks.size();
+    while(low + 1 < high){
+        uint32_t middle = (low + high)/2;
+        if(blocks[middle].firstRecord <= record){
+            low = middle;
+        }else{
+            high = middle;
+        }
+    }
+    return (int32_t)low;
+}
+
+bool wson_block_reader::readBlock(uint32_t index, std::vector<uint8_t> &out) {
+    if(!valid || index >= blocks.size()){
+        return false;
+    }
+    const wson_block_info& info = blocks[index];
+    std::vector<uint8_t> bytes;
+    const uint8_t* ptr = nullptr;
+    if(!readBytes(info.offset, WSON_BLOCK_FRAME_SIZE + info.compressedLength, bytes, &ptr)){
+        return false;
+    }
+    if(block_get_u32(ptr) != info.compressedLength
+       || block_get_u32(ptr + 4) != info.rawLength
+       || block_get_u32(ptr + 8) != info.recordCount
+       || block_get_u32(ptr + 12) != info.checksum){
+        return false;
+    }
+    out.resize(info.rawLength);
+    uLongf rawLength = info.rawLength;
+    if(uncompress(out.data(), &rawLength, ptr + WSON_BLOCK_FRAME_SIZE, info.compressedLength) != Z_OK
+       || rawLength != info.rawLength){
+        out.clear();
+        return false;
+    }
+    if(block_crc32(out.data(), info.rawLength) != info.checksum){
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+bool wson_block_reader::readBlocks(uint32_t first, uint32_t count, std::vector<std::vector<uint8_t> > &out, wson_thread_pool *pool) {
+    if(!valid || first > blocks.size() || blocks.size() - first < count){
+        return false;
+    }
+    out.resize(count);
+    if(pool == nullptr || count <= 1){
+        for(uint32_t i=0; i<count; i++){
+            if(!readBlock(first + i, out[i])){
+                return false;
+            }
+        }
+        return true;
+    }
+    std::vector<uint8_t> success(count, 0);
+    /** wait own blocks only, pool may be shared with other work */
+    std::mutex lock;
+    std::condition_variable condition;
+    uint32_t remain = count;
+    for(uint32_t i=0; i<count; i++){
+        pool->submit([this, first, i, &out, &success, &lock, &condition, &remain]{
+            success[i] = readBlock(first + i, out[i]) ? 1 : 0;
+            std::unique_lock<std::mutex> guard(lock);
+            remain--;
+            condition.notify_all();
+        });
+    }
+    /** help with queued tasks while waiting, so a caller running on pool worker never starves own blocks */
+    for(;;){
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            if(remain == 0){
+                break;
+            }
+        }
+        if(!pool->runOne()){
+            std::unique_lock<std::mutex> guard(lock);
+            condition.wait(guard, [&remain]{ return remain == 0; });
+            break;
+        }
+    }
+    for(uint32_t i=0; i<count; i++){
+        if(!success[i]){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool wson_block_reader::readRecord(uint64_t record, std::vector<uint8_t> &out) {
+    int32_t index = findBlock(record);
+    if(index < 0){
+        return false;
+    }
+    std::vector<uint8_t> block;
+    if(!readBlock((uint32_t)index, block)){
+        return false;
+    }
+    wson_parser parser((const char*)block.data(), (int)block.size());
+    uint64_t skip = record - blocks[index].firstRecord;
+    for(uint64_t i=0; i<skip && parser.hasNext(); i++){
+        parser.skipValue(parser.nextType());
+    }
+    if(!parser.hasNext()){
+        return false;
+    }
+    int start = parser.getState();
+    parser.skipValue(parser.nextType());
+    int end = parser.getState();
+    if(end > (int)block.size()){
+        return false;
+    }
+    out.assign(block.begin() + start, block.begin() + end);
+    return true;
+}
@@ -0,0 +1,180 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * block compressed wson record stream, records are complete wson values grouped into zlib blocks,
+ * so reader can inflate only the blocks it needs.
+ *
+ * stream  : header + block ... + index + trailer
+ * header  : magic "WSB1"
+ * block   : compressed length(u32) + raw length(u32) + record count(u32) + crc32 of raw bytes(u32) + deflate bytes
+ * index   : one entry per block, offset(u64) + first record(u64) + compressed length(u32) + raw length(u32)
+ *           + record count(u32) + crc32(u32)
+ * trailer : block count(u32) + index offset(u64) + index crc32(u32) + magic "WSBI"
+ *
+ * fixed numbers are big endian, same as wson double and long.
+ * */
+
+#ifndef WSON_BLOCK_STREAM_H
+#define WSON_BLOCK_STREAM_H
+
+#include "wson.h"
+#include "wson_thread_pool.h"
+
+#include <stdio.h>
+#include <mutex>
+#include <vector>
+
+#define WSON_BLOCK_DEFAULT_SIZE  (64*1024)
+#define WSON_BLOCK_HEADER_SIZE   4
+#define WSON_BLOCK_FRAME_SIZE    16
+#define WSON_BLOCK_INDEX_ENTRY_SIZE  32
+#define WSON_BLOCK_TRAILER_SIZE  20
+
+struct wson_block_info {
+    uint64_t offset;
+    uint64_t firstRecord;
+    uint32_t compressedLength;
+    uint32_t rawLength;
+    uint32_t recordCount;
+    uint32_t checksum;
+};
+
+class wson_block_writer {
+
+public:
+    /**
+     * write stream to file, level is zlib compress level, -1 is zlib default
+     * */
+    wson_block_writer(FILE* file, uint32_t blockSize = WSON_BLOCK_DEFAULT_SIZE, int level = -1);
+
+    /**
+     * write stream to buffer, buffer->position is stream end
+     * */
+    wson_block_writer(wson_buffer* buffer, uint32_t blockSize = WSON_BLOCK_DEFAULT_SIZE, int level = -1);
+    ~wson_block_writer();
+
+    /**
+     * append one complete wson value, block is compressed when raw size reach block size
+     * */
+    bool addRecord(const void* data, uint32_t length);
+
+    /**
+     * compress pending records into block
+     * */
+    bool flushBlock();
+
+    /**
+     * write last block, index and trailer, writer can not be used after finish
+     * */
+    bool finish();
+
+    inline uint32_t blockCount(){
+        return (uint32_t)blocks.size();
+    }
+
+    inline uint64_t recordCount(){
+        return records;
+    }
+
+private:
+    bool write(const void* data, uint32_t length);
+
+    FILE* file;
+    wson_buffer* buffer;
+    uint32_t blockSize;
+    int level;
+    uint64_t offset = 0;
+    uint64_t records = 0;
+    uint32_t pendingRecords = 0;
+    bool finished = false;
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> compressed;
+    std::vector<wson_block_info> blocks;
+};
+
+
+class wson_block_reader {
+
+public:
+    /**
+     * read stream from memory, data must outlive reader
+     * */
+    wson_block_reader(const char* data, uint64_t length);
+
+    /**
+     * read stream from file, only index and requested blocks are read
+     * */
+    wson_block_reader(FILE* file);
+    ~wson_block_reader();
+
+    /**
+     * trailer and index is valid
+     * */
+    inline bool isValid(){
+        return valid;
+    }
+
+    inline uint32_t blockCount(){
+        return (uint32_t)blocks.size();
+    }
+
+    inline uint64_t recordCount(){
+        return records;
+    }
+
+    inline const wson_block_info& blockInfo(uint32_t index){
+        return blocks[index];
+    }
+
+    /**
+     * return block index contains record, -1 if not found
+     * */
+    int32_t findBlock(uint64_t record);
+
+    /**
+     * inflate block and verify checksum, out contains concatenated records
+     * */
+    bool readBlock(uint32_t index, std::vector<uint8_t>& out);
+
+    /**
+     * inflate count blocks from first, in parallel when pool is not null
+     * */
+    bool readBlocks(uint32_t first, uint32_t count, std::vector<std::vector<uint8_t> >& out, wson_thread_pool* pool);
+
+    /**
+     * random access one record, only its block is inflated
+     * */
+    bool readRecord(uint64_t record, std::vector<uint8_t>& out);
+
+private:
+    bool loadIndex();
+    bool readBytes(uint64_t offset, uint32_t length, std::vector<uint8_t>& out, const uint8_t** ptr);
+
+    const uint8_t* data;
+    uint64_t length;
+    FILE* file;
+    std::mutex fileLock;
+    bool valid = false;
+    uint64_t records = 0;
+    uint64_t indexOffset = 0;
+    std::vector<wson_block_info> blocks;
+};
+
+#endif //WSON_BLOCK_STREAM_H
@@ -0,0 +1,674 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "wson_diff.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * map with more entries use hash lookup, less use linear scan
+ * */
+#define WSON_DIFF_LINEAR_KEYS  16
+
+/**
+ * max container depth accepted from input, deeper value is treated as malformed
+ * */
+#define WSON_DIFF_MAX_DEPTH  512
+
+namespace {
+
+    struct value_span {
+        const uint8_t* key;
+        uint32_t keyLength;
+        uint32_t start;
+        uint32_t end;
+    };
+
+    struct key_view {
+        const uint8_t* data;
+        uint32_t length;
+        bool operator==(const key_view& other) const{
+            return length == other.length && memcmp(data, other.data, length) == 0;
+        }
+    };
+
+    struct key_view_hash {
+        size_t operator()(const key_view& key) const{
+            uint32_t hash = 2166136261u;
+            for(uint32_t i=0; i<key.length; i++){
+                hash = (hash ^ key.data[i])*16777619u;
+            }
+            return hash;
+        }
+    };
+
+    /**
+     * bounded reads, old, new and patch input may be truncated or malformed,
+     * every read checks buffer length and returns false instead of reading past it
+     * */
+    inline bool next_type(wson_buffer* buffer, uint8_t& type){
+        if(buffer->position >= buffer->length){
+            return false;
+        }
+        type = ((const uint8_t*)buffer->data)[buffer->position++];
+        return true;
+    }
+
+    inline bool next_uint(wson_buffer* buffer, uint32_t& num){
+        num = 0;
+        for(int shift=0; shift<35; shift+=7){
+            if(buffer->position >= buffer->length){
+                return false;
+            }
+            uint8_t chunk = ((const uint8_t*)buffer->data)[buffer->position++];
+            num |= ((uint32_t)(chunk & 0x7F)) << shift;
+            if((chunk & 0x80) == 0){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool next_int(wson_buffer* buffer, int32_t& num){
+        uint32_t raw;
+        if(!next_uint(buffer, raw)){
+            return false;
+        }
+        num = (int32_t)((raw >> 1) ^ -(raw & 1));
+        return true;
+    }
+
+    inline bool next_bytes(wson_buffer* buffer, uint32_t length, const uint8_t*& bytes){
+        if(length > buffer->length - buffer->position){
+            return false;
+        }
+        bytes = (const uint8_t*)buffer->data + buffer->position;
+        buffer->position += length;
+        return true;
+    }
+
+    inline bool skip_bytes(wson_buffer* buffer, uint32_t length){
+        const uint8_t* bytes;
+        return next_bytes(buffer, length, bytes);
+    }
+
+    bool skip_value(wson_buffer* buffer, int depth = 0){
+        uint8_t type;
+        uint32_t size;
+        if(depth > WSON_DIFF_MAX_DEPTH || !next_type(buffer, type)){
+            return false;
+        }
+        switch (type) {
+            case WSON_STRING_TYPE:
+            case WSON_NUMBER_BIG_INT_TYPE:
+            case WSON_NUMBER_BIG_DECIMAL_TYPE:
+            case WSON_EXTEND_TYPE:
+                return next_uint(buffer, size) && skip_bytes(buffer, size);
+            case WSON_NUMBER_INT_TYPE:
+                return next_uint(buffer, size);
+            case WSON_NUMBER_FLOAT_TYPE:
+                return skip_bytes(buffer, sizeof(float));
+            case WSON_NUMBER_DOUBLE_TYPE:
+            case WSON_NUMBER_LONG_TYPE:
+                return skip_bytes(buffer, sizeof(uint64_t));
+            case WSON_NULL_TYPE:
+            case WSON_BOOLEAN_TYPE_TRUE:
+            case WSON_BOOLEAN_TYPE_FALSE:
+                return true;
+            case WSON_MAP_TYPE:
+                if(!next_uint(buffer, size)){
+                    return false;
+                }
+                for(uint32_t i=0; i<size; i++){
+                    uint32_t keyLength;
+                    if(!next_uint(buffer, keyLength) || !skip_bytes(buffer, keyLength)
+                       || !skip_value(buffer, depth + 1)){
+                        return false;
+                    }
+                }
+                return true;
+            case WSON_ARRAY_TYPE:
+                if(!next_uint(buffer, size)){
+                    return false;
+                }
+                for(uint32_t i=0; i<size; i++){
+                    if(!skip_value(buffer, depth + 1)){
+                        return false;
+                    }
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * read container entries, return false if data is truncated
+     * */
+    bool read_entries(wson_buffer* buffer, uint32_t start, uint32_t end, std::vector<value_span>& entries){
+        wson_buffer bounded = {buffer->data, start, end};
+        uint8_t type;
+        uint32_t count;
+        if(!next_type(&bounded, type) || !next_uint(&bounded, count) || count > end - bounded.position){
+            return false;
+        }
+        entries.resize(count);
+        for(uint32_t i=0; i<count; i++){
+            value_span& span = entries[i];
+            span.key = nullptr;
+            span.keyLength = 0;
+            if(type == WSON_MAP_TYPE){
+                if(!next_uint(&bounded, span.keyLength) || !next_bytes(&bounded, span.keyLength, span.key)){
+                    return false;
+                }
+            }
+            span.start = bounded.position;
+            if(!skip_value(&bounded)){
+                return false;
+            }
+            span.end = bounded.position;
+        }
+        return true;
+    }
+
+
+    struct path_segment {
+        const uint8_t* key;
+        uint32_t keyLength;
+        uint32_t index;
+    };
+
+    class wson_differ {
+    public:
+        wson_differ(const uint8_t* oldData, uint32_t oldLength, const uint8_t* newData, uint32_t newLength){
+            oldBuffer = wson_buffer_from((void*)oldData, oldLength);
+            newBuffer = wson_buffer_from((void*)newData, newLength);
+            ops = wson_buffer_new();
+        }
+
+        ~wson_differ(){
+            oldBuffer->data = nullptr;
+            newBuffer->data = nullptr;
+            wson_buffer_free(oldBuffer);
+            wson_buffer_free(newBuffer);
+            if(ops){
+                wson_buffer_free(ops);
+            }
+        }
+
+        wson_buffer* diff(){
+            uint32_t oldEnd = valueEnd(oldBuffer, 0);
+            uint32_t newEnd = valueEnd(newBuffer, 0);
+            if(oldEnd > oldBuffer->length || newEnd > newBuffer->length){
+                return nullptr;
+            }
+            if(!diffValue(0, oldEnd, 0, newEnd)){
+                return nullptr;
+            }
+            wson_buffer* patch = wson_buffer_new();
+            wson_push_type_array(patch, opCount);
+            wson_push_bytes(patch, ops->data, ops->position);
+            return patch;
+        }
+
+    private:
+        uint32_t valueEnd(wson_buffer* buffer, uint32_t start){
+            buffer->position = start;
+            if(!skip_value(buffer)){
+                return buffer->length + 1;
+            }
+            return buffer->position;
+        }
+
+        void emit(int op, const uint8_t* value, uint32_t length){
+            wson_push_type_array(ops, value ? 3 : 2);
+            wson_push_type_int(ops, op);
+            wson_push_type_array(ops, (uint32_t)path.size());
+            for(size_t i=0; i<path.size(); i++){
+                if(path[i].key){
+                    wson_push_type_string(ops, path[i].key, path[i].keyLength);
+                }else{
+                    wson_push_type_int(ops, path[i].index);
+                }
+            }
+            if(value){
+                wson_push_bytes(ops, value, length);
+            }
+            opCount++;
+        }
+
+        bool diffValue(uint32_t oldStart, uint32_t oldEnd, uint32_t newStart, uint32_t newEnd){
+            const uint8_t* oldValue = (const uint8_t*)oldBuffer->data + oldStart;
+            const uint8_t* newValue = (const uint8_t*)newBuffer->data + newStart;
+            uint32_t newLength = newEnd - newStart;
+            if(oldEnd - oldStart == newLength && memcmp(oldValue, newValue, newLength) == 0){
+                return true;
+            }
+            uint8_t type = newValue[0];
+            if(oldValue[0] != type || (type != WSON_MAP_TYPE && type != WSON_ARRAY_TYPE)){
+                emit(WSON_PATCH_SET, newValue, newLength);
+                return true;
+            }
+            uint32_t mark = ops->position;
+            uint32_t markCount = opCount;
+            bool success = type == WSON_MAP_TYPE ? diffMap(oldStart, oldEnd, newStart, newEnd)
+                                                 : diffArray(oldStart, oldEnd, newStart, newEnd);
+            if(!success){
+                return false;
+            }
+            /** too many changes, replace whole container is smaller */
+            if(ops->position - mark >= newLength){
+                ops->position = mark;
+                opCount = markCount;
+                emit(WSON_PATCH_SET, newValue, newLength);
+            }
+            return true;
+        }
+
+        bool diffMap(uint32_t oldStart, uint32_t oldEnd, uint32_t newStart, uint32_t newEnd){
+            std::vector<value_span> oldEntries;
+            std::vector<value_span> newEntries;
+            if(!read_entries(oldBuffer, oldStart, oldEnd, oldEntries)
+               || !read_entries(newBuffer, newStart, newEnd, newEntries)){
+                return false;
+            }
+            std::vector<bool> matched(oldEntries.size(), false);
+            std::unordered_map<key_view, uint32_t, key_view_hash> lookup;
+            if(oldEntries.size() > WSON_DIFF_LINEAR_KEYS){
+                lookup.reserve(oldEntries.size());
+                for(uint32_t i=0; i<oldEntries.size(); i++){
+                    key_view key = {oldEntries[i].key, oldEntries[i].keyLength};
+                    lookup.insert(std::make_pair(key, i));
+                }
+            }
+            /**
+             * patch keeps kept keys in old order and appends added keys, when new map
+             * reorders keys or inserts before a kept key, set the whole map,
+             * so patch(old, diff(old, new)) is always byte identical to new
+             * */
+            std::vector<int64_t> found(newEntries.size(), -1);
+            int64_t lastFound = -1;
+            bool added = false;
+            for(size_t i=0; i<newEntries.size(); i++){
+                value_span& entry = newEntries[i];
+                if(oldEntries.size() > WSON_DIFF_LINEAR_KEYS){
+                    key_view key = {entry.key, entry.keyLength};
+                    auto it = lookup.find(key);
+                    if(it != lookup.end()){
+                        found[i] = it->second;
+                    }
+                }else{
+                    for(size_t j=0; j<oldEntries.size(); j++){
+                        if(oldEntries[j].keyLength == entry.keyLength
+                           && memcmp(oldEntries[j].key, entry.key, entry.keyLength) == 0){
+                            found[i] = j;
+                            break;
+                        }
+                    }
+                }
+                if(found[i] < 0){
+                    added = true;
+                }else if(added || found[i] <= lastFound){
+                    emit(WSON_PATCH_SET, (const uint8_t*)newBuffer->data + newStart, newEnd - newStart);
+                    return true;
+                }else{
+                    lastFound = found[i];
+                }
+            }
+            for(size_t i=0; i<newEntries.size(); i++){
+                value_span& entry = newEntries[i];
+                path_segment segment = {entry.key, entry.keyLength, 0};
+                path.push_back(segment);
+                if(found[i] < 0){
+                    emit(WSON_PATCH_SET, (const uint8_t*)newBuffer->data + entry.start, entry.end - entry.start);
+                }else{
+                    matched[found[i]] = true;
+                    if(!diffValue(oldEntries[found[i]].start, oldEntries[found[i]].end, entry.start, entry.end)){
+                        return false;
+                    }
+                }
+                path.pop_back();
+            }
+            for(size_t j=0; j<oldEntries.size(); j++){
+                if(!matched[j]){
+                    path_segment segment = {oldEntries[j].key, oldEntries[j].keyLength, 0};
+                    path.push_back(segment);
+                    emit(WSON_PATCH_REMOVE, nullptr, 0);
+                    path.pop_back();
+                }
+            }
+            return true;
+        }
+
+        bool diffArray(uint32_t oldStart, uint32_t oldEnd, uint32_t newStart, uint32_t newEnd){
+            std::vector<value_span> oldEntries;
+            std::vector<value_span> newEntries;
+            if(!read_entries(oldBuffer, oldStart, oldEnd, oldEntries)
+               || !read_entries(newBuffer, newStart, newEnd, newEntries)){
+                return false;
+            }
+            uint32_t oldCount = (uint32_t)oldEntries.size();
+            uint32_t newCount = (uint32_t)newEntries.size();
+            for(uint32_t i=0; i<newCount; i++){
+                path_segment segment = {nullptr, 0, i};
+                path.push_back(segment);
+                if(i < oldCount){
+                    if(!diffValue(oldEntries[i].start, oldEntries[i].end, newEntries[i].start, newEntries[i].end)){
+                        return false;
+                    }
+                }else{
+                    emit(WSON_PATCH_SET, (const uint8_t*)newBuffer->data + newEntries[i].start,
+                         newEntries[i].end - newEntries[i].start);
+                }
+                path.pop_back();
+            }
+            for(uint32_t i=oldCount; i>newCount; i--){
+                path_segment segment = {nullptr, 0, i - 1};
+                path.push_back(segment);
+                emit(WSON_PATCH_REMOVE, nullptr, 0);
+                path.pop_back();
+            }
+            return true;
+        }
+
+        wson_buffer* oldBuffer;
+        wson_buffer* newBuffer;
+        wson_buffer* ops;
+        uint32_t opCount = 0;
+        std::vector<path_segment> path;
+    };
+
+
+    struct patch_node {
+        int op = -1;
+        const uint8_t* value = nullptr;
+        uint32_t valueLength = 0;
+        std::map<std::string, std::unique_ptr<patch_node> > keys;
+        std::vector<std::string> keyOrder;
+        std::map<uint32_t, std::unique_ptr<patch_node> > indexes;
+
+        inline bool hasChildren(){
+            return !keys.empty() || !indexes.empty();
+        }
+    };
+
+    class wson_patcher {
+    public:
+        wson_patcher(const uint8_t* oldData, uint32_t oldLength){
+            oldBuffer = wson_buffer_from((void*)oldData, oldLength);
+            out = wson_buffer_new();
+        }
+
+        ~wson_patcher(){
+            oldBuffer->data = nullptr;
+            wson_buffer_free(oldBuffer);
+            if(out){
+                wson_buffer_free(out);
+            }
+        }
+
+        bool load(const uint8_t* patch, uint32_t patchLength){
+            wson_buffer* buffer = wson_buffer_from((void*)patch, patchLength);
+            bool success = parseOps(buffer);
+            buffer->data = nullptr;
+            wson_buffer_free(buffer);
+            return success;
+        }
+
+        wson_buffer* apply(){
+            oldBuffer->position = 0;
+            if(!skip_value(oldBuffer)){
+                return nullptr;
+            }
+            uint32_t end = oldBuffer->position;
+            if(!applyValue(&root, 0, end)){
+                return nullptr;
+            }
+            wson_buffer* result = out;
+            out = nullptr;
+            return result;
+        }
+
+    private:
+        bool parseOps(wson_buffer* buffer){
+            uint8_t type;
+            uint32_t count;
+            if(!next_type(buffer, type) || type != WSON_ARRAY_TYPE || !next_uint(buffer, count)){
+                return false;
+            }
+            for(uint32_t i=0; i<count; i++){
+                uint32_t fields;
+                int32_t op;
+                uint32_t segments;
+                if(!next_type(buffer, type) || type != WSON_ARRAY_TYPE
+                   || !next_uint(buffer, fields) || fields < 2
+                   || !next_type(buffer, type) || type != WSON_NUMBER_INT_TYPE
+                   || !next_int(buffer, op)
+                   || !next_type(buffer, type) || type != WSON_ARRAY_TYPE
+                   || !next_uint(buffer, segments)){
+                    return false;
+                }
+                patch_node* node = &root;
+                for(uint32_t s=0; s<segments; s++){
+                    if(!next_type(buffer, type)){
+                        return false;
+                    }
+                    if(type == WSON_STRING_TYPE){
+                        uint32_t keyLength;
+                        const uint8_t* keyBytes;
+                        if(!next_uint(buffer, keyLength) || !next_bytes(buffer, keyLength, keyBytes)){
+                            return false;
+                        }
+                        std::string key((const char*)keyBytes, keyLength);
+                        std::unique_ptr<patch_node>& child = node->keys[key];
+                        if(!child){
+                            child.reset(new patch_node());
+                            node->keyOrder.push_back(key);
+                        }
+                        node = child.get();
+                    }else if(type == WSON_NUMBER_INT_TYPE){
+                        int32_t index;
+                        if(!next_int(buffer, index) || index < 0){
+                            return false;
+                        }
+                        std::unique_ptr<patch_node>& child = node->indexes[(uint32_t)index];
+                        if(!child){
+                            child.reset(new patch_node());
+                        }
+                        node = child.get();
+                    }else{
+                        return false;
+                    }
+                }
+                if(op == WSON_PATCH_SET){
+                    uint32_t start = buffer->position;
+                    if(fields < 3 || !skip_value(buffer)){
+                        return false;
+                    }
+                    node->op = op;
+                    node->value = (const uint8_t*)buffer->data + start;
+                    node->valueLength = buffer->position - start;
+                }else if(op == WSON_PATCH_REMOVE){
+                    node->op = op;
+                }else{
+                    return false;
+                }
+                for(uint32_t f=3; f<fields; f++){
+                    if(!skip_value(buffer)){
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool applyValue(patch_node* node, uint32_t start, uint32_t end){
+            if(node->op == WSON_PATCH_SET && !node->hasChildren()){
+                wson_push_bytes(out, node->value, node->valueLength);
+                return true;
+            }
+            if(!node->hasChildren()){
+                wson_push_bytes(out, (const uint8_t*)oldBuffer->data + start, end - start);
+                return true;
+            }
+            uint8_t type = ((const uint8_t*)oldBuffer->data)[start];
+            if(type == WSON_MAP_TYPE){
+                return applyMap(node, start, end);
+            }
+            if(type == WSON_ARRAY_TYPE){
+                return applyArray(node, start, end);
+            }
+            return false;
+        }
+
+        bool applyMap(patch_node* node, uint32_t start, uint32_t end){
+            if(!node->indexes.empty()){
+                return false;
+            }
+            std::vector<value_span> entries;
+            if(!read_entries(oldBuffer, start, end, entries)){
+                return false;
+            }
+            std::vector<patch_node*> entryNodes(entries.size(), nullptr);
+            std::map<std::string, bool> matched;
+            uint32_t count = (uint32_t)entries.size();
+            for(size_t i=0; i<entries.size(); i++){
+                std::string key((const char*)entries[i].key, entries[i].keyLength);
+                auto it = node->keys.find(key);
+                if(it != node->keys.end()){
+                    entryNodes[i] = it->second.get();
+                    matched[key] = true;
+                    if(entryNodes[i]->op == WSON_PATCH_REMOVE){
+                        count--;
+                    }
+                }
+            }
+            for(size_t i=0; i<node->keyOrder.size(); i++){
+                patch_node* child = node->keys[node->keyOrder[i]].get();
+                if(matched.count(node->keyOrder[i]) == 0){
+                    if(child->op == WSON_PATCH_SET){
+                        count++;
+                    }else if(child->hasChildren()){
+                        return false;
+                    }
+                }
+            }
+            wson_push_type_map(out, count);
+            for(size_t i=0; i<entries.size(); i++){
+                patch_node* child = entryNodes[i];
+                if(child && child->op == WSON_PATCH_REMOVE){
+                    continue;
+                }
+                wson_push_property(out, entries[i].key, entries[i].keyLength);
+                if(child){
+                    if(!applyValue(child, entries[i].start, entries[i].end)){
+                        return false;
+                    }
+                }else{
+                    wson_push_bytes(out, (const uint8_t*)oldBuffer->data + entries[i].start, entries[i].end - entries[i].start);
+                }
+            }
+            for(size_t i=0; i<node->keyOrder.size(); i++){
+                const std::string& key = node->keyOrder[i];
+                patch_node* child = node->keys[key].get();
+                if(matched.count(key) == 0 && child->op == WSON_PATCH_SET){
+                    wson_push_property(out, key.data(), (int32_t)key.size());
+                    wson_push_bytes(out, child->value, child->valueLength);
+                }
+            }
+            return true;
+        }
+
+        bool applyArray(patch_node* node, uint32_t start, uint32_t end){
+            if(!node->keys.empty()){
+                return false;
+            }
+            std::vector<value_span> entries;
+            if(!read_entries(oldBuffer, start, end, entries)){
+                return false;
+            }
+            uint32_t oldCount = (uint32_t)entries.size();
+            uint32_t count = oldCount;
+            uint32_t appendIndex = oldCount;
+            for(auto it = node->indexes.begin(); it != node->indexes.end(); ++it){
+                patch_node* child = it->second.get();
+                if(it->first < oldCount){
+                    if(child->op == WSON_PATCH_REMOVE){
+                        count--;
+                    }
+                }else if(child->op == WSON_PATCH_SET){
+                    /** appended values must follow old end without gap, array can not hold holes */
+                    if(it->first != appendIndex || child->hasChildren()){
+                        return false;
+                    }
+                    appendIndex++;
+                    count++;
+                }else if(child->hasChildren()){
+                    return false;
+                }
+            }
+            wson_push_type_array(out, count);
+            auto it = node->indexes.begin();
+            for(uint32_t i=0; i<oldCount; i++){
+                while(it != node->indexes.end() && it->first < i){
+                    ++it;
+                }
+                patch_node* child = (it != node->indexes.end() && it->first == i) ? it->second.get() : nullptr;
+                if(child && child->op == WSON_PATCH_REMOVE){
+                    continue;
+                }
+                if(child){
+                    if(!applyValue(child, entries[i].start, entries[i].end)){
+                        return false;
+                    }
+                }else{
+                    wson_push_bytes(out, (const uint8_t*)oldBuffer->data + entries[i].start, entries[i].end - entries[i].start);
+                }
+            }
+            for(; it != node->indexes.end(); ++it){
+                if(it->first >= oldCount && it->second->op == WSON_PATCH_SET){
+                    wson_push_bytes(out, it->second->value, it->second->valueLength);
+                }
+            }
+            return true;
+        }
+
+        wson_buffer* oldBuffer;
+        wson_buffer* out;
+        patch_node root;
+    };
+}
+
+
+wson_buffer* wson_diff(const void* oldData, uint32_t oldLength, const void* newData, uint32_t newLength){
+    wson_differ differ((const uint8_t*)oldData, oldLength, (const uint8_t*)newData, newLength);
+    return differ.diff();
+}
+
+wson_buffer* wson_patch(const void* oldData, uint32_t oldLength, const void* patch, uint32_t patchLength){
+    wson_patcher patcher((const uint8_t*)oldData, oldLength);
+    if(!patcher.load((const uint8_t*)patch, patchLength)){
+        return nullptr;
+    }
+    return patcher.apply();
+}
@@ -0,0 +1,51 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * structural binary diff and patch between two wson documents, works on wson bytes directly without dom.
+ *
+ * patch is wson array of operations, every operation is array [op, path] or [op, path, value]
+ * op    : WSON_PATCH_SET replace or add value at path, WSON_PATCH_REMOVE remove map key or array element
+ * path  : array of segments, map key is utf-16 string, array index is int
+ *
+ * patch keeps key order of old document, new keys are appended at map end, array values
+ * can only be appended at old end. diff takes care of it, when new map reorders keys the map is set
+ * as whole, so patch(old, diff(old, new)) is byte identical to new.
+ * all input is read with bounds check, truncated or malformed data returns null.
+ * */
+
+#ifndef WSON_DIFF_H
+#define WSON_DIFF_H
+
+#include "wson.h"
+
+#define WSON_PATCH_SET     0
+#define WSON_PATCH_REMOVE  1
+
+/**
+ * return patch turn old into new, caller free with wson_buffer_free, position is patch length
+ * */
+wson_buffer* wson_diff(const void* oldData, uint32_t oldLength, const void* newData, uint32_t newLength);
+
+/**
+ * return new document, null if patch is malformed or not match old. caller free with wson_buffer_free
+ * */
+wson_buffer* wson_patch(const void* oldData, uint32_t oldLength, const void* patch, uint32_t patchLength);
+
+#endif //WSON_DIFF_H
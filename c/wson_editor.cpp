@@ -0,0 +1,314 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "wson_editor.h"
+#include "wson_util.h"
+
+#define WSON_EDITOR_MAX_DEPTH  512
+
+namespace {
+
+    /**
+     * bounded reads, edited buffer may be truncated or malformed,
+     * every read checks buffer length and returns false instead of reading past it
+     * */
+    inline bool next_type(wson_buffer* buffer, uint8_t& type){
+        if(buffer->position >= buffer->length){
+            return false;
+        }
+        type = ((const uint8_t*)buffer->data)[buffer->position++];
+        return true;
+    }
+
+    inline bool next_uint(wson_buffer* buffer, uint32_t& num){
+        num = 0;
+        for(int shift=0; shift<35; shift+=7){
+            if(buffer->position >= buffer->length){
+                return false;
+            }
+            uint8_t chunk = ((const uint8_t*)buffer->data)[buffer->position++];
+            num |= ((uint32_t)(chunk & 0x7F)) << shift;
+            if((chunk & 0x80) == 0){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool next_bytes(wson_buffer* buffer, uint32_t length, const uint8_t*& bytes){
+        if(length > buffer->length - buffer->position){
+            return false;
+        }
+        bytes = (const uint8_t*)buffer->data + buffer->position;
+        buffer->position += length;
+        return true;
+    }
+
+    inline bool skip_bytes(wson_buffer* buffer, uint32_t length){
+        const uint8_t* bytes;
+        return next_bytes(buffer, length, bytes);
+    }
+
+    bool skip_value(wson_buffer* buffer, int depth = 0){
+        uint8_t type;
+        uint32_t size;
+        if(depth > WSON_EDITOR_MAX_DEPTH || !next_type(buffer, type)){
+            return false;
+        }
+        switch (type) {
+            case WSON_STRING_TYPE:
+            case WSON_NUMBER_BIG_INT_TYPE:
+            case WSON_NUMBER_BIG_DECIMAL_TYPE:
+            case WSON_EXTEND_TYPE:
+                return next_uint(buffer, size) && skip_bytes(buffer, size);
+            case WSON_NUMBER_INT_TYPE:
+                return next_uint(buffer, size);
+            case WSON_NUMBER_FLOAT_TYPE:
+                return skip_bytes(buffer, sizeof(float));
+            case WSON_NUMBER_DOUBLE_TYPE:
+            case WSON_NUMBER_LONG_TYPE:
+                return skip_bytes(buffer, sizeof(uint64_t));
+            case WSON_NULL_TYPE:
+            case WSON_BOOLEAN_TYPE_TRUE:
+            case WSON_BOOLEAN_TYPE_FALSE:
+                return true;
+            case WSON_MAP_TYPE:
+                if(!next_uint(buffer, size)){
+                    return false;
+                }
+                for(uint32_t i=0; i<size; i++){
+                    uint32_t keyLength;
+                    if(!next_uint(buffer, keyLength) || !skip_bytes(buffer, keyLength)
+                       || !skip_value(buffer, depth + 1)){
+                        return false;
+                    }
+                }
+                return true;
+            case WSON_ARRAY_TYPE:
+                if(!next_uint(buffer, size)){
+                    return false;
+                }
+                for(uint32_t i=0; i<size; i++){
+                    if(!skip_value(buffer, depth + 1)){
+                        return false;
+                    }
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+wson_path& wson_path::key(const std::string &utf8) {
+    std::vector<uint16_t> utf16(utf8.size() + 1);
+    int length = wson::utf8_convert_to_utf16(utf8.data(), (int)utf8.size(), utf16.data());
+    return key(utf16.data(), (uint32_t)length);
+}
+
+wson_path& wson_path::key(const uint16_t *utf16, uint32_t length) {
+    wson_path_segment segment;
+    segment.key.assign((const char*)utf16, length*sizeof(uint16_t));
+    segment.index = 0;
+    segment.isIndex = false;
+    items.push_back(segment);
+    return *this;
+}
+
+wson_path& wson_path::index(uint32_t index) {
+    wson_path_segment segment;
+    segment.index = index;
+    segment.isIndex = true;
+    items.push_back(segment);
+    return *this;
+}
+
+
+wson_editor::wson_editor(wson_buffer *buffer) {
+    this->buffer = buffer;
+}
+
+/**
+ * reads are bounded by encoded length, truncated or malformed container fails before any byte past it is read
+ */
+bool wson_editor::findChild(uint32_t container, const wson_path_segment &segment, location &target) {
+    wson_buffer bounded = {buffer->data, container, buffer->position};
+    uint8_t type;
+    if(!next_type(&bounded, type)){
+        return false;
+    }
+    if((type == WSON_MAP_TYPE && segment.isIndex) || (type == WSON_ARRAY_TYPE && !segment.isIndex)
+       || (type != WSON_MAP_TYPE && type != WSON_ARRAY_TYPE)){
+        return false;
+    }
+    target.parentType = type;
+    target.countStart = bounded.position;
+    if(!next_uint(&bounded, target.count)){
+        return false;
+    }
+    target.countEnd = bounded.position;
+    target.found = false;
+    uint32_t count = target.count;
+    if(segment.isIndex && segment.index < count){
+        count = segment.index + 1;
+    }
+    for(uint32_t i=0; i<count; i++){
+        target.entryStart = bounded.position;
+        bool match = false;
+        if(type == WSON_MAP_TYPE){
+            uint32_t keyLength;
+            const uint8_t* key;
+            if(!next_uint(&bounded, keyLength) || !next_bytes(&bounded, keyLength, key)){
+                return false;
+            }
+            match = keyLength == segment.key.size() && memcmp(key, segment.key.data(), keyLength) == 0;
+        }else{
+            match = i == segment.index;
+        }
+        target.valueStart = bounded.position;
+        if(!skip_value(&bounded)){
+            return false;
+        }
+        target.valueEnd = bounded.position;
+        if(match){
+            target.found = true;
+            break;
+        }
+    }
+    if(!target.found){
+        /** container end, where new key or element is appended */
+        target.entryStart = bounded.position;
+        target.valueStart = bounded.position;
+        target.valueEnd = bounded.position;
+    }
+    return true;
+}
+
+bool wson_editor::locate(const wson_path &path, location &target) {
+    const std::vector<wson_path_segment>& segments = path.segments();
+    if(buffer->position == 0){
+        return false;
+    }
+    uint32_t container = 0;
+    for(size_t i=0; i<segments.size(); i++){
+        if(!findChild(container, segments[i], target)){
+            return false;
+        }
+        if(i + 1 < segments.size()){
+            if(!target.found){
+                return false;
+            }
+            container = target.valueStart;
+        }
+    }
+    return true;
+}
+
+void wson_editor::splice(uint32_t start, uint32_t end, const void *bytes, uint32_t length) {
+    uint32_t tail = buffer->position - end;
+    uint32_t removed = end - start;
+    if(length > removed){
+        wson_push_ensure_size(buffer, length - removed);
+    }
+    uint8_t* data = (uint8_t*)buffer->data;
+    if(length != removed && tail > 0){
+        memmove(data + start + length, data + end, tail);
+    }
+    if(length > 0){
+        memcpy(data + start, bytes, length);
+    }
+    buffer->position = start + length + tail;
+}
+
+void wson_editor::updateCount(location &target, uint32_t count) {
+    uint8_t varint[sizeof(uint32_t) + sizeof(uint8_t)];
+    uint32_t size = 0;
+    do{
+        varint[size++] = (uint8_t)((count & 0x7F) | 0x80);
+    }while((count >>= 7) != 0);
+    varint[size - 1] &= 0x7F;
+    if(size == target.countEnd - target.countStart){
+        memcpy((uint8_t*)buffer->data + target.countStart, varint, size);
+    }else{
+        splice(target.countStart, target.countEnd, varint, size);
+    }
+}
+
+void wson_editor::spliceEntry(location &target, const wson_path_segment &segment, const void *value, uint32_t length) {
+    if(target.parentType == WSON_MAP_TYPE){
+        /** key and value spliced in one move */
+        wson_buffer* entry = wson_buffer_new();
+        wson_push_property(entry, segment.key.data(), (int32_t)segment.key.size());
+        wson_push_bytes(entry, value, length);
+        splice(target.entryStart, target.entryStart, entry->data, entry->position);
+        wson_buffer_free(entry);
+    }else{
+        splice(target.entryStart, target.entryStart, value, length);
+    }
+    updateCount(target, target.count + 1);
+}
+
+bool wson_editor::set(const wson_path &path, const void *value, uint32_t length) {
+    if(path.segments().empty()){
+        buffer->position = 0;
+        wson_push_bytes(buffer, value, length);
+        return true;
+    }
+    location target;
+    if(!locate(path, target)){
+        return false;
+    }
+    if(target.found){
+        splice(target.valueStart, target.valueEnd, value, length);
+        return true;
+    }
+    const wson_path_segment& segment = path.segments().back();
+    if(segment.isIndex && segment.index != target.count){
+        return false;
+    }
+    spliceEntry(target, segment, value, length);
+    return true;
+}
+
+bool wson_editor::remove(const wson_path &path) {
+    location target;
+    if(path.segments().empty() || !locate(path, target) || !target.found){
+        return false;
+    }
+    splice(target.entryStart, target.valueEnd, nullptr, 0);
+    updateCount(target, target.count - 1);
+    return true;
+}
+
+bool wson_editor::insert(const wson_path &path, const void *value, uint32_t length) {
+    location target;
+    if(path.segments().empty() || !locate(path, target)){
+        return false;
+    }
+    const wson_path_segment& segment = path.segments().back();
+    if(segment.isIndex){
+        if(segment.index > target.count){
+            return false;
+        }
+    }else if(target.found){
+        return false;
+    }
+    spliceEntry(target, segment, value, length);
+    return true;
+}
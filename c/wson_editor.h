@@ -0,0 +1,121 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * in place splice edit on wson buffer. value is located by skipping siblings, new bytes are spliced in,
+ * only the tail after edit point is moved. wson containers only store element count, so only direct parent
+ * count is rewritten, varint grow or shrink is handled by another splice.
+ * */
+
+#ifndef WSON_EDITOR_H
+#define WSON_EDITOR_H
+
+#include "wson.h"
+
+#include <string>
+#include <vector>
+
+struct wson_path_segment {
+    /** utf-16 bytes of map key */
+    std::string key;
+    uint32_t index;
+    bool isIndex;
+};
+
+class wson_path {
+
+public:
+    /**
+     * append map key segment, key is utf-8
+     * */
+    wson_path& key(const std::string& utf8);
+
+    /**
+     * append map key segment, key is utf-16
+     * */
+    wson_path& key(const uint16_t* utf16, uint32_t length);
+
+    /**
+     * append array index segment
+     * */
+    wson_path& index(uint32_t index);
+
+    inline const std::vector<wson_path_segment>& segments() const{
+        return items;
+    }
+
+private:
+    std::vector<wson_path_segment> items;
+};
+
+class wson_editor {
+
+public:
+    /**
+     * edit document in buffer, document is buffer->data from 0 to buffer->position
+     * */
+    wson_editor(wson_buffer* buffer);
+
+    /**
+     * replace value at path, add map key or append array element if path is map end or array length.
+     * value is one encoded wson value and must not point into edited buffer.
+     * */
+    bool set(const wson_path& path, const void* value, uint32_t length);
+
+    /**
+     * remove map key or array element at path
+     * */
+    bool remove(const wson_path& path);
+
+    /**
+     * insert array element before path index, or add map key if not exist
+     * */
+    bool insert(const wson_path& path, const void* value, uint32_t length);
+
+    inline bool set(const wson_path& path, wson_buffer* value){
+        return set(path, value->data, value->position);
+    }
+
+    inline bool insert(const wson_path& path, wson_buffer* value){
+        return insert(path, value->data, value->position);
+    }
+
+private:
+    struct location {
+        uint8_t parentType;
+        uint32_t countStart;
+        uint32_t countEnd;
+        uint32_t count;
+        /** entry start, include key for map */
+        uint32_t entryStart;
+        uint32_t valueStart;
+        uint32_t valueEnd;
+        bool found;
+    };
+
+    bool locate(const wson_path& path, location& target);
+    bool findChild(uint32_t container, const wson_path_segment& segment, location& target);
+    void splice(uint32_t start, uint32_t end, const void* bytes, uint32_t length);
+    void spliceEntry(location& target, const wson_path_segment& segment, const void* value, uint32_t length);
+    void updateCount(location& target, uint32_t count);
+
+    wson_buffer* buffer;
+};
+
+#endif //WSON_EDITOR_H
@@ -0,0 +1,610 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "wson_hash.h"
+
+#include <unordered_map>
+#include <vector>
+
+/**
+ * map with more entries use hash lookup when key order differ, less use linear scan
+ * */
+#define WSON_EQUAL_LINEAR_KEYS  16
+
+/**
+ * nested containers deeper than this are treated as malformed
+ * */
+#define WSON_HASH_MAX_DEPTH  512
+
+namespace {
+
+    const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+    /**
+     * value class absorbed before payload, number types share one class
+     * */
+    enum value_class {
+        CLASS_NULL = 1,
+        CLASS_TRUE,
+        CLASS_FALSE,
+        CLASS_INTEGER,
+        CLASS_DOUBLE,
+        CLASS_STRING,
+        CLASS_BIG_INT,
+        CLASS_BIG_DECIMAL,
+        CLASS_BYTES,
+        CLASS_ARRAY,
+        CLASS_MAP,
+        CLASS_UNKNOWN
+    };
+
+    struct hash_state {
+        uint64_t low;
+        uint64_t high;
+    };
+
+    inline uint64_t rotl(uint64_t value, int bits){
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline uint64_t fmix(uint64_t value){
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDULL;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    inline void init(hash_state& state){
+        state.low = PRIME1 + PRIME2;
+        state.high = PRIME3 ^ PRIME4;
+    }
+
+    inline void absorb(hash_state& state, uint64_t value){
+        state.low = rotl(state.low ^ (value*PRIME2), 31)*PRIME1;
+        state.high = rotl(state.high + (value*PRIME4), 27)*PRIME3 + PRIME5;
+    }
+
+    inline void absorb_bytes(hash_state& state, const uint8_t* data, uint32_t length){
+        absorb(state, length);
+        while(length >= sizeof(uint64_t)){
+            uint64_t word;
+            memcpy(&word, data, sizeof(uint64_t));
+            absorb(state, word);
+            data += sizeof(uint64_t);
+            length -= sizeof(uint64_t);
+        }
+        if(length > 0){
+            uint64_t word = 0;
+            memcpy(&word, data, length);
+            absorb(state, word);
+        }
+    }
+
+    inline wson_hash128_t finish(const hash_state& state){
+        wson_hash128_t hash;
+        hash.low = fmix(state.low + rotl(state.high, 17));
+        hash.high = fmix(state.high ^ hash.low);
+        return hash;
+    }
+
+    inline uint32_t remaining(wson_buffer* buffer){
+        return buffer->position < buffer->length ? buffer->length - buffer->position : 0;
+    }
+
+    /**
+     * bounded reads, input may be truncated or malformed,
+     * every read checks buffer length and returns false instead of reading past it
+     * */
+    inline bool next_type(wson_buffer* buffer, uint8_t& type){
+        if(buffer->position >= buffer->length){
+            return false;
+        }
+        type = ((const uint8_t*)buffer->data)[buffer->position++];
+        return true;
+    }
+
+    inline bool next_uint(wson_buffer* buffer, uint32_t& num){
+        num = 0;
+        for(int shift=0; shift<35; shift+=7){
+            if(buffer->position >= buffer->length){
+                return false;
+            }
+            uint8_t chunk = ((const uint8_t*)buffer->data)[buffer->position++];
+            num |= ((uint32_t)(chunk & 0x7F)) << shift;
+            if((chunk & 0x80) == 0){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool next_int(wson_buffer* buffer, int32_t& num){
+        uint32_t raw;
+        if(!next_uint(buffer, raw)){
+            return false;
+        }
+        num = (int32_t)((raw >> 1) ^ -(raw & 1));
+        return true;
+    }
+
+    inline bool next_bytes(wson_buffer* buffer, uint32_t length, const uint8_t*& bytes){
+        if(length > buffer->length - buffer->position){
+            return false;
+        }
+        bytes = (const uint8_t*)buffer->data + buffer->position;
+        buffer->position += length;
+        return true;
+    }
+
+    inline bool skip_bytes(wson_buffer* buffer, uint32_t length){
+        const uint8_t* bytes;
+        return next_bytes(buffer, length, bytes);
+    }
+
+    bool skip_value(wson_buffer* buffer, int depth){
+        uint8_t type;
+        uint32_t size;
+        if(depth > WSON_HASH_MAX_DEPTH || !next_type(buffer, type)){
+            return false;
+        }
+        switch (type) {
+            case WSON_STRING_TYPE:
+            case WSON_NUMBER_BIG_INT_TYPE:
+            case WSON_NUMBER_BIG_DECIMAL_TYPE:
+            case WSON_EXTEND_TYPE:
+                return next_uint(buffer, size) && skip_bytes(buffer, size);
+            case WSON_NUMBER_INT_TYPE:
+                return next_uint(buffer, size);
+            case WSON_NUMBER_FLOAT_TYPE:
+                return skip_bytes(buffer, sizeof(float));
+            case WSON_NUMBER_DOUBLE_TYPE:
+            case WSON_NUMBER_LONG_TYPE:
+                return skip_bytes(buffer, sizeof(uint64_t));
+            case WSON_NULL_TYPE:
+            case WSON_BOOLEAN_TYPE_TRUE:
+            case WSON_BOOLEAN_TYPE_FALSE:
+                return true;
+            case WSON_MAP_TYPE:
+                if(!next_uint(buffer, size)){
+                    return false;
+                }
+                for(uint32_t i=0; i<size; i++){
+                    uint32_t keyLength;
+                    if(!next_uint(buffer, keyLength) || !skip_bytes(buffer, keyLength)
+                       || !skip_value(buffer, depth + 1)){
+                        return false;
+                    }
+                }
+                return true;
+            case WSON_ARRAY_TYPE:
+                if(!next_uint(buffer, size)){
+                    return false;
+                }
+                for(uint32_t i=0; i<size; i++){
+                    if(!skip_value(buffer, depth + 1)){
+                        return false;
+                    }
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    inline bool is_number(uint8_t type){
+        return type == WSON_NUMBER_INT_TYPE || type == WSON_NUMBER_LONG_TYPE
+               || type == WSON_NUMBER_DOUBLE_TYPE || type == WSON_NUMBER_FLOAT_TYPE;
+    }
+
+    /**
+     * integral number is int64, other is double bits, nan is one bits
+     * */
+    struct number_value {
+        bool integer;
+        int64_t value;
+        uint64_t bits;
+
+        bool operator==(const number_value& other) const{
+            return integer == other.integer && (integer ? value == other.value : bits == other.bits);
+        }
+    };
+
+    bool read_number(wson_buffer* buffer, uint8_t type, number_value& number){
+        number.integer = true;
+        number.bits = 0;
+        double num = 0;
+        switch (type) {
+            case WSON_NUMBER_INT_TYPE:{
+                    int32_t value;
+                    if(!next_int(buffer, value)){
+                        return false;
+                    }
+                    number.value = value;
+                }
+                return true;
+            case WSON_NUMBER_LONG_TYPE:
+                if(remaining(buffer) < sizeof(int64_t)){
+                    return false;
+                }
+                number.value = wson_next_long(buffer);
+                return true;
+            case WSON_NUMBER_FLOAT_TYPE:
+                if(remaining(buffer) < sizeof(float)){
+                    return false;
+                }
+                num = wson_next_float(buffer);
+                break;
+            default:
+                if(remaining(buffer) < sizeof(double)){
+                    return false;
+                }
+                num = wson_next_double(buffer);
+                break;
+        }
+        if(num >= -9223372036854775808.0 && num < 9223372036854775808.0 && num == (double)(int64_t)num){
+            number.value = (int64_t)num;
+            return true;
+        }
+        number.integer = false;
+        number.value = 0;
+        if(num != num){
+            number.bits = 0x7FF8000000000000ULL;
+        }else{
+            memcpy(&number.bits, &num, sizeof(double));
+        }
+        return true;
+    }
+
+    int class_of(uint8_t type){
+        switch (type) {
+            case WSON_NULL_TYPE:
+                return CLASS_NULL;
+            case WSON_BOOLEAN_TYPE_TRUE:
+                return CLASS_TRUE;
+            case WSON_BOOLEAN_TYPE_FALSE:
+                return CLASS_FALSE;
+            case WSON_STRING_TYPE:
+                return CLASS_STRING;
+            case WSON_NUMBER_BIG_INT_TYPE:
+                return CLASS_BIG_INT;
+            case WSON_NUMBER_BIG_DECIMAL_TYPE:
+                return CLASS_BIG_DECIMAL;
+            case WSON_EXTEND_TYPE:
+                return CLASS_BYTES;
+            case WSON_ARRAY_TYPE:
+                return CLASS_ARRAY;
+            case WSON_MAP_TYPE:
+                return CLASS_MAP;
+            default:
+                return CLASS_UNKNOWN;
+        }
+    }
+
+    /**
+     * read length prefixed bytes, null if truncated
+     * */
+    inline const uint8_t* next_length_bytes(wson_buffer* buffer, uint32_t& length){
+        const uint8_t* bytes;
+        if(!next_uint(buffer, length) || !next_bytes(buffer, length, bytes)){
+            buffer->position = buffer->length;
+            return nullptr;
+        }
+        return bytes;
+    }
+
+    /**
+     * absorb one value into state, return false if data is truncated
+     * */
+    bool hash_value(wson_buffer* buffer, hash_state& state, int flags, int depth){
+        uint8_t type;
+        if(depth > WSON_HASH_MAX_DEPTH || !next_type(buffer, type)){
+            return false;
+        }
+        if(is_number(type)){
+            number_value number;
+            if(!read_number(buffer, type, number)){
+                return false;
+            }
+            absorb(state, number.integer ? CLASS_INTEGER : CLASS_DOUBLE);
+            absorb(state, number.integer ? (uint64_t)number.value : number.bits);
+            return true;
+        }
+        int valueClass = class_of(type);
+        absorb(state, valueClass);
+        switch (type) {
+            case WSON_STRING_TYPE:
+            case WSON_NUMBER_BIG_INT_TYPE:
+            case WSON_NUMBER_BIG_DECIMAL_TYPE:
+            case WSON_EXTEND_TYPE:{
+                    uint32_t length;
+                    const uint8_t* bytes = next_length_bytes(buffer, length);
+                    if(!bytes){
+                        return false;
+                    }
+                    absorb_bytes(state, bytes, length);
+                }
+                return true;
+            case WSON_ARRAY_TYPE:{
+                    uint32_t count;
+                    if(!next_uint(buffer, count) || count > remaining(buffer)){
+                        return false;
+                    }
+                    absorb(state, count);
+                    for(uint32_t i=0; i<count; i++){
+                        if(!hash_value(buffer, state, flags, depth + 1)){
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            case WSON_MAP_TYPE:{
+                    uint32_t count;
+                    if(!next_uint(buffer, count) || count > remaining(buffer)){
+                        return false;
+                    }
+                    absorb(state, count);
+                    bool ordered = (flags & WSON_HASH_IGNORE_MAP_ORDER) == 0;
+                    uint64_t sumLow = 0;
+                    uint64_t sumHigh = 0;
+                    for(uint32_t i=0; i<count; i++){
+                        uint32_t keyLength;
+                        const uint8_t* key = next_length_bytes(buffer, keyLength);
+                        if(!key){
+                            return false;
+                        }
+                        if(ordered){
+                            absorb_bytes(state, key, keyLength);
+                            if(!hash_value(buffer, state, flags, depth + 1)){
+                                return false;
+                            }
+                            continue;
+                        }
+                        /** entry hashed alone, then summed, sum is order independent */
+                        hash_state entry;
+                        init(entry);
+                        absorb_bytes(entry, key, keyLength);
+                        if(!hash_value(buffer, entry, flags, depth + 1)){
+                            return false;
+                        }
+                        wson_hash128_t entryHash = finish(entry);
+                        sumLow += entryHash.low;
+                        sumHigh += entryHash.high;
+                    }
+                    if(!ordered){
+                        absorb(state, sumLow);
+                        absorb(state, sumHigh);
+                    }
+                }
+                return true;
+            default:
+                return type == WSON_NULL_TYPE || type == WSON_BOOLEAN_TYPE_TRUE
+                       || type == WSON_BOOLEAN_TYPE_FALSE;
+        }
+    }
+
+    struct entry_span {
+        const uint8_t* key;
+        uint32_t keyLength;
+        uint32_t start;
+        bool matched;
+    };
+
+    struct key_view {
+        const uint8_t* data;
+        uint32_t length;
+        bool operator==(const key_view& other) const{
+            return length == other.length && memcmp(data, other.data, length) == 0;
+        }
+    };
+
+    struct key_view_hash {
+        size_t operator()(const key_view& key) const{
+            return (size_t)wson_hash_bytes(key.data, key.length);
+        }
+    };
+
+    bool equal_value(wson_buffer* a, wson_buffer* b, int flags, int depth);
+
+    /**
+     * read rest entries of map, value start is recorded, value is skipped
+     * */
+    bool read_entries(wson_buffer* buffer, uint32_t count, std::vector<entry_span>& entries, int depth){
+        if(count > remaining(buffer)){
+            return false;
+        }
+        entries.resize(count);
+        for(uint32_t i=0; i<count; i++){
+            entry_span& entry = entries[i];
+            entry.key = next_length_bytes(buffer, entry.keyLength);
+            if(!entry.key){
+                return false;
+            }
+            entry.start = buffer->position;
+            entry.matched = false;
+            if(!skip_value(buffer, depth)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * entries from first different key compared by key lookup
+     * */
+    bool equal_map_unordered(wson_buffer* a, wson_buffer* b, uint32_t count, int flags, int depth){
+        std::vector<entry_span> entriesA;
+        std::vector<entry_span> entriesB;
+        if(!read_entries(a, count, entriesA, depth) || !read_entries(b, count, entriesB, depth)){
+            return false;
+        }
+        uint32_t endA = a->position;
+        uint32_t endB = b->position;
+        std::unordered_map<key_view, uint32_t, key_view_hash> index;
+        if(count > WSON_EQUAL_LINEAR_KEYS){
+            index.reserve(count);
+            for(uint32_t i=0; i<count; i++){
+                key_view key = {entriesB[i].key, entriesB[i].keyLength};
+                index.insert(std::make_pair(key, i));
+            }
+        }
+        for(uint32_t i=0; i<count; i++){
+            const entry_span& entryA = entriesA[i];
+            entry_span* entryB = nullptr;
+            if(count > WSON_EQUAL_LINEAR_KEYS){
+                key_view key = {entryA.key, entryA.keyLength};
+                auto it = index.find(key);
+                if(it != index.end()){
+                    entryB = &entriesB[it->second];
+                }
+            }else{
+                for(uint32_t j=0; j<count; j++){
+                    if(entriesB[j].keyLength == entryA.keyLength
+                       && memcmp(entriesB[j].key, entryA.key, entryA.keyLength) == 0){
+                        entryB = &entriesB[j];
+                        break;
+                    }
+                }
+            }
+            if(!entryB || entryB->matched){
+                return false;
+            }
+            entryB->matched = true;
+            a->position = entryA.start;
+            b->position = entryB->start;
+            if(!equal_value(a, b, flags, depth)){
+                return false;
+            }
+        }
+        a->position = endA;
+        b->position = endB;
+        return true;
+    }
+
+    bool equal_value(wson_buffer* a, wson_buffer* b, int flags, int depth){
+        uint8_t typeA;
+        uint8_t typeB;
+        if(depth > WSON_HASH_MAX_DEPTH || !next_type(a, typeA) || !next_type(b, typeB)){
+            return false;
+        }
+        if(is_number(typeA) && is_number(typeB)){
+            number_value numberA;
+            number_value numberB;
+            return read_number(a, typeA, numberA) && read_number(b, typeB, numberB) && numberA == numberB;
+        }
+        if(typeA != typeB){
+            return false;
+        }
+        switch (typeA) {
+            case WSON_STRING_TYPE:
+            case WSON_NUMBER_BIG_INT_TYPE:
+            case WSON_NUMBER_BIG_DECIMAL_TYPE:
+            case WSON_EXTEND_TYPE:{
+                    uint32_t lengthA;
+                    uint32_t lengthB;
+                    const uint8_t* bytesA = next_length_bytes(a, lengthA);
+                    const uint8_t* bytesB = next_length_bytes(b, lengthB);
+                    return bytesA && bytesB && lengthA == lengthB && memcmp(bytesA, bytesB, lengthA) == 0;
+                }
+            case WSON_ARRAY_TYPE:{
+                    uint32_t count;
+                    uint32_t countB;
+                    if(!next_uint(a, count) || !next_uint(b, countB) || count != countB){
+                        return false;
+                    }
+                    for(uint32_t i=0; i<count; i++){
+                        if(!equal_value(a, b, flags, depth + 1)){
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            case WSON_MAP_TYPE:{
+                    uint32_t count;
+                    uint32_t countB;
+                    if(!next_uint(a, count) || !next_uint(b, countB) || count != countB){
+                        return false;
+                    }
+                    bool ordered = (flags & WSON_HASH_IGNORE_MAP_ORDER) == 0;
+                    for(uint32_t i=0; i<count; i++){
+                        uint32_t entryA = a->position;
+                        uint32_t entryB = b->position;
+                        uint32_t keyLengthA;
+                        uint32_t keyLengthB;
+                        const uint8_t* keyA = next_length_bytes(a, keyLengthA);
+                        const uint8_t* keyB = next_length_bytes(b, keyLengthB);
+                        if(!keyA || !keyB){
+                            return false;
+                        }
+                        if(keyLengthA != keyLengthB || memcmp(keyA, keyB, keyLengthA) != 0){
+                            if(ordered){
+                                return false;
+                            }
+                            a->position = entryA;
+                            b->position = entryB;
+                            return equal_map_unordered(a, b, count - i, flags, depth + 1);
+                        }
+                        if(!equal_value(a, b, flags, depth + 1)){
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            default:
+                return typeA == WSON_NULL_TYPE || typeA == WSON_BOOLEAN_TYPE_TRUE
+                       || typeA == WSON_BOOLEAN_TYPE_FALSE;
+        }
+    }
+}
+
+wson_hash128_t wson_hash128(const void *data, uint32_t length, int flags) {
+    wson_buffer buffer = {(void*)data, 0, length};
+    hash_state state;
+    init(state);
+    if(!hash_value(&buffer, state, flags, 0)){
+        /** truncated data hash differ from any complete value */
+        absorb(state, CLASS_UNKNOWN);
+    }
+    return finish(state);
+}
+
+uint64_t wson_hash64(const void *data, uint32_t length, int flags) {
+    return wson_hash128(data, length, flags).low;
+}
+
+uint64_t wson_hash_bytes(const void *data, uint32_t length) {
+    hash_state state;
+    init(state);
+    absorb_bytes(state, (const uint8_t*)data, length);
+    return finish(state).low;
+}
+
+bool wson_equal(const void *a, uint32_t aLength, const void *b, uint32_t bLength, int flags) {
+    if(aLength == bLength && memcmp(a, b, aLength) == 0){
+        return aLength > 0;
+    }
+    wson_buffer bufferA = {(void*)a, 0, aLength};
+    wson_buffer bufferB = {(void*)b, 0, bLength};
+    return equal_value(&bufferA, &bufferB, flags, 0);
+}
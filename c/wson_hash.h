@@ -0,0 +1,59 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * canonical content hash and semantic equal over wson bytes, no decode.
+ * number is compared by value, int 1, long 1 and double 1.0 are same, padded varint is same as short one.
+ * with WSON_HASH_IGNORE_MAP_ORDER map entries are combined order independent.
+ * */
+
+#ifndef WSON_HASH_H
+#define WSON_HASH_H
+
+#include "wson.h"
+
+#define WSON_HASH_ORDERED            0
+#define WSON_HASH_IGNORE_MAP_ORDER   1
+
+struct wson_hash128_t {
+    uint64_t low;
+    uint64_t high;
+};
+
+/**
+ * 64 bit content hash of first value in data
+ * */
+uint64_t wson_hash64(const void* data, uint32_t length, int flags = WSON_HASH_IGNORE_MAP_ORDER);
+
+/**
+ * 128 bit content hash of first value in data
+ * */
+wson_hash128_t wson_hash128(const void* data, uint32_t length, int flags = WSON_HASH_IGNORE_MAP_ORDER);
+
+/**
+ * raw bytes hash, same mixing as content hash, for cache key of exact payload
+ * */
+uint64_t wson_hash_bytes(const void* data, uint32_t length);
+
+/**
+ * semantic equal of first value in a and b, return at first difference
+ * */
+bool wson_equal(const void* a, uint32_t aLength, const void* b, uint32_t bLength, int flags = WSON_HASH_IGNORE_MAP_ORDER);
+
+#endif //WSON_HASH_H
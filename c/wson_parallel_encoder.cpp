@@ -0,0 +1,157 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "wson_parallel_encoder.h"
+#include <condition_variable>
+#include <mutex>
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+wson_parallel_encoder::wson_parallel_encoder(wson_thread_pool *pool, uint32_t chunkCount) {
+    this->pool = pool;
+    this->chunkCount = chunkCount > 0 ? chunkCount : WSON_PARALLEL_DEFAULT_CHUNK_COUNT;
+}
+
+wson_parallel_encoder::~wson_parallel_encoder() {
+    for(size_t i=0; i<chunks.size(); i++){
+        wson_buffer_free(chunks[i]);
+    }
+    chunks.clear();
+}
+
+void wson_parallel_encoder::encodeChunks(uint32_t count, wson_element_encoder &encoder) {
+    size_t chunkNumber = (count + chunkCount - 1)/chunkCount;
+    while(chunks.size() < chunkNumber){
+        chunks.push_back(wson_buffer_new());
+    }
+    /** wait own chunks only, pool may be shared with other work */
+    std::mutex lock;
+    std::condition_variable condition;
+    size_t remain = chunkNumber;
+    for(size_t i=0; i<chunkNumber; i++){
+        wson_buffer* chunk = chunks[i];
+        chunk->position = 0;
+        uint32_t start = (uint32_t)(i*chunkCount);
+        uint32_t end = count - start > chunkCount ? start + chunkCount : count;
+        pool->submit([chunk, start, end, &encoder, &lock, &condition, &remain]{
+            for(uint32_t index=start; index<end; index++){
+                encoder(chunk, index);
+            }
+            std::unique_lock<std::mutex> guard(lock);
+            remain--;
+            condition.notify_all();
+        });
+    }
+    /** help with queued tasks while waiting, so a caller running on pool worker never starves own chunks */
+    for(;;){
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            if(remain == 0){
+                return;
+            }
+        }
+        if(!pool->runOne()){
+            std::unique_lock<std::mutex> guard(lock);
+            condition.wait(guard, [&remain]{ return remain == 0; });
+            return;
+        }
+    }
+}
+
+void wson_parallel_encoder::pushContainer(wson_buffer *buffer, uint8_t type, uint32_t count, wson_element_encoder &encoder) {
+    encodeChunks(count, encoder);
+    size_t chunkNumber = (count + chunkCount - 1)/chunkCount;
+    uint32_t total = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t);
+    for(size_t i=0; i<chunkNumber; i++){
+        total += chunks[i]->position;
+    }
+    wson_push_ensure_size(buffer, total);
+    wson_push_type(buffer, type);
+    wson_push_uint(buffer, count);
+    for(size_t i=0; i<chunkNumber; i++){
+        memcpy((uint8_t*)buffer->data + buffer->position, chunks[i]->data, chunks[i]->position);
+        buffer->position += chunks[i]->position;
+    }
+}
+
+int64_t wson_parallel_encoder::writeContainer(int fd, uint8_t type, uint32_t count, wson_element_encoder &encoder) {
+    encodeChunks(count, encoder);
+    size_t chunkNumber = (count + chunkCount - 1)/chunkCount;
+
+    uint8_t header[sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t)];
+    int headerSize = 0;
+    header[headerSize++] = type;
+    uint32_t num = count;
+    do{
+        header[headerSize++] = (uint8_t)((num & 0x7F) | 0x80);
+    }while((num >>= 7) != 0);
+    header[headerSize - 1] &= 0x7F;
+
+    std::vector<struct iovec> vectors(chunkNumber + 1);
+    vectors[0].iov_base = header;
+    vectors[0].iov_len = headerSize;
+    for(size_t i=0; i<chunkNumber; i++){
+        vectors[i + 1].iov_base = chunks[i]->data;
+        vectors[i + 1].iov_len = chunks[i]->position;
+    }
+    int64_t written = 0;
+    size_t index = 0;
+    while(index < vectors.size()){
+        int size = (int)(vectors.size() - index > IOV_MAX ? IOV_MAX : vectors.size() - index);
+        ssize_t result = writev(fd, &vectors[index], size);
+        if(result < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return -1;
+        }
+        written += result;
+        /** partial write, skip finished vectors and advance into current one */
+        while(index < vectors.size() && (size_t)result >= vectors[index].iov_len){
+            result -= vectors[index].iov_len;
+            index++;
+        }
+        if(result > 0){
+            vectors[index].iov_base = (uint8_t*)vectors[index].iov_base + result;
+            vectors[index].iov_len -= result;
+        }
+    }
+    return written;
+}
+
+void wson_parallel_encoder::pushArray(wson_buffer *buffer, uint32_t count, wson_element_encoder encoder) {
+    pushContainer(buffer, WSON_ARRAY_TYPE, count, encoder);
+}
+
+void wson_parallel_encoder::pushMap(wson_buffer *buffer, uint32_t size, wson_element_encoder encoder) {
+    pushContainer(buffer, WSON_MAP_TYPE, size, encoder);
+}
+
+int64_t wson_parallel_encoder::writeArray(int fd, uint32_t count, wson_element_encoder encoder) {
+    return writeContainer(fd, WSON_ARRAY_TYPE, count, encoder);
+}
+
+int64_t wson_parallel_encoder::writeMap(int fd, uint32_t size, wson_element_encoder encoder) {
+    return writeContainer(fd, WSON_MAP_TYPE, size, encoder);
+}
@@ -0,0 +1,82 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * parallel encode for very big array and map. elements are encoded in chunks on worker threads into
+ * separate buffers, then stitched under one container header. container header only contains element count,
+ * so output is byte identical with sequential encode as long as element encoder is deterministic.
+ * */
+
+#ifndef WSON_PARALLEL_ENCODER_H
+#define WSON_PARALLEL_ENCODER_H
+
+#include "wson.h"
+#include "wson_thread_pool.h"
+
+#include <functional>
+#include <vector>
+
+#define WSON_PARALLEL_DEFAULT_CHUNK_COUNT  4096
+
+/**
+ * push element index to buffer, for map push key with wson_push_property then value
+ * */
+typedef std::function<void(wson_buffer* buffer, uint32_t index)> wson_element_encoder;
+
+class wson_parallel_encoder {
+
+public:
+    /**
+     * chunkCount is element count encoded by one task
+     * */
+    wson_parallel_encoder(wson_thread_pool* pool, uint32_t chunkCount = WSON_PARALLEL_DEFAULT_CHUNK_COUNT);
+    ~wson_parallel_encoder();
+
+    /**
+     * encode array of count elements, header and chunks are copied into buffer once
+     * */
+    void pushArray(wson_buffer* buffer, uint32_t count, wson_element_encoder encoder);
+
+    /**
+     * encode map of size entries, header and chunks are copied into buffer once
+     * */
+    void pushMap(wson_buffer* buffer, uint32_t size, wson_element_encoder encoder);
+
+    /**
+     * encode array and write it to fd with gather io, no stitch copy. return bytes written, -1 on error
+     * */
+    int64_t writeArray(int fd, uint32_t count, wson_element_encoder encoder);
+
+    /**
+     * encode map and write it to fd with gather io, no stitch copy. return bytes written, -1 on error
+     * */
+    int64_t writeMap(int fd, uint32_t size, wson_element_encoder encoder);
+
+private:
+    void encodeChunks(uint32_t count, wson_element_encoder& encoder);
+    void pushContainer(wson_buffer* buffer, uint8_t type, uint32_t count, wson_element_encoder& encoder);
+    int64_t writeContainer(int fd, uint8_t type, uint32_t count, wson_element_encoder& encoder);
+
+    wson_thread_pool* pool;
+    uint32_t chunkCount;
+    /** chunk buffers are reused between calls */
+    std::vector<wson_buffer*> chunks;
+};
+
+#endif //WSON_PARALLEL_ENCODER_H
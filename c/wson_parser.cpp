@@ -23,6 +23,7 @@
 #include "wson_parser.h"
 #include "wson.h"
 #include "wson_util.h"
+#include "wson_stats.h"
 
 wson_parser::wson_parser(const char *data) {
 
@@ -63,6 +64,8 @@ char* wson_parser::requireDecodingBuffer(int length){
         }
         decodingBuffer = new char[length];
         decodingBufferSize = length;
+        WSON_STATS_ADD(decodingBufferGrows, 1);
+        WSON_STATS_ADD(decodingBufferGrowBytes, length);
     }else{
         return decodingBuffer;
     }
@@ -81,6 +84,13 @@ void wson_parser::toJSONtring(std::string &builder){
                 wson::utf16_convert_to_utf8_quote_string(utf16, size / sizeof(uint16_t),  requireDecodingBuffer(size*2), builder);
             }
             return;
+        case WSON_EXTEND_TYPE: {
+                uint32_t size = wson_next_uint(wsonBuffer);
+                builder.append("\"");
+                wson::str_append_base64(builder, wson_next_bts(wsonBuffer, size), size);
+                builder.append("\"");
+            }
+            return;
         case WSON_NULL_TYPE:
             builder.append("\"\"");
             break;
@@ -154,6 +164,11 @@ std::string wson_parser::nextStringUTF8(uint8_t type) {
             wson::utf16_convert_to_utf8_string(utf16, size / sizeof(uint16_t), requireDecodingBuffer(size*2), str);
             return str;
         }
+        case WSON_EXTEND_TYPE: {
+            uint32_t size = wson_next_uint(wsonBuffer);
+            wson::str_append_base64(str, wson_next_bts(wsonBuffer, size), size);
+            return str;
+        }
         case WSON_NULL_TYPE:
             str.append("");
             break;
@@ -248,11 +263,22 @@ bool wson_parser::nextBool(uint8_t type) {
     return true;
 }
 
+const uint8_t* wson_parser::nextBytes(uint8_t type, uint32_t &length) {
+    if(type != WSON_EXTEND_TYPE){
+        skipValue(type);
+        length = 0;
+        return nullptr;
+    }
+    length = wson_next_uint(wsonBuffer);
+    return wson_next_bts(wsonBuffer, length);
+}
+
 void wson_parser::skipValue(uint8_t type) {
     switch (type) {
         case WSON_STRING_TYPE:
         case WSON_NUMBER_BIG_INT_TYPE:
-        case WSON_NUMBER_BIG_DECIMAL_TYPE: {
+        case WSON_NUMBER_BIG_DECIMAL_TYPE:
+        case WSON_EXTEND_TYPE: {
             int size = wson_next_uint(wsonBuffer);
             wson_next_bts(wsonBuffer, size);
             return;
@@ -108,6 +108,13 @@ public:
                || type == WSON_NUMBER_DOUBLE_TYPE;
     }
 
+    /**
+     * return is binary bytes
+     * */
+    inline bool isBinary(uint8_t type){
+        return type == WSON_EXTEND_TYPE;
+    }
+
     /**
      * return is null object
      * */
@@ -147,6 +154,12 @@ public:
     /** return bool value */
     bool  nextBool(uint8_t type);
 
+    /**
+     * return binary bytes in place without copy, valid while parse data is alive.
+     * other type is skipped and return null with length 0
+     * */
+    const uint8_t* nextBytes(uint8_t type, uint32_t& length);
+
     /**
      * skip current value type
      * */
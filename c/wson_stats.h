@@ -0,0 +1,79 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * encode and decode counters, compiled in only with -DWSON_STATS, otherwise every macro is empty
+ * and snapshot is all zero. counters are global and updated with relaxed atomic add.
+ * value bytes include type tag and own header, container bytes not include children,
+ * map key bytes is counted in propertyBytes.
+ * */
+
+#ifndef WSON_STATS_H
+#define WSON_STATS_H
+
+#include "wson.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WSON_STATS_VARINT_SIZES 6
+
+typedef struct wson_stats{
+    uint64_t encodeValues[256];
+    uint64_t encodeBytes[256];
+    uint64_t decodeValues[256];
+    uint64_t decodeBytes[256];
+    uint64_t encodePropertyBytes;
+    /** varint count by encoded byte length 1 to 5 */
+    uint64_t encodeVarints[WSON_STATS_VARINT_SIZES];
+    uint64_t decodeVarints[WSON_STATS_VARINT_SIZES];
+    /** msg_buffer_resize calls, and bytes in use at resize which realloc copies */
+    uint64_t bufferResizes;
+    uint64_t bufferResizeBytes;
+    /** wson_parser decoding buffer regrowth and new size */
+    uint64_t decodingBufferGrows;
+    uint64_t decodingBufferGrowBytes;
+    /** jsc bridge identifier cache */
+    uint64_t identifierCacheHits;
+    uint64_t identifierCacheMisses;
+} wson_stats;
+
+/**
+ * copy current counters, all zero if not compiled with WSON_STATS
+ * */
+void wson_stats_snapshot(wson_stats* stats);
+
+void wson_stats_reset(void);
+
+bool wson_stats_enabled(void);
+
+#ifdef WSON_STATS
+extern wson_stats wson_stats_counters;
+#define WSON_STATS_ADD(field, value) \
+    __atomic_fetch_add(&wson_stats_counters.field, (uint64_t)(value), __ATOMIC_RELAXED)
+#else
+#define WSON_STATS_ADD(field, value)  ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //WSON_STATS_H
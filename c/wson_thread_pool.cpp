@@ -0,0 +1,161 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "wson_thread_pool.h"
+
+/** worker identity, so nested submit stays on local queue */
+static thread_local wson_thread_pool* currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+wson_thread_pool::wson_thread_pool(int threadCount) : nextQueue(0), queued(0), pending(0), waiting(0) {
+    if(threadCount <= 0){
+        threadCount = (int)std::thread::hardware_concurrency();
+        if(threadCount <= 0){
+            threadCount = 1;
+        }
+    }
+    for(int i=0; i<threadCount; i++){
+        queues.emplace_back(new task_queue());
+    }
+    for(int i=0; i<threadCount; i++){
+        workers.emplace_back(&wson_thread_pool::run, this, i);
+    }
+}
+
+wson_thread_pool::~wson_thread_pool() {
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        stopped = true;
+    }
+    taskCondition.notify_all();
+    for(size_t i=0; i<workers.size(); i++){
+        workers[i].join();
+    }
+}
+
+void wson_thread_pool::submit(std::function<void()> task) {
+    int index;
+    if(currentPool == this){
+        index = currentWorker;
+    }else{
+        index = (int)(nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size());
+    }
+    pending.fetch_add(1);
+    {
+        task_queue& queue = *queues[index];
+        std::unique_lock<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    {
+        /** pair with worker sleep check, avoid lost wakeup */
+        std::unique_lock<std::mutex> guard(lock);
+    }
+    taskCondition.notify_one();
+    if(waiting.load() > 0){
+        doneCondition.notify_all();
+    }
+}
+
+void wson_thread_pool::wait() {
+    if(currentPool != this){
+        std::unique_lock<std::mutex> guard(lock);
+        doneCondition.wait(guard, [this]{ return pending.load() == 0; });
+        return;
+    }
+    /** every worker blocked in wait is inside one running task, those tasks can not finish before wait returns */
+    waiting.fetch_add(1);
+    for(;;){
+        std::function<void()> task;
+        if(popTask(currentWorker, task)){
+            queued.fetch_sub(1);
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        if(pending.load() <= waiting.load()){
+            break;
+        }
+        doneCondition.wait(guard, [this]{ return pending.load() <= waiting.load() || queued.load() > 0; });
+        if(pending.load() <= waiting.load()){
+            break;
+        }
+    }
+    waiting.fetch_sub(1);
+}
+
+bool wson_thread_pool::runOne() {
+    std::function<void()> task;
+    if(!popTask(currentPool == this ? currentWorker : 0, task)){
+        return false;
+    }
+    queued.fetch_sub(1);
+    runTask(task);
+    return true;
+}
+
+void wson_thread_pool::runTask(std::function<void()> &task) {
+    task();
+    int left = pending.fetch_sub(1) - 1;
+    if(left == 0 || left <= waiting.load()){
+        std::unique_lock<std::mutex> guard(lock);
+        doneCondition.notify_all();
+    }
+}
+
+bool wson_thread_pool::popTask(int index, std::function<void()> &task) {
+    {
+        task_queue& own = *queues[index];
+        std::unique_lock<std::mutex> guard(own.lock);
+        if(!own.tasks.empty()){
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    size_t count = queues.size();
+    for(size_t i=1; i<count; i++){
+        task_queue& other = *queues[(index + i) % count];
+        std::unique_lock<std::mutex> guard(other.lock);
+        if(!other.tasks.empty()){
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void wson_thread_pool::run(int index) {
+    currentPool = this;
+    currentWorker = index;
+    for(;;){
+        std::function<void()> task;
+        if(popTask(index, task)){
+            queued.fetch_sub(1);
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        taskCondition.wait(guard, [this]{ return stopped || queued.load() > 0; });
+        if(stopped && queued.load() <= 0){
+            return;
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * tiny fixed size work stealing thread pool used by block stream and batch apis.
+ * every worker owns a task queue, pops its own newest task first and steals oldest task from others when idle.
+ * */
+
+#ifndef WSON_THREAD_POOL_H
+#define WSON_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class wson_thread_pool {
+
+public:
+    /**
+     * threadCount <= 0 use hardware concurrency
+     * */
+    explicit wson_thread_pool(int threadCount = 0);
+    ~wson_thread_pool();
+
+    /**
+     * run task on one of the worker threads, task submit from worker goes to its own queue
+     * */
+    void submit(std::function<void()> task);
+
+    /**
+     * block until all submitted tasks finished. called from a worker of this pool,
+     * the worker runs queued tasks while waiting and does not count tasks blocked in wait
+     * */
+    void wait();
+
+    /**
+     * run one queued task on calling thread, return false if no task is queued.
+     * caller waiting on its own tasks helps instead of blocking a worker
+     * */
+    bool runOne();
+
+    inline int threadCount(){
+        return (int)workers.size();
+    }
+
+private:
+    struct task_queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void run(int index);
+    bool popTask(int index, std::function<void()>& task);
+    void runTask(std::function<void()>& task);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<task_queue>> queues;
+    std::atomic<unsigned> nextQueue;
+    std::atomic<int> queued;
+    std::atomic<int> pending;
+    std::atomic<int> waiting;
+    std::mutex lock;
+    std::condition_variable taskCondition;
+    std::condition_variable doneCondition;
+    bool stopped = false;
+};
+
+
+#endif //WSON_THREAD_POOL_H
@@ -4,6 +4,9 @@
 
 #include "wson_util.h"
 #include <stdio.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 
 
 namespace wson {
@@ -199,6 +202,60 @@ namespace wson {
     }
 
 
+    int utf8_convert_to_utf16(const char* utf8, int length, uint16_t* buffer){
+        const uint8_t* src = (const uint8_t*)utf8;
+        int count = 0;
+        for(int i=0; i<length;){
+            u_int32_t c = src[i];
+            int size;
+            if(c < 0x80){
+                buffer[count++] = (uint16_t)c;
+                i++;
+                continue;
+            }else if((c & 0xE0) == 0xC0){
+                size = 2;
+                c &= 0x1F;
+            }else if((c & 0xF0) == 0xE0){
+                size = 3;
+                c &= 0x0F;
+            }else if((c & 0xF8) == 0xF0){
+                size = 4;
+                c &= 0x07;
+            }else{
+                buffer[count++] = 0xFFFD;
+                i++;
+                continue;
+            }
+            if(i + size > length){
+                buffer[count++] = 0xFFFD;
+                break;
+            }
+            bool valid = true;
+            for(int j=1; j<size; j++){
+                if((src[i + j] & 0xC0) != 0x80){
+                    valid = false;
+                    break;
+                }
+                c = (c << 6) | (src[i + j] & 0x3F);
+            }
+            if(!valid){
+                buffer[count++] = 0xFFFD;
+                i++;
+                continue;
+            }
+            i += size;
+            if(c >= MIN_SUPPLEMENTARY_CODE_POINT){
+                c -= MIN_SUPPLEMENTARY_CODE_POINT;
+                buffer[count++] = (uint16_t)(MIN_HIGH_SURROGATE + (c >> 10));
+                buffer[count++] = (uint16_t)(MIN_LOW_SURROGATE + (c & 0x3FF));
+            }else{
+                buffer[count++] = (uint16_t)c;
+            }
+        }
+        return count;
+    }
+
+
     /** min size is 32 + 1 = 33 */
     inline void number_to_buffer(char* buffer, int32_t num){
         snprintf(buffer, 32,"%d", num);
@@ -249,4 +306,58 @@ namespace wson {
     }
 
 
+    static const char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#if defined(__SSSE3__)
+    /**
+     * 12 input bytes to 16 chars, split 6 bit indices by shuffle and multiply, then map index range
+     * to ascii offset by table lookup, see Wojciech Mula base64 simd
+     * */
+    static inline __m128i base64_encode_ssse3(__m128i in){
+        in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+        __m128i high = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i low = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(high, low);
+        /** 0..25 to 13, 26..51 to 0, 52..61 to 1..10, 62 to 11, 63 to 12 */
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+        const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '+' - 62, '/' - 63, 'A', 0, 0);
+        return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+    }
+#endif
+
+    void str_append_base64(std::string& str, const uint8_t* data, size_t length){
+        size_t start = str.size();
+        str.resize(start + (length + 2)/3*4);
+        char* out = &str[start];
+        size_t i = 0;
+#if defined(__SSSE3__)
+        /** load 16 bytes and use 12, so stop while 16 bytes still readable */
+        for(; i + 16 <= length; i += 12, out += 16){
+            __m128i in = _mm_loadu_si128((const __m128i*)(data + i));
+            _mm_storeu_si128((__m128i*)out, base64_encode_ssse3(in));
+        }
+#endif
+        for(; i + 3 <= length; i += 3, out += 4){
+            uint32_t triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+            out[0] = BASE64_CHARS[(triple >> 18) & 0x3F];
+            out[1] = BASE64_CHARS[(triple >> 12) & 0x3F];
+            out[2] = BASE64_CHARS[(triple >> 6) & 0x3F];
+            out[3] = BASE64_CHARS[triple & 0x3F];
+        }
+        if(i < length){
+            uint32_t triple = data[i] << 16;
+            if(i + 1 < length){
+                triple |= data[i + 1] << 8;
+            }
+            out[0] = BASE64_CHARS[(triple >> 18) & 0x3F];
+            out[1] = BASE64_CHARS[(triple >> 12) & 0x3F];
+            out[2] = i + 1 < length ? BASE64_CHARS[(triple >> 6) & 0x3F] : '=';
+            out[3] = '=';
+        }
+    }
+
 }
\ No newline at end of file
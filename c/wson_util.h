@@ -27,6 +27,11 @@ namespace wson{
     int utf16_convert_to_utf8_cstr(uint16_t *utf16, int length, char* buffer);
     int utf16_convert_to_utf8_quote_cstr(uint16_t *utf16, int length, char* buffer);
 
+    /**
+     * return utf-16 char count, buffer should contains length chars, invalid utf8 bytes convert to 0xFFFD
+     * */
+    int utf8_convert_to_utf16(const char* utf8, int length, uint16_t* buffer);
+
     /**
      * append support double float int32 int64
      * */
@@ -34,6 +39,11 @@ namespace wson{
     void str_append_number(std::string& str, float  num);
     void str_append_number(std::string& str, int32_t  num);
     void str_append_number(std::string& str, int64_t  num);
+
+    /**
+     * append standard base64 with padding, ssse3 when target support it
+     * */
+    void str_append_base64(std::string& str, const uint8_t* data, size_t length);
 }
 
 
@@ -97,6 +97,12 @@
             return [NSNull null];
            }
             break;
+        case WSON_EXTEND_TYPE:{
+            uint32_t length = wson_next_uint(buffer);
+            void* src = wson_next_bts(buffer, length);
+            return [NSData dataWithBytes:src length:length];
+           }
+            break;
         default:
             NSLog(@"weex weex wson err  wson_to_js_value  unhandled type %d buffer position  %d length %d", type, buffer->position, buffer->length);
             break;
@@ -23,11 +23,32 @@ package com.efurture.wson;
 import com.alibaba.fastjson.JSON;
 import com.alibaba.fastjson.JSONArray;
 import com.alibaba.fastjson.JSONObject;
-
+import com.alibaba.fastjson.TypeReference;
+import com.alibaba.fastjson.parser.ParserConfig;
+import com.alibaba.fastjson.util.TypeUtils;
+
+import java.io.Closeable;
+import java.io.EOFException;
+import java.io.Flushable;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.io.UncheckedIOException;
 import java.lang.reflect.Array;
+import java.lang.reflect.GenericArrayType;
+import java.lang.reflect.Modifier;
+import java.lang.reflect.ParameterizedType;
+import java.lang.reflect.Type;
+import java.lang.reflect.TypeVariable;
+import java.lang.reflect.WildcardType;
 import java.math.BigDecimal;
 import java.math.BigInteger;
+import java.nio.BufferUnderflowException;
+import java.nio.ByteBuffer;
 import java.nio.ByteOrder;
+import java.nio.channels.Channels;
+import java.nio.channels.ReadableByteChannel;
+import java.nio.channels.WritableByteChannel;
 import java.util.*;
 
 /**
@@ -68,6 +89,8 @@ public class Wson {
 
     private static final byte MAP_TYPE = '{';
 
+    private static final byte EXTEND_TYPE = 'b';
+
     /**
      * StringUTF-16, byte order with native byte order
      * */
@@ -94,6 +117,34 @@ public class Wson {
     }
 
 
+    /**
+     * parse wson data to typed object, bean is bound by setter or public field without json tree
+     * @param  data  byte array
+     * @param  type  target class
+     * */
+    public static <T> T parse(byte[] data, Class<T> type){
+        return (T) parse(data, (Type) type);
+    }
+
+    public static <T> T parse(byte[] data, TypeReference<T> type){
+        return (T) parse(data, type.getType());
+    }
+
+    public static Object parse(byte[] data, Type type){
+        if(data == null){
+            return  null;
+        }
+        try{
+            Parser parser =  new Parser(data);
+            Object object = parser.parse(type);
+            parser.close();
+            return object;
+        }catch (Exception e){
+            e.printStackTrace();
+            return  null;
+        }
+    }
+
     /**
      * serialize object to wson data
      * */
@@ -107,6 +158,149 @@ public class Wson {
         return bts;
     }
 
+    /**
+     * parse wson data from buffer position to limit, direct buffer is read in place without copy.
+     * position is moved after the parsed value, and not changed if data is broken
+     * */
+    public static Object parse(ByteBuffer buffer){
+        if(buffer == null){
+            return  null;
+        }
+        try{
+            BufferParser parser =  new BufferParser(buffer.duplicate(), null);
+            Object object = parser.parse();
+            buffer.position(parser.position());
+            parser.close();
+            return object;
+        }catch (Exception e){
+            e.printStackTrace();
+            return  null;
+        }
+    }
+
+    /**
+     * read wson values one by one from stream, memory is bounded by the largest string
+     * */
+    public static Reader newReader(InputStream in){
+        return new Reader(Channels.newChannel(in));
+    }
+
+    public static Reader newReader(ReadableByteChannel channel){
+        return new Reader(channel);
+    }
+
+    /**
+     * write wson values to stream, encoded bytes are flushed every chunk
+     * */
+    public static Writer newWriter(OutputStream out){
+        return new Writer(new Builder(out, null, STREAM_CHUNK_SIZE));
+    }
+
+    public static Writer newWriter(WritableByteChannel channel){
+        return new Writer(new Builder(null, channel, STREAM_CHUNK_SIZE));
+    }
+
+
+    /**
+     * wson stream reader, not thread safe
+     * */
+    public static final class Reader implements Closeable {
+
+        private final ReadableByteChannel channel;
+        private BufferParser parser;
+
+        private Reader(ReadableByteChannel channel) {
+            this.channel = channel;
+            ByteBuffer buffer = ByteBuffer.allocate(STREAM_CHUNK_SIZE);
+            buffer.flip();
+            this.parser = new BufferParser(buffer, channel);
+        }
+
+        /**
+         * read next wson value
+         * @throws EOFException if stream is end or value is truncated
+         * */
+        public Object read() throws IOException {
+            if(parser == null){
+                throw new IOException("wson reader is closed");
+            }
+            try{
+                return parser.parse();
+            }catch (UncheckedIOException e){
+                throw e.getCause();
+            }
+        }
+
+        @Override
+        public void close() throws IOException {
+            if(parser != null){
+                parser.close();
+                parser = null;
+            }
+            channel.close();
+        }
+    }
+
+    /**
+     * wson stream writer, not thread safe
+     * */
+    public static final class Writer implements Closeable, Flushable {
+
+        private Builder builder;
+
+        private Writer(Builder builder) {
+            this.builder = builder;
+        }
+
+        /**
+         * write object as one wson value, bytes may stay in chunk until flush
+         * */
+        public void write(Object object) throws IOException {
+            if(builder == null){
+                throw new IOException("wson writer is closed");
+            }
+            try{
+                builder.writeObject(object);
+            }catch (UncheckedIOException e){
+                throw e.getCause();
+            }finally {
+                builder.refs.clear();
+            }
+        }
+
+        @Override
+        public void flush() throws IOException {
+            if(builder == null){
+                return;
+            }
+            try{
+                builder.flushBuffer();
+            }catch (UncheckedIOException e){
+                throw e.getCause();
+            }
+            if(builder.out != null){
+                builder.out.flush();
+            }
+        }
+
+        @Override
+        public void close() throws IOException {
+            if(builder == null){
+                return;
+            }
+            try{
+                flush();
+            }finally {
+                if(builder.out != null){
+                    builder.out.close();
+                }else{
+                    builder.channel.close();
+                }
+                builder = null;
+            }
+        }
+    }
+
 
     /**
      * wson data parser
@@ -132,6 +326,10 @@ public class Wson {
             return  readObject();
         }
 
+        public  final Object parse(Type type){
+            return  readValue(type);
+        }
+
         public final void close(){
             position = 0;
             buffer = null;
@@ -168,6 +366,8 @@ public class Wson {
                     return  Boolean.TRUE;
                 case NULL_TYPE:
                     return  null;
+                case EXTEND_TYPE:
+                    return readBytes();
                 default:
                     throw new RuntimeException("wson unhandled type " + type + " " +
                      position  +  " length " + buffer.length);
@@ -196,6 +396,14 @@ public class Wson {
             return  array;
         }
 
+        private final byte[] readBytes(){
+            int length = readUInt();
+            byte[] bytes = new byte[length];
+            System.arraycopy(buffer, position, bytes, 0, length);
+            position += length;
+            return bytes;
+        }
+
         private  final byte readType(){
             byte type = buffer[position];
             position ++;
@@ -227,26 +435,7 @@ public class Wson {
                         position+=2;
                     }
                 }
-                int globalIndex = (globalStringBytesCache.length - 1)&hash;
-               String cache = globalStringBytesCache[globalIndex];
-                if(cache != null
-                        && cache.length() == length){
-                    boolean isStringEqual  = true;
-                    for(int i=0; i<length; i++){
-                        if(charsBuffer[i] != cache.charAt(i)){
-                            isStringEqual = false;
-                            break;
-                        }
-                    }
-                    if(isStringEqual) {
-                        return cache;
-                    }
-                }
-                cache = new String(charsBuffer, 0, length);
-                if(length < 64) {
-                    globalStringBytesCache[globalIndex] = cache;
-                }
-                return  cache;
+                return cacheKey(charsBuffer, length, hash);
         }
 
         private final String readUTF16String(){
@@ -328,6 +517,10 @@ public class Wson {
         }
 
         private Object readFloat() {
+            return  readFloatValue();
+        }
+
+        private float readFloatValue() {
             int number = (((buffer[position + 3] & 0xFF)      ) +
                     ((buffer[position + 2] & 0xFF) <<  8) +
                     ((buffer[position + 1] & 0xFF) << 16) +
@@ -335,6 +528,759 @@ public class Wson {
             position +=4;
             return  Float.intBitsToFloat(number);
         }
+
+        /**
+         * read value as type, bean is bound by cached deserializer,
+         * type not handled here is read as json tree and cast by fastjson
+         * */
+        private final Object readValue(Type type){
+            Class<?> rawType = rawClass(type);
+            byte valueType = buffer[position];
+            if(valueType == NULL_TYPE){
+                position++;
+                return null;
+            }
+            if(rawType == Object.class){
+                return readObject();
+            }
+            if(rawType == String.class){
+                if(valueType == STRING_TYPE){
+                    position++;
+                    return readUTF16String();
+                }
+                return String.valueOf(readObject());
+            }
+            if(rawType == int.class || rawType == Integer.class){
+                return readIntValue();
+            }
+            if(rawType == long.class || rawType == Long.class){
+                return readLongValue();
+            }
+            if(rawType == double.class || rawType == Double.class){
+                return readDoubleValue();
+            }
+            if(rawType == boolean.class || rawType == Boolean.class){
+                return readBooleanValue();
+            }
+            if(rawType == byte[].class && valueType == EXTEND_TYPE){
+                position++;
+                return readBytes();
+            }
+            if(valueType == ARRAY_TYPE){
+                if(rawType.isArray()){
+                    position++;
+                    return readTypedArray(rawType.getComponentType(), type);
+                }
+                if(Collection.class.isAssignableFrom(rawType)){
+                    Collection collection = createCollection(rawType);
+                    if(collection != null){
+                        position++;
+                        return readCollection(collection, typeArgument(type, 0));
+                    }
+                }
+            }
+            if(valueType == MAP_TYPE){
+                if(Map.class.isAssignableFrom(rawType)){
+                    Type keyType = typeArgument(type, 0);
+                    Map map = createMap(rawType);
+                    if(map != null && (keyType == Object.class || keyType == String.class)){
+                        position++;
+                        return readTypedMap(map, typeArgument(type, 1));
+                    }
+                }else{
+                    WsonAdapter.BeanDeserializer deserializer = WsonAdapter.getBeanDeserializer(rawType);
+                    if(deserializer != null){
+                        position++;
+                        return readBean(deserializer, type);
+                    }
+                }
+            }
+            return TypeUtils.cast(readObject(), type, ParserConfig.getGlobalInstance());
+        }
+
+        private final Object readBean(WsonAdapter.BeanDeserializer deserializer, Type beanType){
+            try{
+                Object bean = deserializer.newInstance();
+                int size = readUInt();
+                for(int i=0; i<size; i++){
+                    int length = readUInt();
+                    WsonAdapter.BeanSetter setter = deserializer.find(buffer, position, length);
+                    position += length;
+                    if(setter == null){
+                        skipValue();
+                        continue;
+                    }
+                    if(buffer[position] == NULL_TYPE){
+                        position++;
+                        continue;
+                    }
+                    switch (setter.kind){
+                        case WsonAdapter.KIND_INT:
+                            setter.setter.invokeExact(bean, readIntValue());
+                            break;
+                        case WsonAdapter.KIND_LONG:
+                            setter.setter.invokeExact(bean, readLongValue());
+                            break;
+                        case WsonAdapter.KIND_DOUBLE:
+                            setter.setter.invokeExact(bean, readDoubleValue());
+                            break;
+                        case WsonAdapter.KIND_FLOAT:
+                            setter.setter.invokeExact(bean, (float) readDoubleValue());
+                            break;
+                        case WsonAdapter.KIND_BOOLEAN:
+                            setter.setter.invokeExact(bean, readBooleanValue());
+                            break;
+                        case WsonAdapter.KIND_SHORT:
+                            setter.setter.invokeExact(bean, (short) readIntValue());
+                            break;
+                        case WsonAdapter.KIND_BYTE:
+                            setter.setter.invokeExact(bean, (byte) readIntValue());
+                            break;
+                        case WsonAdapter.KIND_CHAR:
+                            setter.setter.invokeExact(bean, readCharValue());
+                            break;
+                        default:
+                            setter.setter.invokeExact(bean, readValue(resolveType(setter.type, beanType)));
+                            break;
+                    }
+                }
+                return bean;
+            }catch (RuntimeException e){
+                throw e;
+            }catch (Throwable e){
+                throw new RuntimeException(e);
+            }
+        }
+
+        private final Object readTypedArray(Class<?> componentType, Type type){
+            int length = readUInt();
+            if(componentType == int.class){
+                int[] array = new int[length];
+                for(int i=0; i<length; i++){
+                    array[i] = readIntValue();
+                }
+                return array;
+            }
+            if(componentType == long.class){
+                long[] array = new long[length];
+                for(int i=0; i<length; i++){
+                    array[i] = readLongValue();
+                }
+                return array;
+            }
+            if(componentType == double.class){
+                double[] array = new double[length];
+                for(int i=0; i<length; i++){
+                    array[i] = readDoubleValue();
+                }
+                return array;
+            }
+            Type componentGenericType = componentType;
+            if(type instanceof GenericArrayType){
+                componentGenericType = ((GenericArrayType) type).getGenericComponentType();
+            }
+            Object array = Array.newInstance(componentType, length);
+            for(int i=0; i<length; i++){
+                Array.set(array, i, readValue(componentGenericType));
+            }
+            return array;
+        }
+
+        private final Object readCollection(Collection collection, Type elementType){
+            int length = readUInt();
+            for(int i=0; i<length; i++){
+                collection.add(readValue(elementType));
+            }
+            return collection;
+        }
+
+        private final Object readTypedMap(Map map, Type valueType){
+            int size = readUInt();
+            for(int i=0; i<size; i++){
+                String key = readMapKeyUTF16();
+                map.put(key, readValue(valueType));
+            }
+            return map;
+        }
+
+        /**
+         * number value without boxing, other wson type is cast by fastjson
+         * */
+        private final int readIntValue(){
+            byte type = readType();
+            switch (type){
+                case NUMBER_INT_TYPE:
+                    return readVarInt();
+                case NUMBER_LONG_TYPE:
+                    return (int) readLong();
+                case NUMBER_DOUBLE_TYPE:
+                    return (int) Double.longBitsToDouble(readLong());
+                case NUMBER_FLOAT_TYPE:
+                    return (int) readFloatValue();
+                case NULL_TYPE:
+                    return 0;
+                default:
+                    position--;
+                    Integer value = TypeUtils.castToInt(readObject());
+                    return value == null ? 0 : value;
+            }
+        }
+
+        private final long readLongValue(){
+            byte type = readType();
+            switch (type){
+                case NUMBER_INT_TYPE:
+                    return readVarInt();
+                case NUMBER_LONG_TYPE:
+                    return readLong();
+                case NUMBER_DOUBLE_TYPE:
+                    return (long) Double.longBitsToDouble(readLong());
+                case NUMBER_FLOAT_TYPE:
+                    return (long) readFloatValue();
+                case NULL_TYPE:
+                    return 0;
+                default:
+                    position--;
+                    Long value = TypeUtils.castToLong(readObject());
+                    return value == null ? 0 : value;
+            }
+        }
+
+        private final double readDoubleValue(){
+            byte type = readType();
+            switch (type){
+                case NUMBER_INT_TYPE:
+                    return readVarInt();
+                case NUMBER_LONG_TYPE:
+                    return readLong();
+                case NUMBER_DOUBLE_TYPE:
+                    return Double.longBitsToDouble(readLong());
+                case NUMBER_FLOAT_TYPE:
+                    return readFloatValue();
+                case NULL_TYPE:
+                    return 0;
+                default:
+                    position--;
+                    Double value = TypeUtils.castToDouble(readObject());
+                    return value == null ? 0 : value;
+            }
+        }
+
+        private final boolean readBooleanValue(){
+            byte type = readType();
+            switch (type){
+                case BOOLEAN_TYPE_TRUE:
+                    return true;
+                case BOOLEAN_TYPE_FALSE:
+                case NULL_TYPE:
+                    return false;
+                case NUMBER_INT_TYPE:
+                    return readVarInt() != 0;
+                default:
+                    position--;
+                    Boolean value = TypeUtils.castToBoolean(readObject());
+                    return value != null && value;
+            }
+        }
+
+        private final char readCharValue(){
+            if(buffer[position] == NUMBER_INT_TYPE){
+                return (char) readIntValue();
+            }
+            Character value = TypeUtils.castToChar(readObject());
+            return value == null ? 0 : value;
+        }
+
+        /**
+         * skip value of unknown bean property without create object
+         * */
+        private final void skipValue(){
+            byte type = readType();
+            switch (type){
+                case STRING_TYPE:
+                case NUMBER_BIG_INTEGER_TYPE:
+                case NUMBER_BIG_DECIMAL_TYPE:
+                case EXTEND_TYPE: {
+                    int length = readUInt();
+                    position += length;
+                    break;
+                }
+                case NUMBER_INT_TYPE:
+                    readUInt();
+                    break;
+                case NUMBER_FLOAT_TYPE:
+                    position += 4;
+                    break;
+                case NUMBER_DOUBLE_TYPE:
+                case NUMBER_LONG_TYPE:
+                    position += 8;
+                    break;
+                case MAP_TYPE: {
+                    int size = readUInt();
+                    for(int i=0; i<size; i++){
+                        int length = readUInt();
+                        position += length;
+                        skipValue();
+                    }
+                    break;
+                }
+                case ARRAY_TYPE: {
+                    int length = readUInt();
+                    for(int i=0; i<length; i++){
+                        skipValue();
+                    }
+                    break;
+                }
+                case BOOLEAN_TYPE_TRUE:
+                case BOOLEAN_TYPE_FALSE:
+                case NULL_TYPE:
+                    break;
+                default:
+                    throw new RuntimeException("wson unhandled type " + type + " " +
+                            position  +  " length " + buffer.length);
+            }
+        }
+    }
+
+    private static Class<?> rawClass(Type type){
+        if(type instanceof Class){
+            return (Class<?>) type;
+        }
+        if(type instanceof ParameterizedType){
+            return rawClass(((ParameterizedType) type).getRawType());
+        }
+        if(type instanceof GenericArrayType){
+            return Array.newInstance(rawClass(((GenericArrayType) type).getGenericComponentType()), 0).getClass();
+        }
+        if(type instanceof WildcardType){
+            return rawClass(((WildcardType) type).getUpperBounds()[0]);
+        }
+        if(type instanceof TypeVariable){
+            Type[] bounds = ((TypeVariable) type).getBounds();
+            return bounds.length > 0 ? rawClass(bounds[0]) : Object.class;
+        }
+        return Object.class;
+    }
+
+    private static Type typeArgument(Type type, int index){
+        if(type instanceof ParameterizedType){
+            Type[] arguments = ((ParameterizedType) type).getActualTypeArguments();
+            if(index < arguments.length){
+                return arguments[index];
+            }
+        }
+        return Object.class;
+    }
+
+    /**
+     * resolve type variables in bean property type with bean type, like T in List<T> of Page<T>,
+     * or T of Result<T> when bean is PersonResult extends Result<Person>. parameterized, array and
+     * wildcard types are resolved recursively, variable left unresolved is read as its bound.
+     * */
+    private static Type resolveType(Type type, Type beanType){
+        if(type instanceof Class){
+            return type;
+        }
+        if(type instanceof TypeVariable){
+            Type resolved = resolveVariable((TypeVariable) type, beanType);
+            return resolved != null ? resolved : type;
+        }
+        if(type instanceof ParameterizedType){
+            ParameterizedType parameterizedType = (ParameterizedType) type;
+            Type[] arguments = parameterizedType.getActualTypeArguments();
+            Type[] resolved = null;
+            for(int i=0; i<arguments.length; i++){
+                Type argument = resolveType(arguments[i], beanType);
+                if(argument != arguments[i]){
+                    if(resolved == null){
+                        resolved = arguments.clone();
+                    }
+                    resolved[i] = argument;
+                }
+            }
+            if(resolved == null){
+                return type;
+            }
+            return new ResolvedParameterizedType(parameterizedType.getRawType(), parameterizedType.getOwnerType(), resolved);
+        }
+        if(type instanceof GenericArrayType){
+            Type component = ((GenericArrayType) type).getGenericComponentType();
+            Type resolved = resolveType(component, beanType);
+            if(resolved == component){
+                return type;
+            }
+            if(resolved instanceof Class){
+                return Array.newInstance((Class<?>) resolved, 0).getClass();
+            }
+            return new ResolvedGenericArrayType(resolved);
+        }
+        if(type instanceof WildcardType){
+            Type[] lowerBounds = ((WildcardType) type).getLowerBounds();
+            if(lowerBounds.length > 0){
+                return resolveType(lowerBounds[0], beanType);
+            }
+            return resolveType(((WildcardType) type).getUpperBounds()[0], beanType);
+        }
+        return type;
+    }
+
+    /**
+     * walk from bean type up the generic superclass chain to the class declaring variable,
+     * every superclass type argument is resolved with its subclass on the way. null if unresolved
+     * */
+    private static Type resolveVariable(TypeVariable variable, Type beanType){
+        if(!(variable.getGenericDeclaration() instanceof Class)){
+            return null;
+        }
+        Class<?> declaration = (Class<?>) variable.getGenericDeclaration();
+        Type current = beanType;
+        while(current != null){
+            Class<?> rawType = rawClass(current);
+            if(rawType == declaration){
+                if(!(current instanceof ParameterizedType)){
+                    return null;
+                }
+                TypeVariable[] variables = declaration.getTypeParameters();
+                Type[] arguments = ((ParameterizedType) current).getActualTypeArguments();
+                for(int i=0; i<variables.length && i<arguments.length; i++){
+                    if(variables[i].equals(variable)){
+                        return arguments[i] instanceof TypeVariable ? null : arguments[i];
+                    }
+                }
+                return null;
+            }
+            if(!declaration.isAssignableFrom(rawType)){
+                return null;
+            }
+            Type superType = rawType.getGenericSuperclass();
+            current = superType == null ? null : resolveType(superType, current);
+        }
+        return null;
+    }
+
+    private static final class ResolvedParameterizedType implements ParameterizedType {
+        private final Type rawType;
+        private final Type ownerType;
+        private final Type[] arguments;
+
+        ResolvedParameterizedType(Type rawType, Type ownerType, Type[] arguments) {
+            this.rawType = rawType;
+            this.ownerType = ownerType;
+            this.arguments = arguments;
+        }
+
+        @Override
+        public Type[] getActualTypeArguments() {
+            return arguments.clone();
+        }
+
+        @Override
+        public Type getRawType() {
+            return rawType;
+        }
+
+        @Override
+        public Type getOwnerType() {
+            return ownerType;
+        }
+
+        @Override
+        public boolean equals(Object other) {
+            if(!(other instanceof ParameterizedType)){
+                return false;
+            }
+            ParameterizedType type = (ParameterizedType) other;
+            return rawType.equals(type.getRawType())
+                    && Objects.equals(ownerType, type.getOwnerType())
+                    && Arrays.equals(arguments, type.getActualTypeArguments());
+        }
+
+        @Override
+        public int hashCode() {
+            return Arrays.hashCode(arguments) ^ Objects.hashCode(ownerType) ^ rawType.hashCode();
+        }
+
+        @Override
+        public String toString() {
+            StringBuilder builder = new StringBuilder(rawType.getTypeName());
+            builder.append('<');
+            for(int i=0; i<arguments.length; i++){
+                if(i > 0){
+                    builder.append(", ");
+                }
+                builder.append(arguments[i].getTypeName());
+            }
+            return builder.append('>').toString();
+        }
+    }
+
+    private static final class ResolvedGenericArrayType implements GenericArrayType {
+        private final Type componentType;
+
+        ResolvedGenericArrayType(Type componentType) {
+            this.componentType = componentType;
+        }
+
+        @Override
+        public Type getGenericComponentType() {
+            return componentType;
+        }
+
+        @Override
+        public boolean equals(Object other) {
+            return other instanceof GenericArrayType
+                    && componentType.equals(((GenericArrayType) other).getGenericComponentType());
+        }
+
+        @Override
+        public int hashCode() {
+            return componentType.hashCode();
+        }
+
+        @Override
+        public String toString() {
+            return componentType.getTypeName() + "[]";
+        }
+    }
+
+    private static Collection createCollection(Class<?> rawType){
+        if(rawType.isAssignableFrom(ArrayList.class)){
+            return new ArrayList();
+        }
+        if(rawType.isAssignableFrom(HashSet.class)){
+            return new HashSet();
+        }
+        if(rawType.isAssignableFrom(TreeSet.class)){
+            return new TreeSet();
+        }
+        return (Collection) newInstance(rawType);
+    }
+
+    private static Map createMap(Class<?> rawType){
+        if(rawType.isAssignableFrom(HashMap.class)){
+            return new HashMap();
+        }
+        if(rawType.isAssignableFrom(TreeMap.class)){
+            return new TreeMap();
+        }
+        return (Map) newInstance(rawType);
+    }
+
+    private static Object newInstance(Class<?> rawType){
+        if(rawType.isInterface() || Modifier.isAbstract(rawType.getModifiers())){
+            return null;
+        }
+        try{
+            return rawType.newInstance();
+        }catch (Exception e){
+            return null;
+        }
+    }
+
+    /**
+     * wson parser on ByteBuffer, strings are bulk copied through native order char view.
+     * with channel, buffer is refilled on demand and only grows to the largest string
+     * */
+    private static final class BufferParser {
+
+        private ByteBuffer buffer;
+        private ReadableByteChannel channel;
+        private char[]  charsBuffer;
+
+        public BufferParser(ByteBuffer buffer, ReadableByteChannel channel) {
+            this.buffer = buffer.order(ByteOrder.BIG_ENDIAN);
+            this.channel = channel;
+            charsBuffer = localCharsBufferCache.get();
+            if(charsBuffer != null){
+                localCharsBufferCache.set(null);
+            }else{
+                charsBuffer = new char[512];
+            }
+        }
+
+        public  final Object parse(){
+            return  readObject();
+        }
+
+        public final int position(){
+            return buffer.position();
+        }
+
+        public final void close(){
+            buffer = null;
+            channel = null;
+            if(charsBuffer != null){
+                localCharsBufferCache.set(charsBuffer);
+            }
+            charsBuffer = null;
+        }
+
+        private final Object readObject(){
+            byte type  = readByte();
+            switch (type){
+                case STRING_TYPE:
+                    return readUTF16String();
+                case NUMBER_INT_TYPE :
+                    return  readVarInt();
+                case NUMBER_FLOAT_TYPE :
+                    require(4);
+                    return  buffer.getFloat();
+                case MAP_TYPE:
+                    return readMap();
+                case ARRAY_TYPE:
+                    return readArray();
+                case NUMBER_DOUBLE_TYPE :
+                    return readDouble();
+                case NUMBER_LONG_TYPE :
+                    require(8);
+                    return  buffer.getLong();
+                case NUMBER_BIG_INTEGER_TYPE :
+                    return  new BigInteger(readUTF16String());
+                case NUMBER_BIG_DECIMAL_TYPE :
+                    return  new BigDecimal(readUTF16String());
+                case BOOLEAN_TYPE_FALSE:
+                    return  Boolean.FALSE;
+                case BOOLEAN_TYPE_TRUE:
+                    return  Boolean.TRUE;
+                case NULL_TYPE:
+                    return  null;
+                case EXTEND_TYPE:
+                    return readBytes();
+                default:
+                    throw new RuntimeException("wson unhandled type " + type + " " +
+                            buffer.position()  +  " limit " + buffer.limit());
+            }
+        }
+
+        private final Object readMap(){
+            int size = readUInt();
+            Map<String, Object> object = new JSONObject();
+            for(int i=0; i<size; i++){
+                String key = readMapKeyUTF16();
+                Object value = readObject();
+                object.put(key, value);
+            }
+            return object;
+        }
+
+        private final Object readArray(){
+            int length = readUInt();
+            List<Object> array = new JSONArray(Math.min(length, buffer.remaining()));
+            for(int i=0; i<length; i++){
+                array.add(readObject());
+            }
+            return  array;
+        }
+
+        private final byte[] readBytes(){
+            int length = readUInt();
+            require(length);
+            byte[] bytes = new byte[length];
+            buffer.get(bytes);
+            return bytes;
+        }
+
+        private final String readMapKeyUTF16() {
+            int length = readUInt()/2;
+            char[] chars = readChars(length);
+            int hash = 5381;
+            for(int i=0; i<length; i++){
+                hash = ((hash << 5) + hash)  + chars[i];
+            }
+            return cacheKey(chars, length, hash);
+        }
+
+        private final String readUTF16String(){
+            int length = readUInt()/2;
+            return  new String(readChars(length), 0, length);
+        }
+
+        /**
+         * bulk copy, direct buffer view in native order copy memory without per char loop
+         * */
+        private final char[] readChars(int length){
+            require(length*2);
+            if(charsBuffer.length < length){
+                charsBuffer = new char[length];
+            }
+            buffer.order(ByteOrder.nativeOrder()).asCharBuffer().get(charsBuffer, 0, length);
+            buffer.order(ByteOrder.BIG_ENDIAN);
+            buffer.position(buffer.position() + length*2);
+            return charsBuffer;
+        }
+
+        private  final int readVarInt(){
+            int raw = readUInt();
+            int num = (((raw << 31) >> 31) ^ raw) >> 1;
+            return num ^ (raw & (1 << 31));
+        }
+
+        private final  int readUInt(){
+            int value = 0;
+            int i = 0;
+            int b;
+            while (((b = readByte()) & 0x80) != 0) {
+                value |= (b & 0x7F) << i;
+                i += 7;
+                if (i > 35) {
+                    throw new IllegalArgumentException("Variable length quantity is too long");
+                }
+            }
+            return value | (b << i);
+        }
+
+        private  final Object readDouble(){
+            require(8);
+            double number = buffer.getDouble();
+            if(number > Integer.MAX_VALUE){
+                long numberLong = (long) number;
+                double doubleLong = (numberLong);
+                if(number - doubleLong < Double.MIN_NORMAL){
+                    return numberLong;
+                }
+            }
+            return  number;
+        }
+
+        private final byte readByte(){
+            if(!buffer.hasRemaining()){
+                require(1);
+            }
+            return buffer.get();
+        }
+
+        /**
+         * make sure size bytes remaining, read more from channel if has one
+         * */
+        private final void require(int size){
+            if(size < 0){
+                throw new BufferUnderflowException();
+            }
+            if(buffer.remaining() >= size){
+                return;
+            }
+            if(channel == null){
+                throw new BufferUnderflowException();
+            }
+            if(buffer.capacity() < size){
+                ByteBuffer grow = ByteBuffer.allocate(Math.max(buffer.capacity()*2, size));
+                grow.put(buffer);
+                grow.flip();
+                buffer = grow;
+            }
+            buffer.compact();
+            try{
+                while (buffer.position() < size){
+                    if(channel.read(buffer) < 0){
+                        buffer.flip();
+                        throw new EOFException("wson stream end, require " + size + " bytes");
+                    }
+                }
+            }catch (IOException e){
+                throw new UncheckedIOException(e);
+            }
+            buffer.flip();
+        }
     }
 
     /**
@@ -347,6 +1293,12 @@ public class Wson {
         private ArrayList refs;
         private final static ThreadLocal<byte[]> bufLocal = new ThreadLocal<byte[]>();
         private final static ThreadLocal<ArrayList> refsLocal = new ThreadLocal<ArrayList>();
+        /**
+         * stream sink, buffer is flushed to it instead of growing
+         * */
+        private OutputStream out;
+        private WritableByteChannel channel;
+        private ByteBuffer channelBuffer;
 
 
 
@@ -365,6 +1317,13 @@ public class Wson {
             }
         }
 
+        private Builder(OutputStream out, WritableByteChannel channel, int chunkSize){
+            this.out = out;
+            this.channel = channel;
+            this.buffer = new byte[chunkSize];
+            this.refs = new ArrayList<>(16);
+        }
+
 
         private final byte[] toWson(Object object){
             writeObject(object);
@@ -593,16 +1552,45 @@ public class Wson {
                 writeObject(JSON.toJSON(object));
                 return;
             }
+            WsonAdapter.BeanProperty[] properties = WsonAdapter.getBeanProperties(object.getClass());
+            if(properties == null){
+                writeObject(JSON.toJSON(object));
+                return;
+            }
+            Object[] values;
             try{
-                writeMap(toMap(object));
+                values = WsonAdapter.getBeanValues(object, properties);
             }catch (Exception e){
                 WsonAdapter.specialClass.put(object.getClass().getName(), true);
                 writeObject(JSON.toJSON(object));
+                return;
             }
+            writeBean(properties, values);
         }
 
-        private  final Map  toMap(Object object){
-            return WsonAdapter.toMap(object);
+        /**
+         * bean as map, pre encoded keys are copied without intermediate map, null value is skipped
+         * */
+        private final void writeBean(WsonAdapter.BeanProperty[] properties, Object[] values){
+            int size = 0;
+            for(Object value : values){
+                if(value != null){
+                    size++;
+                }
+            }
+            ensureCapacity(8);
+            writeByte(MAP_TYPE);
+            writeUInt(size);
+            for(int i=0; i<properties.length; i++){
+                if(values[i] == null){
+                    continue;
+                }
+                byte[] key = properties[i].key;
+                ensureCapacity(key.length);
+                System.arraycopy(key, 0, buffer, position, key.length);
+                position += key.length;
+                writeObject(values[i]);
+            }
         }
 
         private  final void writeMapKeyUTF16(String value){
@@ -617,17 +1605,43 @@ public class Wson {
          * */
         private  final void writeUTF16String(CharSequence value){
             int length = value.length();
+            if(isStream() && length*2 + 8 > buffer.length){
+                writeUTF16StringChunks(value, length);
+                return;
+            }
             ensureCapacity(length*2 + 8);
             writeUInt(length*2);
+            writeUTF16Chars(value, 0, length);
+        }
+
+        /**
+         * string larger than stream chunk is written in pieces, chunk is flushed between them
+         * */
+        private  final void writeUTF16StringChunks(CharSequence value, int length){
+            ensureCapacity(8);
+            writeUInt(length*2);
+            int start = 0;
+            while (start < length){
+                int end = Math.min(length, start + (buffer.length - position)/2);
+                if(end == start){
+                    flushBuffer();
+                    continue;
+                }
+                writeUTF16Chars(value, start, end);
+                start = end;
+            }
+        }
+
+        private  final void writeUTF16Chars(CharSequence value, int start, int end){
             if(IS_NATIVE_LITTLE_ENDIAN){
-                for(int i=0; i<length; i++){
+                for(int i=start; i<end; i++){
                     char ch = value.charAt(i);
                     buffer[position] = (byte) (ch);
                     buffer[position+1] = (byte) (ch >>> 8);
                     position+=2;
                 }
             }else{
-                for(int i=0; i<length; i++){
+                for(int i=start; i<end; i++){
                     char ch = value.charAt(i);
                     buffer[position + 1] = (byte) (ch      );
                     buffer[position] = (byte) (ch >>> 8);
@@ -677,7 +1691,40 @@ public class Wson {
         }
 
 
+        private final boolean isStream(){
+            return out != null || channel != null;
+        }
+
+        /**
+         * write buffered bytes to stream sink and reuse buffer from start
+         * */
+        private final void flushBuffer(){
+            if(position == 0){
+                return;
+            }
+            try{
+                if(out != null){
+                    out.write(buffer, 0, position);
+                }else{
+                    if(channelBuffer == null || channelBuffer.array() != buffer){
+                        channelBuffer = ByteBuffer.wrap(buffer);
+                    }
+                    channelBuffer.clear();
+                    channelBuffer.limit(position);
+                    while (channelBuffer.hasRemaining()){
+                        channel.write(channelBuffer);
+                    }
+                }
+            }catch (IOException e){
+                throw new UncheckedIOException(e);
+            }
+            position = 0;
+        }
+
         private final void ensureCapacity(int minCapacity) {
+            if(position + minCapacity > buffer.length && isStream()){
+                flushBuffer();
+            }
             minCapacity += position;
             // overflow-conscious code
             if (minCapacity - buffer.length > 0){
@@ -695,6 +1742,37 @@ public class Wson {
     }
 
 
+    /**
+     * cached key string for chars, same key is shared by all parsers
+     * */
+    private static String cacheKey(char[] chars, int length, int hash){
+        int globalIndex = (globalStringBytesCache.length - 1)&hash;
+        String cache = globalStringBytesCache[globalIndex];
+        if(cache != null
+                && cache.length() == length){
+            boolean isStringEqual  = true;
+            for(int i=0; i<length; i++){
+                if(chars[i] != cache.charAt(i)){
+                    isStringEqual = false;
+                    break;
+                }
+            }
+            if(isStringEqual) {
+                return cache;
+            }
+        }
+        cache = new String(chars, 0, length);
+        if(length < 64) {
+            globalStringBytesCache[globalIndex] = cache;
+        }
+        return  cache;
+    }
+
+    /**
+     * stream reader and writer chunk size
+     * */
+    private static final int STREAM_CHUNK_SIZE = 8*1024;
+
     /**
      * cache json property key, most of them all same
      * */
@@ -21,11 +21,22 @@ package com.efurture.wson;
 import com.alibaba.fastjson.JSONArray;
 import com.alibaba.fastjson.JSONObject;
 import com.alibaba.fastjson.annotation.JSONField;
+import com.alibaba.fastjson.annotation.JSONType;
 
+import java.lang.invoke.CallSite;
+import java.lang.invoke.LambdaConversionException;
+import java.lang.invoke.LambdaMetafactory;
+import java.lang.invoke.MethodHandle;
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.MethodType;
+import java.lang.reflect.Constructor;
 import java.lang.reflect.Field;
 import java.lang.reflect.Method;
 import java.lang.reflect.Modifier;
+import java.lang.reflect.Type;
+import java.nio.ByteOrder;
 import java.util.*;
+import java.util.function.Function;
 
 /**
  * adapter for different environment, adapter for fastjson
@@ -43,51 +54,172 @@ class WsonAdapter {
 
     /**
      * convert object to map, only first layer is convert to map.
+     * @throws IllegalArgumentException if class is not a plain bean
      * */
     static Map toMap(Object object){
+        BeanProperty[] properties = getBeanProperties(object.getClass());
+        if(properties == null){
+            throw new IllegalArgumentException("not a plain bean " + object.getClass().getName());
+        }
+        Object[] values = getBeanValues(object, properties);
         Map map = new JSONObject();
-        try {
-            Class<?> targetClass = object.getClass();
-            String key = targetClass.getName();
-            List<Method> methods = getBeanMethod(key, targetClass);
-            for (Method method : methods) {
-                String methodName = method.getName();
-                if (methodName.startsWith(METHOD_PREFIX_GET)) {
-                    Object value = method.invoke(object);
-                    if(value != null){
-                        StringBuilder builder = new StringBuilder(method.getName().substring(3));
-                        builder.setCharAt(0, Character.toLowerCase(builder.charAt(0)));
-                        map.put(builder.toString(), (Object) value);
-                    }
-                }else if(methodName.startsWith(METHOD_PREFIX_IS)){
-                    Object value = method.invoke(object);
-                    if(value != null){
-                        StringBuilder builder = new StringBuilder(method.getName().substring(2));
-                        builder.setCharAt(0, Character.toLowerCase(builder.charAt(0)));
-                        map.put(builder.toString(), value);
-                    }
+        for(int i=0; i<properties.length; i++){
+            if(values[i] != null){
+                map.put(properties[i].name, values[i]);
+            }
+        }
+        return  map;
+    }
+
+    /**
+     * bean property read by generated accessor, key is pre encoded as wson map key.
+     * public field with same name is read when getter return null.
+     * */
+    static final class BeanProperty {
+        final String name;
+        final byte[] key;
+        final Function<Object, Object> getter;
+        final Function<Object, Object> field;
+
+        BeanProperty(String name, Function<Object, Object> getter, Function<Object, Object> field) {
+            this.name = name;
+            this.key = encodeKey(name);
+            this.getter = getter;
+            this.field = field;
+        }
+    }
+
+    /**
+     * properties sorted by name, built once per class.
+     * null if class is not a plain bean, failure is cached too, caller should fallback to fastjson
+     * */
+    static BeanProperty[] getBeanProperties(Class<?> targetClass){
+        BeanProperty[] properties = beanProperties.get(targetClass);
+        return properties == NOT_BEAN ? null : properties;
+    }
+
+    /**
+     * read all property values before write, so a throwing getter leave nothing half written
+     * */
+    static Object[] getBeanValues(Object object, BeanProperty[] properties){
+        Object[] values = new Object[properties.length];
+        for(int i=0; i<properties.length; i++){
+            BeanProperty property = properties[i];
+            Object value = null;
+            if(property.getter != null){
+                value = property.getter.apply(object);
+            }
+            if(value == null && property.field != null){
+                value = property.field.apply(object);
+            }
+            values[i] = value;
+        }
+        return values;
+    }
+
+    /**
+     * setter kind, primitive setter is invoked exactly without boxing
+     * */
+    static final int KIND_OBJECT = 0;
+    static final int KIND_INT = 1;
+    static final int KIND_LONG = 2;
+    static final int KIND_DOUBLE = 3;
+    static final int KIND_FLOAT = 4;
+    static final int KIND_BOOLEAN = 5;
+    static final int KIND_SHORT = 6;
+    static final int KIND_BYTE = 7;
+    static final int KIND_CHAR = 8;
+
+    /**
+     * bean property written by setter method or public field,
+     * setter type is (Object, primitive)void for primitive kind, (Object, Object)void otherwise
+     * */
+    static final class BeanSetter {
+        final byte[] key;
+        final int hash;
+        final Type type;
+        final int kind;
+        final MethodHandle setter;
+
+        BeanSetter(String name, Type type, MethodHandle handle) {
+            this.key = utf16Bytes(name);
+            this.hash = keyHash(key, 0, key.length);
+            this.type = type;
+            Class<?> rawType = handle.type().parameterType(1);
+            this.kind = kind(rawType);
+            this.setter = handle.asType(MethodType.methodType(void.class, Object.class,
+                    kind == KIND_OBJECT ? Object.class : rawType));
+        }
+    }
+
+    /**
+     * per class deserializer, key is matched on raw utf-16 bytes by open addressing table
+     * */
+    static final class BeanDeserializer {
+        private final MethodHandle constructor;
+        private final BeanSetter[] table;
+        private final int mask;
+
+        BeanDeserializer(MethodHandle constructor, Collection<BeanSetter> setters) {
+            this.constructor = constructor.asType(MethodType.methodType(Object.class));
+            int capacity = 4;
+            while (capacity < setters.size()*2){
+                capacity <<= 1;
+            }
+            this.table = new BeanSetter[capacity];
+            this.mask = capacity - 1;
+            for(BeanSetter setter : setters){
+                int index = setter.hash & mask;
+                while (table[index] != null){
+                    index = (index + 1) & mask;
                 }
+                table[index] = setter;
             }
-            List<Field> fields = getBeanFields(key, targetClass);
-            for(Field field : fields){
-                String fieldName = field.getName();
-                if(map.containsKey(fieldName)){
-                    continue;
+        }
+
+        final Object newInstance() throws Throwable {
+            return (Object) constructor.invokeExact();
+        }
+
+        /**
+         * setter for key bytes in buffer, null if bean has no such property
+         * */
+        final BeanSetter find(byte[] buffer, int offset, int length){
+            int hash = keyHash(buffer, offset, length);
+            for(int index = hash & mask; ; index = (index + 1) & mask){
+                BeanSetter setter = table[index];
+                if(setter == null){
+                    return null;
                 }
-                Object value  = field.get(object);
-                if(value == null){
-                    continue;
+                if(setter.hash == hash && setter.key.length == length){
+                    byte[] key = setter.key;
+                    int i = 0;
+                    while (i < length && key[i] == buffer[offset + i]){
+                        i++;
+                    }
+                    if(i == length){
+                        return setter;
+                    }
                 }
-                map.put(fieldName, value);
-            }
-        }catch (Exception e){
-            if(e instanceof  RuntimeException){
-                throw  (RuntimeException)e;
-            }else{
-                throw  new RuntimeException(e);
             }
         }
-        return  map;
+    }
+
+    /**
+     * deserializer built once per class, null if class is not a plain bean with no-arg constructor,
+     * then caller should use fastjson
+     * */
+    static BeanDeserializer getBeanDeserializer(Class<?> targetClass){
+        return beanDeserializers.get(targetClass);
+    }
+
+    static int keyHash(byte[] bytes, int offset, int length){
+        int hash = 5381;
+        int end = offset + length;
+        for(int i=offset; i<end; i++){
+            hash = ((hash << 5) + hash) + bytes[i];
+        }
+        return hash ^ (hash >>> 16);
     }
 
 
@@ -110,57 +242,278 @@ class WsonAdapter {
 
     private static final String METHOD_PREFIX_GET = "get";
     private static final String METHOD_PREFIX_IS = "is";
-    private static LruCache<String, List<Method>> methodsCache = new LruCache<>(128);
-    private static LruCache<String, List<Field>> fieldsCache = new LruCache<>(128);
+    private static final String METHOD_PREFIX_SET = "set";
+    private static final MethodHandles.Lookup LOOKUP = MethodHandles.lookup();
+    private static final MethodType GETTER_TYPE = MethodType.methodType(Object.class, Object.class);
     public static LruCache<String, Boolean> specialClass = new LruCache<>(16);
 
+    /**
+     * cached for class whose properties can not be built, ClassValue does not cache a thrown
+     * exception, without it every write would generate accessors again. Error such as
+     * OutOfMemoryError or LinkageError is not a property of the class and is thrown
+     * */
+    private static final BeanProperty[] NOT_BEAN = new BeanProperty[0];
+
+    /**
+     * generated getters hold classes, ClassValue let them unload with the bean class
+     * */
+    private static final ClassValue<BeanProperty[]> beanProperties = new ClassValue<BeanProperty[]>() {
+        @Override
+        protected BeanProperty[] computeValue(Class<?> type) {
+            try {
+                return createBeanProperties(type);
+            }catch (ReflectiveOperationException | LambdaConversionException | RuntimeException e){
+                return NOT_BEAN;
+            }catch (Error e){
+                throw e;
+            }catch (Throwable e){
+                throw new RuntimeException(e);
+            }
+        }
+    };
+
+    private static final ClassValue<BeanDeserializer> beanDeserializers = new ClassValue<BeanDeserializer>() {
+        @Override
+        protected BeanDeserializer computeValue(Class<?> type) {
+            try {
+                return createBeanDeserializer(type);
+            }catch (ReflectiveOperationException | LambdaConversionException | RuntimeException e){
+                return null;
+            }catch (Error e){
+                throw e;
+            }catch (Throwable e){
+                throw new RuntimeException(e);
+            }
+        }
+    };
 
 
-    private static List<Method> getBeanMethod(String key, Class targetClass){
-        List<Method> methods = methodsCache.get(key);
-        if(methods == null){
-            methods = new ArrayList<>();
-            Method[]  allMethods = targetClass.getMethods();
-            for(Method method : allMethods){
-                if(method.getDeclaringClass() == Object.class){
-                    continue;
-                }
-                if( (method.getModifiers() & Modifier.STATIC) != 0){
-                    continue;
-                }
-                if(method.getAnnotation(JSONField.class) != null){
-                    throw new UnsupportedOperationException("getBeanMethod JSONField Annotation Not Handled");
-                }
-                String methodName = method.getName();
-                if(methodName.startsWith(METHOD_PREFIX_GET)
-                        || methodName.startsWith(METHOD_PREFIX_IS)) {
-                    methods.add(method);
-                }
+    private static BeanProperty[] createBeanProperties(Class<?> targetClass) throws Throwable {
+        Map<String, Function<Object, Object>> getters = new TreeMap<>();
+        Map<String, Function<Object, Object>> fields = new TreeMap<>();
+        for(Method method : targetClass.getMethods()){
+            if(method.getDeclaringClass() == Object.class){
+                continue;
+            }
+            if( (method.getModifiers() & Modifier.STATIC) != 0){
+                continue;
+            }
+            if(method.getAnnotation(JSONField.class) != null){
+                throw new UnsupportedOperationException("getBeanMethod JSONField Annotation Not Handled");
+            }
+            String methodName = method.getName();
+            String name;
+            if(methodName.startsWith(METHOD_PREFIX_GET)){
+                name = methodName.substring(3);
+            }else if(methodName.startsWith(METHOD_PREFIX_IS)){
+                name = methodName.substring(2);
+            }else{
+                continue;
+            }
+            if(name.isEmpty() || method.getParameterTypes().length != 0){
+                throw new UnsupportedOperationException("getBeanMethod " + methodName + " Not Getter");
+            }
+            if(method.getReturnType() == void.class){
+                continue;
+            }
+            StringBuilder builder = new StringBuilder(name);
+            builder.setCharAt(0, Character.toLowerCase(builder.charAt(0)));
+            name = builder.toString();
+            if(!getters.containsKey(name)){
+                getters.put(name, createGetter(method));
+            }
+        }
+        for(Field field : targetClass.getFields()){
+            if((field.getModifiers() & Modifier.STATIC) != 0){
+                continue;
+            }
+            if(field.getAnnotation(JSONField.class) != null){
+                throw new UnsupportedOperationException("getBeanFields JSONField Annotation Not Handled");
+            }
+            fields.put(field.getName(), createHandleGetter(LOOKUP.unreflectGetter(field)));
+        }
+        Set<String> names = new TreeSet<>(getters.keySet());
+        names.addAll(fields.keySet());
+        BeanProperty[] properties = new BeanProperty[names.size()];
+        int index = 0;
+        for(String name : names){
+            properties[index++] = new BeanProperty(name, getters.get(name), fields.get(name));
+        }
+        return properties;
+    }
+
+    private static BeanDeserializer createBeanDeserializer(Class<?> targetClass) throws Throwable {
+        int modifiers = targetClass.getModifiers();
+        if(targetClass.isInterface() || Modifier.isAbstract(modifiers) || targetClass.isArray()
+                || targetClass.isPrimitive() || targetClass.isEnum()
+                || targetClass.getName().startsWith("java.")){
+            return null;
+        }
+        if(targetClass.isMemberClass() && !Modifier.isStatic(modifiers)){
+            return null;
+        }
+        if(targetClass.getAnnotation(JSONType.class) != null){
+            return null;
+        }
+        Constructor<?> constructor = targetClass.getDeclaredConstructor();
+        if(!Modifier.isPublic(modifiers) || !Modifier.isPublic(constructor.getModifiers())){
+            constructor.setAccessible(true);
+        }
+        Map<String, BeanSetter> setters = new HashMap<>();
+        for(Method method : targetClass.getMethods()){
+            String methodName = method.getName();
+            if(method.getDeclaringClass() == Object.class
+                    || (method.getModifiers() & Modifier.STATIC) != 0
+                    || !methodName.startsWith(METHOD_PREFIX_SET)
+                    || methodName.length() <= 3
+                    || method.getParameterTypes().length != 1){
+                continue;
+            }
+            if(method.getAnnotation(JSONField.class) != null){
+                return null;
+            }
+            StringBuilder builder = new StringBuilder(methodName.substring(3));
+            builder.setCharAt(0, Character.toLowerCase(builder.charAt(0)));
+            String name = builder.toString();
+            if(setters.containsKey(name)){
+                continue;
+            }
+            if(!Modifier.isPublic(method.getDeclaringClass().getModifiers())){
+                method.setAccessible(true);
             }
-            methodsCache.put(key, methods);
+            setters.put(name, new BeanSetter(name, method.getGenericParameterTypes()[0], LOOKUP.unreflect(method)));
         }
-        return methods;
+        for(Field field : targetClass.getFields()){
+            int fieldModifiers = field.getModifiers();
+            if((fieldModifiers & (Modifier.STATIC | Modifier.FINAL)) != 0 || setters.containsKey(field.getName())){
+                continue;
+            }
+            if(field.getAnnotation(JSONField.class) != null){
+                return null;
+            }
+            if(!Modifier.isPublic(field.getDeclaringClass().getModifiers())){
+                field.setAccessible(true);
+            }
+            setters.put(field.getName(), new BeanSetter(field.getName(), field.getGenericType(), LOOKUP.unreflectSetter(field)));
+        }
+        return new BeanDeserializer(LOOKUP.unreflectConstructor(constructor), setters.values());
     }
 
+    private static int kind(Class<?> type){
+        if(type == int.class){
+            return KIND_INT;
+        }else if(type == long.class){
+            return KIND_LONG;
+        }else if(type == double.class){
+            return KIND_DOUBLE;
+        }else if(type == float.class){
+            return KIND_FLOAT;
+        }else if(type == boolean.class){
+            return KIND_BOOLEAN;
+        }else if(type == short.class){
+            return KIND_SHORT;
+        }else if(type == byte.class){
+            return KIND_BYTE;
+        }else if(type == char.class){
+            return KIND_CHAR;
+        }
+        return KIND_OBJECT;
+    }
 
+    /**
+     * getter compiled to Function by LambdaMetafactory, method handle if the generated class can not link it
+     * */
+    @SuppressWarnings("unchecked")
+    private static Function<Object, Object> createGetter(Method method) throws Throwable {
+        MethodHandle handle = LOOKUP.unreflect(method);
+        Class<?> declaringClass = method.getDeclaringClass();
+        Class<?> returnType = method.getReturnType();
+        if(!Modifier.isPublic(declaringClass.getModifiers())
+                || !isVisible(declaringClass) || !isVisible(returnType)){
+            return createHandleGetter(handle);
+        }
+        CallSite site = LambdaMetafactory.metafactory(LOOKUP, "apply",
+                MethodType.methodType(Function.class),
+                GETTER_TYPE,
+                handle,
+                MethodType.methodType(returnType, declaringClass).wrap());
+        return (Function<Object, Object>) site.getTarget().invokeExact();
+    }
 
-    private static  List<Field> getBeanFields(String key, Class targetClass){
-        List<Field> fieldList = fieldsCache.get(key);
-        if(fieldList == null) {
-            Field[] fields = targetClass.getFields();
-            fieldList = new ArrayList<>(fields.length);
-            for(Field field : fields){
-                if((field.getModifiers() & Modifier.STATIC) != 0){
-                    continue;
+    private static Function<Object, Object> createHandleGetter(MethodHandle handle){
+        final MethodHandle getter = handle.asType(GETTER_TYPE);
+        return new Function<Object, Object>() {
+            @Override
+            public Object apply(Object object) {
+                try {
+                    return (Object) getter.invokeExact(object);
+                } catch (RuntimeException e) {
+                    throw e;
+                } catch (Error e) {
+                    throw e;
+                } catch (Throwable e) {
+                    throw new RuntimeException(e);
                 }
-                if(field.getAnnotation(JSONField.class) != null){
-                    throw new UnsupportedOperationException("getBeanFields JSONField Annotation Not Handled");
-                }
-                fieldList.add(field);
             }
-            fieldsCache.put(key, fieldList);
+        };
+    }
+
+    /**
+     * generated class link with this class loader, bean from child loader can not be linked
+     * */
+    private static boolean isVisible(Class<?> type){
+        while (type.isArray()){
+            type = type.getComponentType();
+        }
+        if(type.isPrimitive()){
+            return true;
+        }
+        try {
+            return Class.forName(type.getName(), false, WsonAdapter.class.getClassLoader()) == type;
+        } catch (ClassNotFoundException e) {
+            return false;
+        }
+    }
+
+    /**
+     * wson map key, var length and utf-16 in native byte order
+     * */
+    private static byte[] encodeKey(String name){
+        byte[] chars = utf16Bytes(name);
+        int length = chars.length;
+        int varLength = 1;
+        for(int value = length; (value & 0xFFFFFF80) != 0; value >>>= 7){
+            varLength++;
+        }
+        byte[] key = new byte[varLength + length];
+        int position = 0;
+        int value = length;
+        while ((value & 0xFFFFFF80) != 0) {
+            key[position++] = (byte)((value & 0x7F) | 0x80);
+            value >>>= 7;
+        }
+        key[position++] = (byte)(value & 0x7F);
+        System.arraycopy(chars, 0, key, position, length);
+        return key;
+    }
+
+    /**
+     * utf-16 in native byte order, same as wson string bytes
+     * */
+    private static byte[] utf16Bytes(String name){
+        byte[] bytes = new byte[name.length()*2];
+        boolean littleEndian = ByteOrder.nativeOrder() == ByteOrder.LITTLE_ENDIAN;
+        for(int i=0; i<name.length(); i++){
+            char ch = name.charAt(i);
+            if(littleEndian){
+                bytes[i*2] = (byte) (ch);
+                bytes[i*2 + 1] = (byte) (ch >>> 8);
+            }else{
+                bytes[i*2 + 1] = (byte) (ch);
+                bytes[i*2] = (byte) (ch >>> 8);
+            }
         }
-        return  fieldList;
+        return bytes;
     }
 
 }
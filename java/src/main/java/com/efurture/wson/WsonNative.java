@@ -0,0 +1,148 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package com.efurture.wson;
+
+import com.alibaba.fastjson.JSON;
+
+import java.nio.BufferOverflowException;
+import java.nio.ByteBuffer;
+import java.util.Calendar;
+import java.util.Collection;
+import java.util.Date;
+
+/**
+ * wson codec on top of c core through jni, same result objects as Wson,
+ * direct ByteBuffer is parsed in place, and written by one native copy without byte array.
+ * library wsonjni is built from src/main/jni, use isAvailable before call.
+ */
+public class WsonNative {
+
+    private static final boolean AVAILABLE;
+
+    static {
+        boolean loaded = false;
+        try{
+            System.loadLibrary("wsonjni");
+            loaded = true;
+        }catch (Throwable e){
+            loaded = false;
+        }
+        AVAILABLE = loaded;
+    }
+
+    public static boolean isAvailable(){
+        return AVAILABLE;
+    }
+
+    /**
+     * parse wson data to object, null if data is broken
+     * */
+    public static Object parse(byte[] data){
+        if(data == null){
+            return null;
+        }
+        return nativeParse(data, 0, data.length);
+    }
+
+    /**
+     * parse remaining bytes of buffer, buffer position is not changed
+     * */
+    public static Object parse(ByteBuffer buffer){
+        if(buffer == null){
+            return null;
+        }
+        if(buffer.isDirect()){
+            return nativeParseDirect(buffer, buffer.position(), buffer.remaining());
+        }
+        if(buffer.hasArray()){
+            return nativeParse(buffer.array(), buffer.arrayOffset() + buffer.position(), buffer.remaining());
+        }
+        byte[] data = new byte[buffer.remaining()];
+        buffer.duplicate().get(data);
+        return nativeParse(data, 0, data.length);
+    }
+
+    /**
+     * serialize object to wson data
+     * */
+    public static byte[] toWson(Object object){
+        if(object == null){
+            return null;
+        }
+        return nativeToWson(object);
+    }
+
+    /**
+     * serialize object into buffer at its position and advance position by written bytes
+     * @throws BufferOverflowException if remaining is not enough, buffer is not changed
+     * */
+    public static void toWson(Object object, ByteBuffer out){
+        if(object == null){
+            return;
+        }
+        if(!out.isDirect()){
+            byte[] bts = nativeToWson(object);
+            if(bts != null){
+                out.put(bts);
+            }
+            return;
+        }
+        int length = nativeToWsonDirect(object, out, out.position(), out.remaining());
+        if(length < 0){
+            throw new BufferOverflowException();
+        }
+        out.position(out.position() + length);
+    }
+
+    /**
+     * called from native for objects the c encoder not know, same conversion as Wson.Builder
+     * */
+    static Object adapt(Object object){
+        if(object instanceof Date){
+            return (double)((Date)object).getTime();
+        }
+        if(object instanceof Calendar){
+            return (double)((Calendar)object).getTime().getTime();
+        }
+        if(object instanceof Collection){
+            return ((Collection)object).toArray();
+        }
+        if(object.getClass().isEnum()){
+            return JSON.toJSONString(object);
+        }
+        if(WsonAdapter.specialClass.containsKey(object.getClass().getName())
+                || WsonAdapter.getBeanProperties(object.getClass()) == null){
+            return JSON.toJSON(object);
+        }
+        try{
+            return WsonAdapter.toMap(object);
+        }catch (Exception e){
+            WsonAdapter.specialClass.put(object.getClass().getName(), true);
+            return JSON.toJSON(object);
+        }
+    }
+
+    private static native Object nativeParse(byte[] data, int offset, int length);
+
+    private static native Object nativeParseDirect(ByteBuffer buffer, int offset, int length);
+
+    private static native byte[] nativeToWson(Object object);
+
+    private static native int nativeToWsonDirect(Object object, ByteBuffer out, int offset, int length);
+}
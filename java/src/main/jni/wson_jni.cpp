@@ -0,0 +1,951 @@
+//
+// jni binding of wson c core, decode to and encode from same java objects as Wson.java,
+// JSONObject for map, JSONArray for array, boxed number, String and byte[] for extend type
+//
+
+#include <jni.h>
+#include <string.h>
+#include <vector>
+#include "wson.h"
+
+/**
+ * map key is cached during one parse, most of keys repeat
+ */
+#define WSON_JNI_KEY_CACHE_COUNT 64
+#define WSON_JNI_KEY_CACHE_MAX_LENGTH 64
+/**
+ * deeper value is treated as broken data, like circle reference depth of Wson.java
+ */
+#define WSON_JNI_MAX_DEEP 1024
+
+namespace {
+
+    struct JavaTypes{
+        jclass nativeClass;
+        jmethodID adapt;
+
+        jclass jsonObjectClass;
+        jmethodID jsonObjectInit;
+        jclass jsonArrayClass;
+        jmethodID jsonArrayInit;
+
+        jclass mapClass;
+        jmethodID mapPut;
+        jmethodID mapEntrySet;
+        jclass listClass;
+        jmethodID listAdd;
+        jmethodID listSize;
+        jmethodID listGet;
+        jclass randomAccessClass;
+        jmethodID setIterator;
+        jmethodID iteratorHasNext;
+        jmethodID iteratorNext;
+        jmethodID entryGetKey;
+        jmethodID entryGetValue;
+        jmethodID objectToString;
+
+        jclass stringClass;
+        jclass charSequenceClass;
+        jclass booleanClass;
+        jobject booleanTrue;
+        jobject booleanFalse;
+        jmethodID booleanValue;
+        jclass numberClass;
+        jmethodID numberIntValue;
+        jclass integerClass;
+        jmethodID integerValueOf;
+        jclass longClass;
+        jmethodID longValueOf;
+        jmethodID longValue;
+        jclass floatClass;
+        jmethodID floatValueOf;
+        jmethodID floatValue;
+        jclass doubleClass;
+        jmethodID doubleValueOf;
+        jmethodID doubleValue;
+        jmethodID doubleToString;
+        jclass shortClass;
+        jclass byteClass;
+        jclass bigIntegerClass;
+        jmethodID bigIntegerInit;
+        jclass bigDecimalClass;
+        jmethodID bigDecimalInit;
+        jmethodID bigDecimalDoubleValue;
+
+        jclass objectArrayClass;
+        jclass intArrayClass;
+        jclass longArrayClass;
+        jclass doubleArrayClass;
+        jclass floatArrayClass;
+        jclass booleanArrayClass;
+        jclass shortArrayClass;
+        jclass byteArrayClass;
+    };
+
+    JavaTypes types;
+
+    struct KeyCache{
+        const uint8_t* bytes;
+        uint32_t length;
+        jstring key;
+    };
+
+    struct DecodeContext{
+        JNIEnv* env;
+        wson_buffer* buffer;
+        bool failed;
+        std::vector<jchar> chars;
+        KeyCache keys[WSON_JNI_KEY_CACHE_COUNT];
+    };
+
+    struct EncodeContext{
+        JNIEnv* env;
+        wson_buffer* buffer;
+        bool failed;
+        std::vector<jobject> objectStack;
+    };
+
+    jclass findClass(JNIEnv* env, const char* name){
+        jclass local = env->FindClass(name);
+        if(!local){
+            return nullptr;
+        }
+        jclass global = (jclass)env->NewGlobalRef(local);
+        env->DeleteLocalRef(local);
+        return global;
+    }
+
+    bool initTypes(JNIEnv* env){
+        types.nativeClass = findClass(env, "com/efurture/wson/WsonNative");
+        types.jsonObjectClass = findClass(env, "com/alibaba/fastjson/JSONObject");
+        types.jsonArrayClass = findClass(env, "com/alibaba/fastjson/JSONArray");
+        types.mapClass = findClass(env, "java/util/Map");
+        types.listClass = findClass(env, "java/util/List");
+        types.randomAccessClass = findClass(env, "java/util/RandomAccess");
+        jclass setClass = findClass(env, "java/util/Set");
+        jclass iteratorClass = findClass(env, "java/util/Iterator");
+        jclass entryClass = findClass(env, "java/util/Map$Entry");
+        jclass objectClass = findClass(env, "java/lang/Object");
+        types.stringClass = findClass(env, "java/lang/String");
+        types.charSequenceClass = findClass(env, "java/lang/CharSequence");
+        types.booleanClass = findClass(env, "java/lang/Boolean");
+        types.numberClass = findClass(env, "java/lang/Number");
+        types.integerClass = findClass(env, "java/lang/Integer");
+        types.longClass = findClass(env, "java/lang/Long");
+        types.floatClass = findClass(env, "java/lang/Float");
+        types.doubleClass = findClass(env, "java/lang/Double");
+        types.shortClass = findClass(env, "java/lang/Short");
+        types.byteClass = findClass(env, "java/lang/Byte");
+        types.bigIntegerClass = findClass(env, "java/math/BigInteger");
+        types.bigDecimalClass = findClass(env, "java/math/BigDecimal");
+        types.objectArrayClass = findClass(env, "[Ljava/lang/Object;");
+        types.intArrayClass = findClass(env, "[I");
+        types.longArrayClass = findClass(env, "[J");
+        types.doubleArrayClass = findClass(env, "[D");
+        types.floatArrayClass = findClass(env, "[F");
+        types.booleanArrayClass = findClass(env, "[Z");
+        types.shortArrayClass = findClass(env, "[S");
+        types.byteArrayClass = findClass(env, "[B");
+        if(!types.nativeClass || !types.jsonObjectClass || !types.jsonArrayClass || !types.mapClass
+           || !types.listClass || !types.randomAccessClass || !setClass || !iteratorClass || !entryClass
+           || !objectClass || !types.stringClass || !types.charSequenceClass || !types.booleanClass
+           || !types.numberClass || !types.integerClass || !types.longClass || !types.floatClass
+           || !types.doubleClass || !types.shortClass || !types.byteClass || !types.bigIntegerClass
+           || !types.bigDecimalClass || !types.objectArrayClass || !types.intArrayClass || !types.longArrayClass
+           || !types.doubleArrayClass || !types.floatArrayClass || !types.booleanArrayClass
+           || !types.shortArrayClass || !types.byteArrayClass){
+            return false;
+        }
+        types.adapt = env->GetStaticMethodID(types.nativeClass, "adapt", "(Ljava/lang/Object;)Ljava/lang/Object;");
+        types.jsonObjectInit = env->GetMethodID(types.jsonObjectClass, "<init>", "()V");
+        types.jsonArrayInit = env->GetMethodID(types.jsonArrayClass, "<init>", "(I)V");
+        types.mapPut = env->GetMethodID(types.mapClass, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+        types.mapEntrySet = env->GetMethodID(types.mapClass, "entrySet", "()Ljava/util/Set;");
+        types.listAdd = env->GetMethodID(types.listClass, "add", "(Ljava/lang/Object;)Z");
+        types.listSize = env->GetMethodID(types.listClass, "size", "()I");
+        types.listGet = env->GetMethodID(types.listClass, "get", "(I)Ljava/lang/Object;");
+        types.setIterator = env->GetMethodID(setClass, "iterator", "()Ljava/util/Iterator;");
+        types.iteratorHasNext = env->GetMethodID(iteratorClass, "hasNext", "()Z");
+        types.iteratorNext = env->GetMethodID(iteratorClass, "next", "()Ljava/lang/Object;");
+        types.entryGetKey = env->GetMethodID(entryClass, "getKey", "()Ljava/lang/Object;");
+        types.entryGetValue = env->GetMethodID(entryClass, "getValue", "()Ljava/lang/Object;");
+        types.objectToString = env->GetMethodID(objectClass, "toString", "()Ljava/lang/String;");
+        jfieldID trueField = env->GetStaticFieldID(types.booleanClass, "TRUE", "Ljava/lang/Boolean;");
+        jfieldID falseField = env->GetStaticFieldID(types.booleanClass, "FALSE", "Ljava/lang/Boolean;");
+        types.booleanValue = env->GetMethodID(types.booleanClass, "booleanValue", "()Z");
+        types.numberIntValue = env->GetMethodID(types.numberClass, "intValue", "()I");
+        types.integerValueOf = env->GetStaticMethodID(types.integerClass, "valueOf", "(I)Ljava/lang/Integer;");
+        types.longValueOf = env->GetStaticMethodID(types.longClass, "valueOf", "(J)Ljava/lang/Long;");
+        types.longValue = env->GetMethodID(types.longClass, "longValue", "()J");
+        types.floatValueOf = env->GetStaticMethodID(types.floatClass, "valueOf", "(F)Ljava/lang/Float;");
+        types.floatValue = env->GetMethodID(types.floatClass, "floatValue", "()F");
+        types.doubleValueOf = env->GetStaticMethodID(types.doubleClass, "valueOf", "(D)Ljava/lang/Double;");
+        types.doubleValue = env->GetMethodID(types.doubleClass, "doubleValue", "()D");
+        types.doubleToString = env->GetStaticMethodID(types.doubleClass, "toString", "(D)Ljava/lang/String;");
+        types.bigIntegerInit = env->GetMethodID(types.bigIntegerClass, "<init>", "(Ljava/lang/String;)V");
+        types.bigDecimalInit = env->GetMethodID(types.bigDecimalClass, "<init>", "(Ljava/lang/String;)V");
+        types.bigDecimalDoubleValue = env->GetMethodID(types.bigDecimalClass, "doubleValue", "()D");
+        if(env->ExceptionCheck() || !trueField || !falseField){
+            return false;
+        }
+        jobject booleanTrue = env->GetStaticObjectField(types.booleanClass, trueField);
+        jobject booleanFalse = env->GetStaticObjectField(types.booleanClass, falseField);
+        types.booleanTrue = env->NewGlobalRef(booleanTrue);
+        types.booleanFalse = env->NewGlobalRef(booleanFalse);
+        env->DeleteLocalRef(booleanTrue);
+        env->DeleteLocalRef(booleanFalse);
+        env->DeleteLocalRef(setClass);
+        env->DeleteLocalRef(iteratorClass);
+        env->DeleteLocalRef(entryClass);
+        env->DeleteLocalRef(objectClass);
+        return true;
+    }
+
+    inline uint32_t remaining(wson_buffer* buffer){
+        return buffer->position < buffer->length ? buffer->length - buffer->position : 0;
+    }
+
+    /**
+     * varint with bound check, java data may come from any source
+     */
+    inline bool nextUInt(DecodeContext& context, uint32_t& value){
+        wson_buffer* buffer = context.buffer;
+        const uint8_t* data = (const uint8_t*)buffer->data;
+        value = 0;
+        for(int shift=0; shift<35; shift+=7){
+            if(buffer->position >= buffer->length){
+                context.failed = true;
+                return false;
+            }
+            uint8_t byte = data[buffer->position++];
+            value |= ((uint32_t)(byte & 0x7F)) << shift;
+            if((byte & 0x80) == 0){
+                return true;
+            }
+        }
+        context.failed = true;
+        return false;
+    }
+
+    inline const uint8_t* nextBytes(DecodeContext& context, uint32_t length){
+        wson_buffer* buffer = context.buffer;
+        if(length > remaining(buffer)){
+            context.failed = true;
+            return nullptr;
+        }
+        const uint8_t* bytes = (const uint8_t*)buffer->data + buffer->position;
+        buffer->position += length;
+        return bytes;
+    }
+
+    /**
+     * wson string is utf-16 in native order, copied to aligned chars for NewString
+     */
+    jstring newString(DecodeContext& context, const uint8_t* bytes, uint32_t length){
+        uint32_t count = length/sizeof(jchar);
+        if(context.chars.size() < count){
+            context.chars.resize(count);
+        }
+        memcpy(context.chars.data(), bytes, count*sizeof(jchar));
+        return context.env->NewString(context.chars.data(), count);
+    }
+
+    jstring nextString(DecodeContext& context){
+        uint32_t length;
+        if(!nextUInt(context, length)){
+            return nullptr;
+        }
+        const uint8_t* bytes = nextBytes(context, length);
+        if(!bytes){
+            return nullptr;
+        }
+        return newString(context, bytes, length);
+    }
+
+    /**
+     * return cached key, caller must not delete it, otherwise key is new local ref
+     */
+    jstring nextKey(DecodeContext& context, bool& cached){
+        cached = false;
+        uint32_t length;
+        if(!nextUInt(context, length)){
+            return nullptr;
+        }
+        const uint8_t* bytes = nextBytes(context, length);
+        if(!bytes){
+            return nullptr;
+        }
+        if(length > WSON_JNI_KEY_CACHE_MAX_LENGTH*sizeof(jchar)){
+            return newString(context, bytes, length);
+        }
+        uint32_t hash = length;
+        for(uint32_t i=0; i<length; i++){
+            hash = hash*31 + bytes[i];
+        }
+        KeyCache& cache = context.keys[hash & (WSON_JNI_KEY_CACHE_COUNT - 1)];
+        if(cache.key && cache.length == length && memcmp(cache.bytes, bytes, length) == 0){
+            cached = true;
+            return cache.key;
+        }
+        jstring key = newString(context, bytes, length);
+        if(!key){
+            return nullptr;
+        }
+        if(cache.key){
+            context.env->DeleteLocalRef(cache.key);
+        }
+        cache.bytes = bytes;
+        cache.length = length;
+        cache.key = key;
+        cached = true;
+        return key;
+    }
+
+    jobject nextObject(DecodeContext& context, uint32_t deep);
+
+    jobject nextMap(DecodeContext& context, uint32_t deep){
+        JNIEnv* env = context.env;
+        uint32_t size;
+        if(!nextUInt(context, size)){
+            return nullptr;
+        }
+        jobject map = env->NewObject(types.jsonObjectClass, types.jsonObjectInit);
+        if(!map){
+            context.failed = true;
+            return nullptr;
+        }
+        for(uint32_t i=0; i<size; i++){
+            bool cached;
+            jstring key = nextKey(context, cached);
+            if(!key){
+                context.failed = true;
+                break;
+            }
+            jobject value = nextObject(context, deep + 1);
+            if(context.failed){
+                if(!cached){
+                    env->DeleteLocalRef(key);
+                }
+                break;
+            }
+            jobject previous = env->CallObjectMethod(map, types.mapPut, key, value);
+            if(previous){
+                env->DeleteLocalRef(previous);
+            }
+            if(value){
+                env->DeleteLocalRef(value);
+            }
+            if(!cached){
+                env->DeleteLocalRef(key);
+            }
+            if(env->ExceptionCheck()){
+                context.failed = true;
+                break;
+            }
+        }
+        return map;
+    }
+
+    jobject nextArray(DecodeContext& context, uint32_t deep){
+        JNIEnv* env = context.env;
+        uint32_t length;
+        if(!nextUInt(context, length)){
+            return nullptr;
+        }
+        /** every element take at least one byte, so bad length can not over allocate */
+        uint32_t capacity = length < remaining(context.buffer) ? length : remaining(context.buffer);
+        jobject array = env->NewObject(types.jsonArrayClass, types.jsonArrayInit, (jint)capacity);
+        if(!array){
+            context.failed = true;
+            return nullptr;
+        }
+        for(uint32_t i=0; i<length; i++){
+            jobject value = nextObject(context, deep + 1);
+            if(context.failed){
+                break;
+            }
+            env->CallBooleanMethod(array, types.listAdd, value);
+            if(value){
+                env->DeleteLocalRef(value);
+            }
+            if(env->ExceptionCheck()){
+                context.failed = true;
+                break;
+            }
+        }
+        return array;
+    }
+
+    jobject nextObject(DecodeContext& context, uint32_t deep){
+        JNIEnv* env = context.env;
+        wson_buffer* buffer = context.buffer;
+        if(deep > WSON_JNI_MAX_DEEP || !wson_has_next(buffer)){
+            context.failed = true;
+            return nullptr;
+        }
+        uint8_t type = (uint8_t)wson_next_type(buffer);
+        jobject object = nullptr;
+        switch (type) {
+            case WSON_STRING_TYPE:
+                object = nextString(context);
+                break;
+            case WSON_NUMBER_INT_TYPE:{
+                    uint32_t raw;
+                    if(nextUInt(context, raw)){
+                        int32_t num = (int32_t)((raw >> 1) ^ (~(raw & 1) + 1));
+                        object = env->CallStaticObjectMethod(types.integerClass, types.integerValueOf, (jint)num);
+                    }
+                }
+                break;
+            case WSON_NUMBER_FLOAT_TYPE:
+                if(nextBytes(context, sizeof(float))){
+                    buffer->position -= sizeof(float);
+                    object = env->CallStaticObjectMethod(types.floatClass, types.floatValueOf, (jfloat)wson_next_float(buffer));
+                }
+                break;
+            case WSON_NUMBER_DOUBLE_TYPE:
+                if(nextBytes(context, sizeof(double))){
+                    buffer->position -= sizeof(double);
+                    double number = wson_next_double(buffer);
+                    /** like Wson.java, big integral double is read as long */
+                    if(number > 2147483647.0 && number < 9223372036854775807.0 && number == (double)(int64_t)number){
+                        object = env->CallStaticObjectMethod(types.longClass, types.longValueOf, (jlong)number);
+                    }else{
+                        object = env->CallStaticObjectMethod(types.doubleClass, types.doubleValueOf, (jdouble)number);
+                    }
+                }
+                break;
+            case WSON_NUMBER_LONG_TYPE:
+                if(nextBytes(context, sizeof(int64_t))){
+                    buffer->position -= sizeof(int64_t);
+                    object = env->CallStaticObjectMethod(types.longClass, types.longValueOf, (jlong)wson_next_long(buffer));
+                }
+                break;
+            case WSON_NUMBER_BIG_INT_TYPE:
+            case WSON_NUMBER_BIG_DECIMAL_TYPE:{
+                    jstring text = nextString(context);
+                    if(text){
+                        if(type == WSON_NUMBER_BIG_INT_TYPE){
+                            object = env->NewObject(types.bigIntegerClass, types.bigIntegerInit, text);
+                        }else{
+                            object = env->NewObject(types.bigDecimalClass, types.bigDecimalInit, text);
+                        }
+                        env->DeleteLocalRef(text);
+                    }
+                }
+                break;
+            case WSON_BOOLEAN_TYPE_TRUE:
+                return env->NewLocalRef(types.booleanTrue);
+            case WSON_BOOLEAN_TYPE_FALSE:
+                return env->NewLocalRef(types.booleanFalse);
+            case WSON_NULL_TYPE:
+                return nullptr;
+            case WSON_MAP_TYPE:
+                return nextMap(context, deep);
+            case WSON_ARRAY_TYPE:
+                return nextArray(context, deep);
+            case WSON_EXTEND_TYPE:{
+                    uint32_t length;
+                    const uint8_t* bytes = nextUInt(context, length) ? nextBytes(context, length) : nullptr;
+                    if(bytes){
+                        jbyteArray array = env->NewByteArray(length);
+                        if(array){
+                            env->SetByteArrayRegion(array, 0, length, (const jbyte*)bytes);
+                        }
+                        object = array;
+                    }
+                }
+                break;
+            default:
+                context.failed = true;
+                return nullptr;
+        }
+        if(!object || env->ExceptionCheck()){
+            context.failed = true;
+        }
+        return object;
+    }
+
+    /**
+     * like Wson.parse, broken data return null, java exception is printed and cleared
+     */
+    jobject parse(JNIEnv* env, void* data, jint offset, jint length){
+        if(!data || offset < 0 || length <= 0){
+            return nullptr;
+        }
+        if(env->EnsureLocalCapacity(WSON_JNI_KEY_CACHE_COUNT + 64) != JNI_OK){
+            return nullptr;
+        }
+        wson_buffer buffer = {(uint8_t*)data + offset, 0, (uint32_t)length};
+        DecodeContext context;
+        context.env = env;
+        context.buffer = &buffer;
+        context.failed = false;
+        memset(context.keys, 0, sizeof(context.keys));
+        jobject object = nextObject(context, 0);
+        if(!context.failed){
+            return object;
+        }
+        if(env->ExceptionCheck()){
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+        }
+        if(object){
+            env->DeleteLocalRef(object);
+        }
+        return nullptr;
+    }
+
+    void pushObject(EncodeContext& context, jobject object);
+
+    inline bool checkException(EncodeContext& context){
+        if(context.env->ExceptionCheck()){
+            context.failed = true;
+        }
+        return context.failed;
+    }
+
+    /**
+     * java string is utf-16, same as wson string, chars are pushed without convert
+     */
+    void pushString(EncodeContext& context, jstring value, bool key){
+        JNIEnv* env = context.env;
+        jsize length = env->GetStringLength(value);
+        const jchar* chars = env->GetStringCritical(value, nullptr);
+        if(!chars){
+            context.failed = true;
+            return;
+        }
+        if(key){
+            wson_push_property(context.buffer, chars, length*sizeof(jchar));
+        }else{
+            wson_push_type_string(context.buffer, chars, length*sizeof(jchar));
+        }
+        env->ReleaseStringCritical(value, chars);
+    }
+
+    void pushToString(EncodeContext& context, jobject object, uint8_t type){
+        jstring text = (jstring)context.env->CallObjectMethod(object, types.objectToString);
+        if(checkException(context) || !text){
+            context.failed = true;
+            return;
+        }
+        if(type == WSON_STRING_TYPE){
+            pushString(context, text, false);
+        }else{
+            wson_push_type(context.buffer, type);
+            pushString(context, text, true);
+        }
+        context.env->DeleteLocalRef(text);
+    }
+
+    bool isSameString(JNIEnv* env, jstring a, jstring b){
+        jsize length = env->GetStringLength(a);
+        if(length != env->GetStringLength(b)){
+            return false;
+        }
+        std::vector<jchar> chars(length*2);
+        env->GetStringRegion(a, 0, length, chars.data());
+        env->GetStringRegion(b, 0, length, chars.data() + length);
+        return memcmp(chars.data(), chars.data() + length, length*sizeof(jchar)) == 0;
+    }
+
+    /**
+     * same number type as Wson.Builder.writeNumber
+     */
+    void pushNumber(EncodeContext& context, jobject number){
+        JNIEnv* env = context.env;
+        wson_buffer* buffer = context.buffer;
+        if(env->IsInstanceOf(number, types.integerClass) || env->IsInstanceOf(number, types.shortClass)
+           || env->IsInstanceOf(number, types.byteClass)){
+            jint value = env->CallIntMethod(number, types.numberIntValue);
+            if(!checkException(context)){
+                wson_push_type_int(buffer, value);
+            }
+            return;
+        }
+        if(env->IsInstanceOf(number, types.floatClass)){
+            jfloat value = env->CallFloatMethod(number, types.floatValue);
+            if(!checkException(context)){
+                wson_push_type_float(buffer, value);
+            }
+            return;
+        }
+        if(env->IsInstanceOf(number, types.doubleClass)){
+            jdouble value = env->CallDoubleMethod(number, types.doubleValue);
+            if(!checkException(context)){
+                wson_push_type_double(buffer, value);
+            }
+            return;
+        }
+        if(env->IsInstanceOf(number, types.longClass)){
+            jlong value = env->CallLongMethod(number, types.longValue);
+            if(!checkException(context)){
+                wson_push_type_long(buffer, value);
+            }
+            return;
+        }
+        if(env->IsInstanceOf(number, types.bigIntegerClass)){
+            pushToString(context, number, WSON_NUMBER_BIG_INT_TYPE);
+            return;
+        }
+        if(env->IsInstanceOf(number, types.bigDecimalClass)){
+            jdouble value = env->CallDoubleMethod(number, types.bigDecimalDoubleValue);
+            if(checkException(context)){
+                return;
+            }
+            jstring text = (jstring)env->CallObjectMethod(number, types.objectToString);
+            jstring doubleText = (jstring)env->CallStaticObjectMethod(types.doubleClass, types.doubleToString, value);
+            if(!checkException(context) && text && doubleText){
+                if(isSameString(env, text, doubleText)){
+                    wson_push_type_double(buffer, value);
+                }else{
+                    wson_push_type(buffer, WSON_NUMBER_BIG_DECIMAL_TYPE);
+                    pushString(context, text, true);
+                }
+            }
+            env->DeleteLocalRef(text);
+            env->DeleteLocalRef(doubleText);
+            return;
+        }
+        pushToString(context, number, WSON_STRING_TYPE);
+    }
+
+    /**
+     * null value is skipped like Wson.WriteMapNullValue false, size is patched after entries
+     */
+    /**
+     * two passes like Wson.Builder.writeMap, first count non null values, so map size is minimal varint
+     * and bytes are same as java encoder
+     * */
+    void pushMap(EncodeContext& context, jobject map){
+        JNIEnv* env = context.env;
+        jobject entries = env->CallObjectMethod(map, types.mapEntrySet);
+        if(checkException(context) || !entries){
+            context.failed = true;
+            return;
+        }
+        uint32_t size = 0;
+        jobject iterator = env->CallObjectMethod(entries, types.setIterator);
+        if(checkException(context) || !iterator){
+            context.failed = true;
+            env->DeleteLocalRef(entries);
+            return;
+        }
+        while(env->CallBooleanMethod(iterator, types.iteratorHasNext)){
+            jobject entry = env->CallObjectMethod(iterator, types.iteratorNext);
+            if(checkException(context)){
+                break;
+            }
+            jobject value = env->CallObjectMethod(entry, types.entryGetValue);
+            if(checkException(context)){
+                break;
+            }
+            if(value){
+                size++;
+                env->DeleteLocalRef(value);
+            }
+            env->DeleteLocalRef(entry);
+        }
+        env->DeleteLocalRef(iterator);
+        if(checkException(context)){
+            env->DeleteLocalRef(entries);
+            return;
+        }
+        iterator = env->CallObjectMethod(entries, types.setIterator);
+        if(checkException(context) || !iterator){
+            context.failed = true;
+            env->DeleteLocalRef(entries);
+            return;
+        }
+        wson_push_type_map(context.buffer, size);
+        uint32_t written = 0;
+        while(!context.failed && env->CallBooleanMethod(iterator, types.iteratorHasNext)){
+            jobject entry = env->CallObjectMethod(iterator, types.iteratorNext);
+            if(checkException(context)){
+                break;
+            }
+            jobject value = env->CallObjectMethod(entry, types.entryGetValue);
+            if(value){
+                jobject key = env->CallObjectMethod(entry, types.entryGetKey);
+                jstring name = key ? (jstring)env->CallObjectMethod(key, types.objectToString) : nullptr;
+                if(checkException(context) || !name){
+                    context.failed = true;
+                    break;
+                }
+                pushString(context, name, true);
+                pushObject(context, value);
+                written++;
+                env->DeleteLocalRef(name);
+                env->DeleteLocalRef(key);
+                env->DeleteLocalRef(value);
+            }
+            env->DeleteLocalRef(entry);
+            if(checkException(context)){
+                break;
+            }
+        }
+        checkException(context);
+        /** map changed between passes, size written is wrong */
+        if(written != size){
+            context.failed = true;
+        }
+        env->DeleteLocalRef(iterator);
+        env->DeleteLocalRef(entries);
+    }
+
+    void pushList(EncodeContext& context, jobject list){
+        JNIEnv* env = context.env;
+        jint size = env->CallIntMethod(list, types.listSize);
+        if(checkException(context)){
+            return;
+        }
+        wson_push_type_array(context.buffer, size);
+        for(jint i=0; i<size && !context.failed; i++){
+            jobject value = env->CallObjectMethod(list, types.listGet, i);
+            if(checkException(context)){
+                return;
+            }
+            pushObject(context, value);
+            env->DeleteLocalRef(value);
+        }
+    }
+
+    void pushObjectArray(EncodeContext& context, jobjectArray array){
+        JNIEnv* env = context.env;
+        jsize length = env->GetArrayLength(array);
+        wson_push_type_array(context.buffer, length);
+        for(jsize i=0; i<length && !context.failed; i++){
+            jobject value = env->GetObjectArrayElement(array, i);
+            if(checkException(context)){
+                return;
+            }
+            pushObject(context, value);
+            env->DeleteLocalRef(value);
+        }
+    }
+
+    /**
+     * elements are pushed inside critical region, no jni call between get and release
+     */
+    bool pushPrimitiveArray(EncodeContext& context, jobject array){
+        JNIEnv* env = context.env;
+        wson_buffer* buffer = context.buffer;
+        int kind = 0;
+        if(env->IsInstanceOf(array, types.intArrayClass)){
+            kind = 1;
+        }else if(env->IsInstanceOf(array, types.longArrayClass)){
+            kind = 2;
+        }else if(env->IsInstanceOf(array, types.doubleArrayClass)){
+            kind = 3;
+        }else if(env->IsInstanceOf(array, types.floatArrayClass)){
+            kind = 4;
+        }else if(env->IsInstanceOf(array, types.booleanArrayClass)){
+            kind = 5;
+        }else if(env->IsInstanceOf(array, types.shortArrayClass)){
+            kind = 6;
+        }else if(env->IsInstanceOf(array, types.byteArrayClass)){
+            kind = 7;
+        }else{
+            return false;
+        }
+        jsize length = env->GetArrayLength((jarray)array);
+        wson_push_type_array(buffer, length);
+        void* elements = env->GetPrimitiveArrayCritical((jarray)array, nullptr);
+        if(!elements){
+            context.failed = true;
+            return true;
+        }
+        for(jsize i=0; i<length; i++){
+            switch (kind) {
+                case 1:
+                    wson_push_type_int(buffer, ((jint*)elements)[i]);
+                    break;
+                case 2:
+                    wson_push_type_long(buffer, ((jlong*)elements)[i]);
+                    break;
+                case 3:
+                    wson_push_type_double(buffer, ((jdouble*)elements)[i]);
+                    break;
+                case 4:
+                    wson_push_type_float(buffer, ((jfloat*)elements)[i]);
+                    break;
+                case 5:
+                    wson_push_type_boolean(buffer, ((jboolean*)elements)[i]);
+                    break;
+                case 6:
+                    wson_push_type_int(buffer, ((jshort*)elements)[i]);
+                    break;
+                default:
+                    wson_push_type_int(buffer, ((jbyte*)elements)[i]);
+                    break;
+            }
+        }
+        env->ReleasePrimitiveArrayCritical((jarray)array, elements, JNI_ABORT);
+        return true;
+    }
+
+    /**
+     * circle reference is pushed as null, same as Wson.Builder
+     */
+    bool enterObject(EncodeContext& context, jobject object){
+        for(jobject visited : context.objectStack){
+            if(context.env->IsSameObject(visited, object)){
+                wson_push_type_null(context.buffer);
+                return false;
+            }
+        }
+        if(context.objectStack.size() >= WSON_JNI_MAX_DEEP){
+            context.failed = true;
+            return false;
+        }
+        context.objectStack.push_back(object);
+        return true;
+    }
+
+    void pushObject(EncodeContext& context, jobject object){
+        JNIEnv* env = context.env;
+        wson_buffer* buffer = context.buffer;
+        if(context.failed){
+            return;
+        }
+        if(!object){
+            wson_push_type_null(buffer);
+            return;
+        }
+        if(env->IsInstanceOf(object, types.stringClass)){
+            pushString(context, (jstring)object, false);
+            return;
+        }
+        if(env->IsInstanceOf(object, types.charSequenceClass)){
+            pushToString(context, object, WSON_STRING_TYPE);
+            return;
+        }
+        if(env->IsInstanceOf(object, types.numberClass)){
+            pushNumber(context, object);
+            return;
+        }
+        if(env->IsInstanceOf(object, types.booleanClass)){
+            jboolean value = env->CallBooleanMethod(object, types.booleanValue);
+            if(!checkException(context)){
+                wson_push_type_boolean(buffer, value ? 1 : 0);
+            }
+            return;
+        }
+        if(!enterObject(context, object)){
+            return;
+        }
+        if(env->IsInstanceOf(object, types.mapClass)){
+            pushMap(context, object);
+        }else if(env->IsInstanceOf(object, types.listClass) && env->IsInstanceOf(object, types.randomAccessClass)){
+            pushList(context, object);
+        }else if(env->IsInstanceOf(object, types.objectArrayClass)){
+            pushObjectArray(context, (jobjectArray)object);
+        }else if(!pushPrimitiveArray(context, object)){
+            /** date, collection, enum and bean are converted in java, like Wson.Builder */
+            jobject adapted = env->CallStaticObjectMethod(types.nativeClass, types.adapt, object);
+            if(!checkException(context)){
+                pushObject(context, adapted);
+            }
+            env->DeleteLocalRef(adapted);
+        }
+        context.objectStack.pop_back();
+    }
+
+    /**
+     * encoded buffer, or null with pending java exception which is left to caller
+     */
+    wson_buffer* toWson(JNIEnv* env, jobject object){
+        EncodeContext context;
+        context.env = env;
+        context.buffer = wson_buffer_new();
+        context.failed = false;
+        pushObject(context, object);
+        if(context.failed){
+            if(!env->ExceptionCheck()){
+                jclass exceptionClass = env->FindClass("java/lang/IllegalArgumentException");
+                if(exceptionClass){
+                    env->ThrowNew(exceptionClass, "wson unsupported object, null map key or too deep");
+                }
+            }
+            wson_buffer_free(context.buffer);
+            return nullptr;
+        }
+        return context.buffer;
+    }
+}
+
+extern "C" {
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved){
+    JNIEnv* env = nullptr;
+    if(vm->GetEnv((void**)&env, JNI_VERSION_1_6) != JNI_OK){
+        return JNI_ERR;
+    }
+    if(!initTypes(env)){
+        return JNI_ERR;
+    }
+    return JNI_VERSION_1_6;
+}
+
+JNIEXPORT jobject JNICALL Java_com_efurture_wson_WsonNative_nativeParse(JNIEnv* env, jclass type, jbyteArray data, jint offset, jint length){
+    jsize size = env->GetArrayLength(data);
+    if(offset < 0 || length <= 0 || offset > size - length){
+        return nullptr;
+    }
+    /** only the parsed range is copied, GetByteArrayElements may copy whole array */
+    std::vector<jbyte> bytes(length);
+    env->GetByteArrayRegion(data, offset, length, bytes.data());
+    if(env->ExceptionCheck()){
+        return nullptr;
+    }
+    return parse(env, bytes.data(), 0, length);
+}
+
+JNIEXPORT jobject JNICALL Java_com_efurture_wson_WsonNative_nativeParseDirect(JNIEnv* env, jclass type, jobject buffer, jint offset, jint length){
+    void* data = env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if(!data || offset < 0 || length <= 0 || offset > capacity - length){
+        return nullptr;
+    }
+    return parse(env, data, offset, length);
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_efurture_wson_WsonNative_nativeToWson(JNIEnv* env, jclass type, jobject object){
+    wson_buffer* buffer = toWson(env, object);
+    if(!buffer){
+        return nullptr;
+    }
+    jbyteArray bytes = env->NewByteArray(buffer->position);
+    if(bytes){
+        env->SetByteArrayRegion(bytes, 0, buffer->position, (const jbyte*)buffer->data);
+    }
+    wson_buffer_free(buffer);
+    return bytes;
+}
+
+/**
+ * return bytes written at offset, -1 if capacity is not enough, 0 with pending exception if encode failed.
+ * encoded in native buffer first, as wson buffer grows by realloc, then copied once into direct buffer
+ */
+JNIEXPORT jint JNICALL Java_com_efurture_wson_WsonNative_nativeToWsonDirect(JNIEnv* env, jclass type, jobject object, jobject out, jint offset, jint capacity){
+    uint8_t* data = (uint8_t*)env->GetDirectBufferAddress(out);
+    jlong outCapacity = env->GetDirectBufferCapacity(out);
+    if(!data || offset < 0 || capacity < 0 || offset > outCapacity - capacity){
+        return -1;
+    }
+    wson_buffer* buffer = toWson(env, object);
+    if(!buffer){
+        return 0;
+    }
+    jint length = buffer->position;
+    if(length > capacity){
+        length = -1;
+    }else{
+        memcpy(data + offset, buffer->data, length);
+    }
+    wson_buffer_free(buffer);
+    return length;
+}
+
+}
@@ -46,6 +46,45 @@ public class ObjectToMapTest extends TestCase {
     }
 
 
+    public void testBeanSerializer() throws InvocationTargetException, IllegalAccessException {
+        User user = new User();
+        user.name = "中国";
+        user.age = 10;
+        user.type = true;
+        user.next = new User();
+        user.next.name = "Next中国";
+        Map parsed = (Map) Wson.parse(Wson.toWson(user));
+        Map expected = toMap(user);
+        expected.put("next", toMap(user.next));
+        assertEquals(expected, parsed);
+        assertEquals("base", parsed.get("base"));
+        assertEquals(10, parsed.get("age"));
+        assertEquals(true, parsed.get("type"));
+        assertFalse(parsed.containsKey("country"));
+    }
+
+    public void testBeanSerializerFallback(){
+        IndexBean bean = new IndexBean();
+        Map parsed = (Map) Wson.parse(Wson.toWson(bean));
+        assertEquals(JSON.toJSON(bean), parsed);
+        /** failure is cached with the class, later writes take fallback directly */
+        for(int i=0; i<3; i++){
+            assertEquals(parsed, Wson.parse(Wson.toWson(bean)));
+        }
+    }
+
+    /**
+     * getter with parameter is not plain bean, wson fallback to fastjson
+     * */
+    public static class IndexBean {
+        public String name = "index";
+
+        public String getItem(int index){
+            return name + index;
+        }
+    }
+
+
     private Object mapToObject(Map map, Object targetClass){
         return  null;
     }
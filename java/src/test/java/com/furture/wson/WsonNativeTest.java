@@ -0,0 +1,114 @@
+package com.furture.wson;
+
+import com.alibaba.fastjson.JSON;
+import com.efurture.wson.Wson;
+import com.efurture.wson.WsonNative;
+import junit.framework.TestCase;
+import org.junit.Assert;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.math.BigDecimal;
+import java.math.BigInteger;
+import java.nio.BufferOverflowException;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * jni codec must read and write same bytes as Wson,
+ * wsonjni is built from src/main/jni by gradle test, fails when it is not loaded
+ */
+public class WsonNativeTest extends TestCase {
+
+    @Override
+    protected void setUp() throws Exception {
+        super.setUp();
+        assertTrue("wsonjni not loaded, build it with gradle buildWsonJni", WsonNative.isAvailable());
+    }
+
+
+    public void testSameBytes() throws IOException {
+        String[] files = {"/media.json", "/weex.json", "/data/cart.json", "/data/trade.json"};
+        for(String file : files){
+            Object map = JSON.parse(readFile(file));
+            byte[] bts = Wson.toWson(map);
+            Assert.assertArrayEquals(bts, WsonNative.toWson(map));
+            Assert.assertEquals(Wson.parse(bts), WsonNative.parse(bts));
+        }
+    }
+
+    public void testNumbers(){
+        Map<String, Object> map = new HashMap<>();
+        map.put("int", -100);
+        map.put("long", Long.MAX_VALUE);
+        map.put("double", 0.5);
+        map.put("float", 1.5f);
+        map.put("bigLong", (double)Integer.MAX_VALUE + 10);
+        map.put("bigInteger", new BigInteger("12345678901234567890"));
+        map.put("bigDecimal", new BigDecimal("1.00000000000000000001"));
+        map.put("short", (short)3);
+        map.put("null", null);
+        byte[] bts = WsonNative.toWson(map);
+        Assert.assertArrayEquals(Wson.toWson(map), bts);
+        Assert.assertEquals(Wson.parse(bts), WsonNative.parse(bts));
+    }
+
+    public void testArraysAndCircle(){
+        List<Object> list = new ArrayList<>();
+        list.add(new int[]{1, 2, 3});
+        list.add(new double[]{1.5, 2.5});
+        list.add(new String[]{"a", "中文"});
+        list.add(new boolean[]{true, false});
+        list.add(list);
+        byte[] bts = WsonNative.toWson(list);
+        Assert.assertArrayEquals(Wson.toWson(list), bts);
+        Assert.assertEquals(Wson.parse(bts), WsonNative.parse(bts));
+    }
+
+    public void testDirectBuffer() throws IOException {
+        Object map = JSON.parse(readFile("/media.json"));
+        byte[] bts = Wson.toWson(map);
+        ByteBuffer out = ByteBuffer.allocateDirect(bts.length + 8);
+        out.position(4);
+        WsonNative.toWson(map, out);
+        Assert.assertEquals(bts.length + 4, out.position());
+
+        out.flip();
+        out.position(4);
+        Assert.assertEquals(Wson.parse(bts), WsonNative.parse(out));
+        Assert.assertEquals(4, out.position());
+
+        ByteBuffer small = ByteBuffer.allocateDirect(bts.length - 1);
+        try{
+            WsonNative.toWson(map, small);
+            fail("small buffer must overflow");
+        }catch (BufferOverflowException e){
+            Assert.assertEquals(0, small.position());
+        }
+    }
+
+    public void testBrokenData(){
+        byte[] bts = Wson.toWson(JSON.parse("{\"name\":\"hello world\",\"list\":[1,2,3]}"));
+        for(int length=1; length<bts.length; length++){
+            byte[] broken = new byte[length];
+            System.arraycopy(bts, 0, broken, 0, length);
+            Assert.assertNull(WsonNative.parse(broken));
+        }
+    }
+
+
+    private String readFile(String file) throws IOException {
+        ByteArrayOutputStream outputStream = new ByteArrayOutputStream(1024);
+        InputStream inputStream = this.getClass().getResourceAsStream(file);
+        byte[] buffer = new byte[1024];
+        int length = 0;
+        while ((length = inputStream.read(buffer)) >=  0){
+            outputStream.write(buffer, 0, length);
+        }
+        return  new String(outputStream.toByteArray());
+    }
+}
@@ -0,0 +1,97 @@
+package com.furture.wson;
+
+import com.alibaba.fastjson.JSON;
+import com.efurture.wson.Wson;
+import junit.framework.TestCase;
+import org.junit.Assert;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InputStream;
+import java.nio.ByteBuffer;
+import java.nio.channels.Channels;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * ByteBuffer parse, stream reader and writer must be same bytes and objects as byte array api
+ */
+public class WsonStreamTest extends TestCase {
+
+
+    public void testParseByteBuffer() throws IOException {
+        Object map = JSON.parse(readFile("/media.json"));
+        byte[] bts = Wson.toWson(map);
+
+        ByteBuffer heap = ByteBuffer.wrap(bts);
+        Assert.assertEquals(Wson.parse(bts), Wson.parse(heap));
+        Assert.assertEquals(bts.length, heap.position());
+
+        ByteBuffer direct = ByteBuffer.allocateDirect(bts.length*2);
+        direct.put(bts);
+        direct.put(bts);
+        direct.flip();
+        Assert.assertEquals(Wson.parse(bts), Wson.parse(direct));
+        Assert.assertEquals(Wson.parse(bts), Wson.parse(direct));
+        Assert.assertFalse(direct.hasRemaining());
+    }
+
+    public void testParseBrokenByteBuffer(){
+        byte[] bts = Wson.toWson(JSON.parse("{\"name\":\"hello world\",\"list\":[1,2,3]}"));
+        ByteBuffer buffer = ByteBuffer.allocateDirect(bts.length - 1);
+        buffer.put(bts, 0, bts.length - 1);
+        buffer.flip();
+        Assert.assertNull(Wson.parse(buffer));
+        Assert.assertEquals(0, buffer.position());
+    }
+
+    public void testWriterAndReader() throws IOException {
+        Object media = JSON.parse(readFile("/media.json"));
+        Map<String, Object> large = new HashMap<>();
+        StringBuilder builder = new StringBuilder();
+        for(int i=0; i<20000; i++){
+            builder.append((char)('a' + i%26));
+            builder.append('中');
+        }
+        large.put("text", builder.toString());
+        large.put("media", media);
+
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        Wson.Writer writer = Wson.newWriter(out);
+        writer.write(media);
+        writer.write(large);
+        writer.write(null);
+        writer.close();
+
+        ByteArrayOutputStream expected = new ByteArrayOutputStream();
+        expected.write(Wson.toWson(media));
+        expected.write(Wson.toWson(large));
+        expected.write('0');
+        Assert.assertArrayEquals(expected.toByteArray(), out.toByteArray());
+
+        Wson.Reader reader = Wson.newReader(Channels.newChannel(new ByteArrayInputStream(out.toByteArray())));
+        Assert.assertEquals(Wson.parse(Wson.toWson(media)), reader.read());
+        Assert.assertEquals(Wson.parse(Wson.toWson(large)), reader.read());
+        Assert.assertNull(reader.read());
+        try{
+            reader.read();
+            fail("stream end must throw");
+        }catch (EOFException e){
+        }
+        reader.close();
+    }
+
+
+    private String readFile(String file) throws IOException {
+        ByteArrayOutputStream outputStream = new ByteArrayOutputStream(1024);
+        InputStream inputStream = this.getClass().getResourceAsStream(file);
+        byte[] buffer = new byte[1024];
+        int length = 0;
+        while ((length = inputStream.read(buffer)) >=  0){
+            outputStream.write(buffer, 0, length);
+        }
+        return  new String(outputStream.toByteArray());
+    }
+}
@@ -185,4 +185,12 @@ public class WsonTest extends TestCase {
 
         Assert.assertEquals(object.get("number").getClass(), Float.class);
     }
+
+    @Test
+    public void testBinary(){
+        byte[] bts = {'{', 2, 2, 'b', 0, 'b', 3, 0, (byte) 0xFF, 0x10, 2, 'n', 0, 'i', 14};
+        JSONObject object = (JSONObject) Wson.parse(bts);
+        Assert.assertArrayEquals(new byte[]{0, (byte) 0xFF, 0x10}, (byte[]) object.get("b"));
+        Assert.assertEquals(7, object.get("n"));
+    }
 }
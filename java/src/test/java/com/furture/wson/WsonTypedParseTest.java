@@ -0,0 +1,179 @@
+package com.furture.wson;
+
+import com.alibaba.fastjson.JSON;
+import com.alibaba.fastjson.TypeReference;
+import com.efurture.wson.Wson;
+import com.furture.wson.domain.User;
+import junit.framework.TestCase;
+import org.junit.Assert;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * parse wson directly to bean, must be same as parse to json tree then convert by fastjson
+ */
+public class WsonTypedParseTest extends TestCase {
+
+
+    public void testParseBean(){
+        User user = new User();
+        user.name = "中国";
+        user.age = 18;
+        user.type = true;
+        user.next = new User();
+        user.next.name = "next";
+        byte[] bts = Wson.toWson(user);
+
+        User parsed = Wson.parse(bts, User.class);
+        Assert.assertEquals("中国", parsed.name);
+        Assert.assertEquals(18, parsed.age);
+        Assert.assertTrue(parsed.type);
+        Assert.assertNull(parsed.country);
+        Assert.assertEquals("next", parsed.next.name);
+        Assert.assertEquals(JSON.toJSONString(user), JSON.toJSONString(parsed));
+    }
+
+    public void testParseNumbersAndUnknownKeys(){
+        Map<String, Object> map = new HashMap<>();
+        map.put("count", 10);
+        map.put("total", Long.MAX_VALUE);
+        map.put("ratio", 0.5);
+        map.put("scale", 2);
+        map.put("enabled", true);
+        map.put("ids", new int[]{1, 2, 3});
+        map.put("tags", new String[]{"a", "b"});
+        map.put("scores", JSON.parse("{\"a\":1,\"b\":2}"));
+        map.put("unknown", JSON.parse("{\"list\":[1,\"a\",{\"b\":null}]}"));
+        map.put("user", JSON.parse("{\"name\":\"child\"}"));
+
+        Stats stats = Wson.parse(Wson.toWson(map), Stats.class);
+        Assert.assertEquals(10, stats.count);
+        Assert.assertEquals(Long.MAX_VALUE, stats.getTotal());
+        Assert.assertEquals(0.5, stats.ratio, 0);
+        Assert.assertEquals(2.0f, stats.scale, 0);
+        Assert.assertTrue(stats.enabled);
+        Assert.assertArrayEquals(new int[]{1, 2, 3}, stats.ids);
+        Assert.assertEquals(2, stats.tags.size());
+        Assert.assertEquals(Integer.valueOf(2), stats.scores.get("b"));
+        Assert.assertEquals("child", stats.user.name);
+    }
+
+    public void testParseTypeReference(){
+        List<User> users = new ArrayList<>();
+        for(int i=0; i<3; i++){
+            User user = new User();
+            user.name = "user" + i;
+            user.age = i;
+            users.add(user);
+        }
+        Result<List<User>> result = new Result<>();
+        result.code = 200;
+        result.data = users;
+
+        Result<List<User>> parsed = Wson.parse(Wson.toWson(result), new TypeReference<Result<List<User>>>(){});
+        Assert.assertEquals(200, parsed.code);
+        Assert.assertEquals(3, parsed.data.size());
+        Assert.assertEquals("user2", parsed.data.get(2).name);
+        Assert.assertEquals(2, parsed.data.get(2).age);
+
+        List<User> list = Wson.parse(Wson.toWson(users), new TypeReference<List<User>>(){});
+        Assert.assertEquals("user1", list.get(1).name);
+    }
+
+    public void testParseGenericContainers(){
+        Page<User> page = new Page<>();
+        page.items = new ArrayList<>();
+        page.byName = new HashMap<>();
+        page.top = new User[2];
+        for(int i=0; i<2; i++){
+            User user = new User();
+            user.name = "user" + i;
+            user.age = i;
+            page.items.add(user);
+            page.byName.put(user.name, user);
+            page.top[i] = user;
+        }
+        Page<User> parsed = Wson.parse(Wson.toWson(page), new TypeReference<Page<User>>(){});
+        User item = parsed.items.get(1);
+        Assert.assertEquals("user1", item.name);
+        Assert.assertEquals(1, item.age);
+        User byName = parsed.byName.get("user0");
+        Assert.assertEquals(0, byName.age);
+        Assert.assertTrue(parsed.top instanceof User[]);
+        Assert.assertEquals("user1", parsed.top[1].name);
+        Assert.assertEquals(JSON.toJSONString(page), JSON.toJSONString(parsed));
+    }
+
+    public void testParseGenericSuperclass(){
+        User user = new User();
+        user.name = "person";
+        user.age = 30;
+        PersonResult result = new PersonResult();
+        result.code = 200;
+        result.data = user;
+        PersonResult parsed = Wson.parse(Wson.toWson(result), PersonResult.class);
+        Assert.assertEquals(200, parsed.code);
+        User data = parsed.data;
+        Assert.assertEquals("person", data.name);
+        Assert.assertEquals(30, data.age);
+
+        PagedPersons persons = new PagedPersons();
+        persons.items = new ArrayList<>();
+        persons.items.add(user);
+        PagedPersons parsedPersons = Wson.parse(Wson.toWson(persons), PagedPersons.class);
+        User first = parsedPersons.items.get(0);
+        Assert.assertEquals("person", first.name);
+    }
+
+    public void testParseBroken(){
+        byte[] bts = Wson.toWson(JSON.parse("{\"count\":1,\"tags\":[\"a\"]}"));
+        byte[] broken = new byte[bts.length - 2];
+        System.arraycopy(bts, 0, broken, 0, broken.length);
+        Assert.assertNull(Wson.parse(broken, Stats.class));
+    }
+
+
+    public static class Stats {
+        public int count;
+        private long total;
+        public double ratio;
+        public float scale;
+        public boolean enabled;
+        public int[] ids;
+        public List<String> tags;
+        public Map<String, Integer> scores;
+        public User user;
+
+        public long getTotal() {
+            return total;
+        }
+
+        public void setTotal(long total) {
+            this.total = total;
+        }
+    }
+
+    public static class Result<T> {
+        public int code;
+        public T data;
+    }
+
+    public static class PersonResult extends Result<User> {
+    }
+
+    public static class Page<T> {
+        public List<T> items;
+        public Map<String, T> byName;
+        public T[] top;
+    }
+
+    public static class NamedPage<E> extends Page<E> {
+        public String title;
+    }
+
+    public static class PagedPersons extends NamedPage<User> {
+    }
+}
@@ -0,0 +1,131 @@
+package com.furture.wson.bench;
+
+import com.alibaba.fastjson.JSON;
+import com.alibaba.fastjson.JSONObject;
+import com.efurture.wson.Wson;
+import com.furture.wson.domain.User;
+import junit.framework.TestCase;
+
+import java.lang.reflect.Field;
+import java.lang.reflect.Method;
+import java.lang.reflect.Modifier;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * jmh style bench, warmup then measure ns/op for:
+ * generated bean serializer, reflection to map then wson (previous path), and fastjson
+ */
+public class WsonBeanSerializeBenchTest extends TestCase {
+
+    private static final int WARMUP_ITERATIONS = 5;
+    private static final int MEASURE_ITERATIONS = 5;
+    private static final int OPERATIONS = 1000;
+
+    private static volatile Object sink;
+
+    public void testRunBenckMark() throws Exception {
+        final List<User> users = new ArrayList<>();
+        for(int i=0; i<20; i++){
+            User user = new User();
+            user.name = "name" + i;
+            user.country = "中国";
+            user.age = i;
+            user.type = i%2 == 0;
+            user.next = new User();
+            user.next.name = "next" + i;
+            users.add(user);
+        }
+        bench("wson generated", new Runnable() {
+            @Override
+            public void run() {
+                sink = Wson.toWson(users);
+            }
+        });
+        bench("wson reflection map", new Runnable() {
+            @Override
+            public void run() {
+                List<Object> maps = new ArrayList<>(users.size());
+                for(User user : users){
+                    maps.add(reflectionToMap(user));
+                }
+                sink = Wson.toWson(maps);
+            }
+        });
+        bench("fastjson", new Runnable() {
+            @Override
+            public void run() {
+                sink = JSON.toJSONString(users);
+            }
+        });
+    }
+
+    private void bench(String name, Runnable runnable){
+        for(int i=0; i<WARMUP_ITERATIONS; i++){
+            measure(runnable);
+        }
+        double best = Double.MAX_VALUE;
+        double total = 0;
+        for(int i=0; i<MEASURE_ITERATIONS; i++){
+            double score = measure(runnable);
+            best = Math.min(best, score);
+            total += score;
+        }
+        System.out.println(String.format("%-24s avg %10.1f ns/op  best %10.1f ns/op",
+                name, total/MEASURE_ITERATIONS, best));
+    }
+
+    private double measure(Runnable runnable){
+        long start = System.nanoTime();
+        for(int i=0; i<OPERATIONS; i++){
+            runnable.run();
+        }
+        return (System.nanoTime() - start)/(double)(OPERATIONS);
+    }
+
+    /**
+     * previous WsonAdapter.toMap, Method.invoke and lower case name per object, nested bean is mapped too
+     * */
+    private static Map reflectionToMap(Object object){
+        Map map = new JSONObject();
+        try {
+            for (Method method : object.getClass().getMethods()) {
+                if(method.getDeclaringClass() == Object.class
+                        || (method.getModifiers() & Modifier.STATIC) != 0){
+                    continue;
+                }
+                String methodName = method.getName();
+                String name;
+                if(methodName.startsWith("get")){
+                    name = methodName.substring(3);
+                }else if(methodName.startsWith("is")){
+                    name = methodName.substring(2);
+                }else{
+                    continue;
+                }
+                Object value = method.invoke(object);
+                if(value != null){
+                    StringBuilder builder = new StringBuilder(name);
+                    builder.setCharAt(0, Character.toLowerCase(builder.charAt(0)));
+                    map.put(builder.toString(), value);
+                }
+            }
+            for(Field field : object.getClass().getFields()){
+                if((field.getModifiers() & Modifier.STATIC) != 0 || map.containsKey(field.getName())){
+                    continue;
+                }
+                Object value  = field.get(object);
+                if(value instanceof User){
+                    value = reflectionToMap(value);
+                }
+                if(value != null){
+                    map.put(field.getName(), value);
+                }
+            }
+        }catch (Exception e){
+            throw new RuntimeException(e);
+        }
+        return map;
+    }
+}
@@ -0,0 +1,88 @@
+package com.furture.wson.bench;
+
+import com.alibaba.fastjson.JSON;
+import com.efurture.wson.Wson;
+import com.efurture.wson.WsonNative;
+import junit.framework.TestCase;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.nio.ByteBuffer;
+
+/**
+ * pure java Wson vs jni WsonNative, byte array and direct buffer
+ */
+public class WsonNativeBenchTest extends TestCase {
+
+
+    public void testRunBenckMark() throws IOException {
+        assertTrue("wsonjni not loaded, build it with gradle buildWsonJni", WsonNative.isAvailable());
+        benckMark("/media.json", 10000);
+        benckMark("/weex.json", 10000);
+        benckMark("/data.json", 1000);
+        benckMark("/home.json", 100);
+        benckMark("/data/cart.json", 10000);
+        benckMark("/data/trade.json", 10000);
+    }
+
+
+    private void benckMark(String file, int count) throws IOException {
+        Object map = JSON.parse(readFile(file));
+        byte[] bts = Wson.toWson(map);
+        ByteBuffer direct = ByteBuffer.allocateDirect(bts.length);
+        direct.put(bts);
+        direct.flip();
+        ByteBuffer out = ByteBuffer.allocateDirect(bts.length);
+        System.out.println("bench " + file + " wson size " + bts.length);
+
+        long start = System.currentTimeMillis();
+        for(int i=0; i<count; i++){
+            Wson.parse(bts);
+        }
+        System.out.println("Wson parse used " + (System.currentTimeMillis() - start));
+
+        start = System.currentTimeMillis();
+        for(int i=0; i<count; i++){
+            WsonNative.parse(bts);
+        }
+        System.out.println("WsonNative parse used " + (System.currentTimeMillis() - start));
+
+        start = System.currentTimeMillis();
+        for(int i=0; i<count; i++){
+            WsonNative.parse(direct);
+        }
+        System.out.println("WsonNative parse direct used " + (System.currentTimeMillis() - start));
+
+        start = System.currentTimeMillis();
+        for(int i=0; i<count; i++){
+            Wson.toWson(map);
+        }
+        System.out.println("Wson toWson used " + (System.currentTimeMillis() - start));
+
+        start = System.currentTimeMillis();
+        for(int i=0; i<count; i++){
+            WsonNative.toWson(map);
+        }
+        System.out.println("WsonNative toWson used " + (System.currentTimeMillis() - start));
+
+        start = System.currentTimeMillis();
+        for(int i=0; i<count; i++){
+            out.clear();
+            WsonNative.toWson(map, out);
+        }
+        System.out.println("WsonNative toWson direct used " + (System.currentTimeMillis() - start));
+    }
+
+
+    private String readFile(String file) throws IOException {
+        ByteArrayOutputStream outputStream = new ByteArrayOutputStream(1024);
+        InputStream inputStream = this.getClass().getResourceAsStream(file);
+        byte[] buffer = new byte[1024];
+        int length = 0;
+        while ((length = inputStream.read(buffer)) >=  0){
+            outputStream.write(buffer, 0, length);
+        }
+        return  new String(outputStream.toByteArray());
+    }
+}
@@ -10,8 +10,33 @@
 #include "ObjectConstructor.h"
 #include "JSONObject.h"
 #include "JSCJSValueInlines.h"
+#include "StrongInlines.h"
+#include "StructureInlines.h"
+#include "SlotVisitorInlines.h"
+#include "JSArrayBufferView.h"
+#include "ArrayStorage.h"
+#include "SparseArrayValueMap.h"
+#include "ExceptionHelpers.h"
+#include "ThrowScope.h"
+#include "wson_hash.h"
+#include "wson_stats.h"
 #include <wtf/Vector.h>
 #include <wtf/HashMap.h>
+#include <wtf/HashSet.h>
+#include <wtf/RefCounted.h>
+#include <wtf/ThreadSafeRefCounted.h>
+#include <wtf/Lock.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
 
 
 
@@ -34,29 +59,264 @@ using namespace JSC;
  * max deep, like JSONObject.cpp's maximumFilterRecursion default 40000
  */
 #define WSON_MAX_DEEP  40000
-#define WSON_SYSTEM_IDENTIFIER_CACHE_COUNT (1024*4)
 #define WSON_LOCAL_IDENTIFIER_CACHE_COUNT 32
+/**
+ * identifier cache is 4-way set associative, count of every cache must be power of two and not less than ways
+ */
+#define WSON_IDENTIFIER_CACHE_WAYS 4
+#define WSON_IDENTIFIER_CACHE_MAX_LENGTH 64
+/**
+ * final structure cache of recurring map key sequence, direct mapped by key sequence hash
+ */
+#define WSON_STRUCTURE_CACHE_COUNT 512
+/**
+ * encoded map keys cache of toWson, direct mapped by structure address
+ */
+#define WSON_ENCODED_KEYS_CACHE_COUNT 256
+/**
+ * toJSON absent cache of toWson, direct mapped by structure address
+ */
+#define WSON_TO_JSON_CACHE_COUNT 256
+/**
+ * smaller payload decode faster than hash and compare, not cached
+ */
+#define WSON_VALUE_CACHE_MIN_BYTES 64
 
 namespace wson {
+    /**
+     * utf16 hold own copy of key chars, identifier may share an existed atom string
+     */
     struct IdentifierCache{
         Identifier identifer = Identifier::EmptyIdentifier;
-        size_t length = 0;
+        String utf16;
+        uint32_t length = 0;
         uint32_t key = 0;
-        const UChar* utf16 = NULL;
     };
 
-    static  IdentifierCache* systemIdentifyCache = nullptr;
-    static  VM* systemIdentifyCacheVM = nullptr;
-    void wson_push_js_value(ExecState* exec, JSValue val, wson_buffer* buffer, Vector<JSObject*, 16>& objectStack);
-    JSValue wson_to_js_value(ExecState* state, wson_buffer* buffer, IdentifierCache* localIdentifiers, const int& localCount);
+    /** settings may be changed from any thread, read relaxed once per operation or key */
+    static  std::atomic<uint32_t> identifierCacheMaxLength(WSON_IDENTIFIER_CACHE_MAX_LENGTH);
+    static  std::atomic<bool> sparseArrayAsMap(false);
+
+    /**
+     * key impl is kept alive by structure property table
+     */
+    struct StructureCache{
+        Strong<Structure> structure;
+        Vector<UniquedStringImpl*, 16> keys;
+    };
+
+    /**
+     * enumerable properties of a structure in order, bytes hold every key as wson property,
+     * key i is bytes from ends[i - 1] to ends[i]. ref counted, so entry evicted during nested encode is kept.
+     */
+    struct EncodedKeys : public RefCounted<EncodedKeys>{
+        Vector<PropertyOffset, 16> offsets;
+        Vector<UniquedStringImpl*, 16> uids;
+        Vector<uint32_t, 16> ends;
+        Vector<uint8_t> bytes;
+    };
+
+    struct EncodedKeysCache{
+        Strong<Structure> structure;
+        RefPtr<EncodedKeys> keys;
+    };
+
+    /**
+     * structure of an object without toJSON and structures of its prototype chain. non dictionary structure
+     * decides own property keys, so toJSON is still absent while every structure along the chain is same.
+     */
+    struct ToJSONCache{
+        Strong<Structure> structure;
+        Vector<Strong<Structure>, 2> prototypes;
+    };
+
+    struct ValueCacheEntry{
+        uint64_t key;
+        Vector<uint8_t> payload;
+        Strong<Unknown> value;
+    };
+
+    /**
+     * lru, most recent entry at front, value is retained by strong handle until evicted
+     */
+    struct ValueCache{
+        size_t maxBytes = 0;
+        std::list<ValueCacheEntry> entries;
+        std::unordered_map<uint64_t, std::list<ValueCacheEntry>::iterator> index;
+        ValueCacheStats stats;
+    };
+
+    /**
+     * caches of one vm, registered by init and unregistered by destory or vm teardown. content is only
+     * touched by the thread holding the vm lock, so only registry lookup is locked. every operation holds
+     * a ref until it returns, so caches unregistered meanwhile are released after the operation.
+     */
+    struct VMCaches : public ThreadSafeRefCounted<VMCaches>{
+        VM* vm = nullptr;
+        IdentifierCache* identifiers = nullptr;
+        int identifierCount = 0;
+        IdentifierCacheStats identifierStats;
+        StructureCache* structures = nullptr;
+        EncodedKeysCache* encodedKeys = nullptr;
+        ToJSONCache* toJSONCache = nullptr;
+        ValueCache* valueCache = nullptr;
+        /** structure of lazy placeholder, and structure it is switched to when materialized */
+        Strong<Structure> lazyStructure;
+        Strong<Structure> materializedStructure;
+
+        ~VMCaches(){
+            delete[] identifiers;
+            delete[] structures;
+            delete[] encodedKeys;
+            delete[] toJSONCache;
+            delete valueCache;
+        }
+    };
+
+    static  StaticLock vmCachesLock;
+    static  std::unordered_map<VM*, RefPtr<VMCaches>> vmCachesRegistry;
+
+    /**
+     * deleted by vm destructor, unregisters caches of the vm, so a new vm at same address never
+     * see caches of the released one even if destory is not called
+     */
+    struct VMCachesTeardown : public VM::ClientData{
+        explicit VMCachesTeardown(VM* vm) : vm(vm){}
+        ~VMCachesTeardown() override;
+        VM* vm;
+    };
+
+    /**
+     * payload copy of lazy decode, shared by placeholders decoded from it, released with the last one
+     */
+    struct LazyPayload : public RefCounted<LazyPayload>{
+        Vector<uint8_t> bytes;
+        uint32_t lazyBytes;
+    };
+
+    /**
+     * vm without registered caches decode with small local identifier cache and no structure cache.
+     * lazy is set when big map should be deferred
+     */
+    struct DecodeContext{
+        IdentifierCache* identifiers;
+        int identifierCount;
+        IdentifierCacheStats* identifierStats;
+        StructureCache* structures;
+        LazyPayload* lazy = nullptr;
+        Structure* lazyStructure = nullptr;
+    };
+
+    /**
+     * objectStack is current path for deep check, visited hold same objects for circle check,
+     * failed is set when a null run can not fit in buffer, the rest of value is skipped
+     */
+    struct EncodeContext{
+        EncodeMode mode;
+        bool sparseArrayAsMap = false;
+        bool failed = false;
+        EncodedKeysCache* encodedKeys = nullptr;
+        ToJSONCache* toJSONCache = nullptr;
+        Vector<JSObject*, 16> objectStack;
+        HashSet<JSObject*> visited;
+    };
+
+    /**
+     * placeholder of a map in lazy payload, owns no property until materialized. every access, write,
+     * enumeration or delete materializes it first, then it switches to plain structure, so later access is cached.
+     * bytes of its map in payload are reported to gc as extra memory until materialized.
+     */
+    class WsonLazyObject : public JSDestructibleObject{
+    public:
+        typedef JSDestructibleObject Base;
+        static const unsigned StructureFlags = Base::StructureFlags | OverridesGetOwnPropertySlot | InterceptsGetOwnPropertySlotByIndexEvenWhenLengthIsNotZero
+                                               | OverridesGetPropertyNames | ProhibitsPropertyCaching;
+
+        DECLARE_INFO;
+
+        static Structure* createStructure(VM& vm, JSGlobalObject* globalObject, JSValue prototype, bool materialized){
+            return Structure::create(vm, globalObject, prototype, TypeInfo(ObjectType, materialized ? Base::StructureFlags : StructureFlags), info());
+        }
+
+        static WsonLazyObject* create(VM& vm, Structure* structure, LazyPayload* payload, uint32_t position, uint32_t length){
+            WsonLazyObject* object = new (NotNull, allocateCell<WsonLazyObject>(vm.heap)) WsonLazyObject(vm, structure);
+            object->finishCreation(vm);
+            object->m_payload = payload;
+            object->m_position = position;
+            object->m_length = length;
+            vm.heap.reportExtraMemoryAllocated(length);
+            return object;
+        }
+
+        static void visitChildren(JSCell* cell, SlotVisitor& visitor){
+            WsonLazyObject* thisObject = jsCast<WsonLazyObject*>(cell);
+            ASSERT_GC_OBJECT_INHERITS(thisObject, info());
+            Base::visitChildren(thisObject, visitor);
+            if(!thisObject->isMaterialized()){
+                visitor.reportExtraMemoryVisited(thisObject->m_length);
+            }
+        }
+
+        static void destroy(JSCell* cell){
+            static_cast<WsonLazyObject*>(cell)->WsonLazyObject::~WsonLazyObject();
+        }
+
+        bool isMaterialized() const { return !m_payload; }
+        const uint8_t* bytes() const { return m_payload->bytes.data() + m_position; }
+        uint32_t length() const { return m_length; }
+        void materialize(ExecState* exec);
+
+        static bool getOwnPropertySlot(JSObject*, ExecState*, PropertyName, PropertySlot&);
+        static bool getOwnPropertySlotByIndex(JSObject*, ExecState*, unsigned propertyName, PropertySlot&);
+        static bool put(JSCell*, ExecState*, PropertyName, JSValue, PutPropertySlot&);
+        static bool putByIndex(JSCell*, ExecState*, unsigned propertyName, JSValue, bool shouldThrow);
+        static bool deleteProperty(JSCell*, ExecState*, PropertyName);
+        static bool deletePropertyByIndex(JSCell*, ExecState*, unsigned propertyName);
+        static bool defineOwnProperty(JSObject*, ExecState*, PropertyName, const PropertyDescriptor&, bool shouldThrow);
+        static bool preventExtensions(JSObject*, ExecState*);
+        static void getOwnPropertyNames(JSObject*, ExecState*, PropertyNameArray&, EnumerationMode);
+        static void getOwnNonIndexPropertyNames(JSObject*, ExecState*, PropertyNameArray&, EnumerationMode);
+        static void getPropertyNames(JSObject*, ExecState*, PropertyNameArray&, EnumerationMode);
+
+    private:
+        WsonLazyObject(VM& vm, Structure* structure)
+            : Base(vm, structure){
+        }
+
+        static void materializeIfNeeded(JSCell* cell, ExecState* exec){
+            WsonLazyObject* object = jsCast<WsonLazyObject*>(cell);
+            if(!object->isMaterialized()){
+                object->materialize(exec);
+            }
+        }
+
+        RefPtr<LazyPayload> m_payload;
+        uint32_t m_position = 0;
+        uint32_t m_length = 0;
+    };
+
+    const ClassInfo WsonLazyObject::s_info = { "Object", &Base::s_info, nullptr, nullptr, CREATE_METHOD_TABLE(WsonLazyObject) };
+
+    void wson_push_js_value(ExecState* exec, JSValue val, wson_buffer* buffer, EncodeContext& context);
+    void wson_push_js_array(ExecState* exec, JSArray* array, wson_buffer* buffer, EncodeContext& context);
+    bool wson_push_js_object_by_structure(ExecState* exec, JSObject* object, wson_buffer* buffer, EncodeContext& context);
+    JSValue wson_to_js_value(ExecState* state, wson_buffer* buffer, DecodeContext& context);
+    JSValue wson_to_js_value_cached(ExecState* exec, wson_buffer* buffer, VMCaches* caches);
+    JSValue wson_to_js_object_shared_structure(ExecState* exec, wson_buffer* buffer, uint32_t length, DecodeContext& context);
+    JSValue wson_to_js_map_lazy(ExecState* exec, wson_buffer* buffer, DecodeContext& context);
+    void wson_put_js_map_entries(ExecState* exec, wson_buffer* buffer, JSObject* object, uint32_t length, DecodeContext& context);
+    JSValue decode_js_value(ExecState* exec, wson_buffer* buffer, VMCaches* caches);
+    JSValue decode_js_value_lazy(ExecState* exec, wson_buffer* buffer, LazyPayload* payload, VMCaches* caches, JSObject* object);
+    RefPtr<VMCaches> caches_for_vm(VM* vm);
+    void freeze_js_value(ExecState* exec, JSValue val, uint32_t deep);
     inline void wson_push_js_string(ExecState* exec,  JSValue val, wson_buffer* buffer);
     inline void wson_push_js_identifier(Identifier val, wson_buffer* buffer);
-    JSValue call_object_js_value_to_json(ExecState* exec, JSValue val, VM& vm, Identifier* identifier);
-    JSValue call_object_js_value_to_json(ExecState* exec, JSValue val, VM& vm, uint32_t index);
+    JSValue call_object_js_value_to_json(ExecState* exec, JSValue val, VM& vm, Identifier* identifier, EncodeContext& context);
+    JSValue call_object_js_value_to_json(ExecState* exec, JSValue val, VM& vm, uint32_t index, EncodeContext& context);
 
 
 
-    wson_buffer* toWson(ExecState* exec, JSValue val){
+    wson_buffer* toWson(ExecState* exec, JSValue val, EncodeMode mode){
         
 #ifdef  WSON_JSC_DEBUG  
          LOGE("weex wson pre %s", JSONStringify(exec, val, 0).utf8().data());
@@ -64,12 +324,25 @@ namespace wson {
         VM& vm = exec->vm();
         LocalScope localScope(exec->vm());
         Identifier emptyIdentifier = vm.propertyNames->emptyIdentifier;
+        EncodeContext context;
+        context.mode = mode;
+        context.sparseArrayAsMap = sparseArrayAsMap.load(std::memory_order_relaxed);
+        RefPtr<VMCaches> caches = caches_for_vm(&vm);
+        if(caches){
+            context.encodedKeys = caches->encodedKeys;
+            context.toJSONCache = caches->toJSONCache;
+        }
         if(val.isObject()){
-            val = call_object_js_value_to_json(exec, val, vm, &emptyIdentifier);
+            val = call_object_js_value_to_json(exec, val, vm, &emptyIdentifier, context);
         }
         wson_buffer* buffer = wson_buffer_new();
-        Vector<JSObject*, 16> objectStack;
-        wson_push_js_value(exec, val, buffer, objectStack);
+        wson_push_js_value(exec, val, buffer, context);
+        if(context.failed){
+            buffer->position = 0;
+            wson_push_type_null(buffer);
+            auto scope = DECLARE_THROW_SCOPE(vm);
+            throwOutOfMemoryError(exec, scope);
+        }
         
         
 #ifdef  WSON_JSC_DEBUG
@@ -91,21 +364,35 @@ namespace wson {
     JSValue toJSValue(ExecState* exec, wson_buffer* buffer){
         VM& vm =exec->vm();
         LocalScope scope(vm);
-        if(systemIdentifyCacheVM && systemIdentifyCacheVM == &vm){
-             return wson_to_js_value(exec, buffer, systemIdentifyCache, WSON_SYSTEM_IDENTIFIER_CACHE_COUNT);
+        RefPtr<VMCaches> caches = caches_for_vm(&vm);
+        if(caches && caches->valueCache
+           && buffer->length - buffer->position >= WSON_VALUE_CACHE_MIN_BYTES){
+            return wson_to_js_value_cached(exec, buffer, caches.get());
         }
+        return decode_js_value(exec, buffer, caches.get());
+    }
 
+    JSValue decode_js_value(ExecState* exec, wson_buffer* buffer, VMCaches* caches){
+        if(caches){
+            DecodeContext context = {caches->identifiers, caches->identifierCount, &caches->identifierStats, caches->structures};
+            return wson_to_js_value(exec, buffer, context);
+        }
+
+        IdentifierCacheStats localStats;
         if(buffer->length < 256){
                IdentifierCache localIdentifiers[WSON_LOCAL_IDENTIFIER_CACHE_COUNT];
-               return wson_to_js_value(exec, buffer, localIdentifiers, WSON_LOCAL_IDENTIFIER_CACHE_COUNT);
+               DecodeContext context = {localIdentifiers, WSON_LOCAL_IDENTIFIER_CACHE_COUNT, &localStats, nullptr};
+               return wson_to_js_value(exec, buffer, context);
         }
 
         if(buffer->length < 1024*2){
                IdentifierCache localIdentifiers[WSON_LOCAL_IDENTIFIER_CACHE_COUNT*2];
-               return wson_to_js_value(exec, buffer, localIdentifiers, WSON_LOCAL_IDENTIFIER_CACHE_COUNT*2);
+               DecodeContext context = {localIdentifiers, WSON_LOCAL_IDENTIFIER_CACHE_COUNT*2, &localStats, nullptr};
+               return wson_to_js_value(exec, buffer, context);
         }
         IdentifierCache localIdentifiers[WSON_LOCAL_IDENTIFIER_CACHE_COUNT*4];
-        JSValue value =  wson_to_js_value(exec, buffer, localIdentifiers, WSON_LOCAL_IDENTIFIER_CACHE_COUNT*4);
+        DecodeContext context = {localIdentifiers, WSON_LOCAL_IDENTIFIER_CACHE_COUNT*4, &localStats, nullptr};
+        JSValue value =  wson_to_js_value(exec, buffer, context);
                
         return value;
     }
@@ -129,115 +416,522 @@ namespace wson {
      }
 
 
-    void init(VM* vm){
-        if(systemIdentifyCache){
-            destory();
+    JSArrayBuffer* toArrayBuffer(ExecState* exec, wson_buffer* buffer){
+        void* data = buffer->data;
+        unsigned length = buffer->position;
+        buffer->data = nullptr;
+        wson_buffer_free(buffer);
+        RefPtr<ArrayBuffer> arrayBuffer = ArrayBuffer::createFromBytes(data, length, [] (void* p) {
+            free(p);
+        });
+        return JSArrayBuffer::create(exec->vm(), exec->lexicalGlobalObject()->arrayBufferStructure(ArrayBufferSharingMode::Default),
+                                     WTFMove(arrayBuffer));
+    }
+
+    JSArrayBuffer* toWsonArrayBuffer(ExecState* exec, JSValue val, EncodeMode mode){
+        return toArrayBuffer(exec, toWson(exec, val, mode));
+    }
+
+    /**
+     * value is kept alive by caller stack while decoding, backing store is not moved by gc
+     */
+    JSValue toJSValueFromArrayBuffer(ExecState* exec, JSValue value, uint32_t lazyBytes){
+        VM& vm = exec->vm();
+        void* data = nullptr;
+        uint32_t length = 0;
+        if(ArrayBuffer* arrayBuffer = toPossiblySharedArrayBuffer(vm, value)){
+            data = arrayBuffer->data();
+            length = arrayBuffer->byteLength();
+        }else if(JSArrayBufferView* view = jsDynamicCast<JSArrayBufferView*>(vm, value)){
+            if(!view->isNeutered()){
+                data = view->vector();
+                length = view->length()*elementSize(view->classInfo(vm)->typedArrayStorageType);
+            }
         }
-        if(systemIdentifyCacheVM){
-            systemIdentifyCacheVM = nullptr;
+        if(!data || length == 0){
+            return jsNull();
         }
-        systemIdentifyCache = new IdentifierCache[WSON_SYSTEM_IDENTIFIER_CACHE_COUNT];
-        for(int i=0; i<WSON_SYSTEM_IDENTIFIER_CACHE_COUNT; i++){
-            systemIdentifyCache[i].identifer = vm->propertyNames->nullIdentifier;
-            systemIdentifyCache[i].length = 0;
-            systemIdentifyCache[i].utf16 = NULL;
-            systemIdentifyCache[i].key = 0;
+        wson_buffer buffer = {data, 0, length};
+        if(lazyBytes > 0){
+            return toJSValueLazy(exec, &buffer, lazyBytes);
         }
-        systemIdentifyCacheVM  = vm;
+        return toJSValue(exec, &buffer);
     }
 
+    JSValue toJSValueLazy(ExecState* exec, wson_buffer* buffer, uint32_t lazyBytes){
+        uint32_t length = buffer->length > buffer->position ? buffer->length - buffer->position : 0;
+        if(lazyBytes == 0 || length < lazyBytes){
+            return toJSValue(exec, buffer);
+        }
+        VM& vm = exec->vm();
+        LocalScope scope(vm);
+        RefPtr<LazyPayload> payload = adoptRef(new LazyPayload());
+        payload->bytes.append((const uint8_t*)buffer->data + buffer->position, length);
+        payload->lazyBytes = lazyBytes;
+        buffer->position = buffer->length;
+        wson_buffer lazyBuffer = {payload->bytes.data(), 0, length};
+        RefPtr<VMCaches> caches = caches_for_vm(&vm);
+        return decode_js_value_lazy(exec, &lazyBuffer, payload.get(), caches.get(), nullptr);
+    }
 
-    void destory(){
-        if(systemIdentifyCache){
-            for(int i=0; i<WSON_SYSTEM_IDENTIFIER_CACHE_COUNT; i++){
-                if(systemIdentifyCache[i].length > 0){
-                    if(systemIdentifyCache[i].utf16){
-                        systemIdentifyCache[i].utf16 = NULL;
-                    }
-                    systemIdentifyCache[i].key = 0;
-                    systemIdentifyCache[i].length = 0;
-                }
+    /**
+     * object is null for root value, root is read by caller at once, so root map is not deferred.
+     * otherwise buffer is at map size of object, its entries are put into object
+     */
+    JSValue decode_js_value_lazy(ExecState* exec, wson_buffer* buffer, LazyPayload* payload, VMCaches* caches, JSObject* object){
+        IdentifierCacheStats localStats;
+        std::unique_ptr<IdentifierCache[]> localIdentifiers;
+        DecodeContext context;
+        if(caches){
+            context = {caches->identifiers, caches->identifierCount, &caches->identifierStats, caches->structures};
+        }else{
+            localIdentifiers.reset(new IdentifierCache[WSON_LOCAL_IDENTIFIER_CACHE_COUNT*4]);
+            context = {localIdentifiers.get(), WSON_LOCAL_IDENTIFIER_CACHE_COUNT*4, &localStats, nullptr};
+        }
+        context.lazy = payload;
+        if(!object){
+            if(!wson_has_next(buffer) || ((const uint8_t*)buffer->data)[buffer->position] != WSON_MAP_TYPE){
+                return wson_to_js_value(exec, buffer, context);
             }
-            delete[] systemIdentifyCache; 
-            systemIdentifyCache = nullptr;
+            wson_next_type(buffer);
+            object = constructEmptyObject(exec);
         }
-        if(systemIdentifyCacheVM){
-            systemIdentifyCacheVM = nullptr;
+        uint32_t length = wson_next_uint(buffer);
+        wson_put_js_map_entries(exec, buffer, object, length, context);
+        return object;
+    }
+
+    void init(VM* vm, uint32_t identifierCacheSize){
+        int count = WSON_IDENTIFIER_CACHE_WAYS;
+        while(count < (int)identifierCacheSize && count < (1 << 24)){
+            count <<= 1;
+        }
+        RefPtr<VMCaches> caches = adoptRef(new VMCaches());
+        caches->vm = vm;
+        caches->identifiers = new IdentifierCache[count];
+        caches->identifierCount = count;
+        caches->structures = new StructureCache[WSON_STRUCTURE_CACHE_COUNT];
+        caches->encodedKeys = new EncodedKeysCache[WSON_ENCODED_KEYS_CACHE_COUNT];
+        caches->toJSONCache = new ToJSONCache[WSON_TO_JSON_CACHE_COUNT];
+        RefPtr<VMCaches> old;
+        {
+            LockHolder holder(vmCachesLock);
+            RefPtr<VMCaches>& registered = vmCachesRegistry[vm];
+            old = WTFMove(registered);
+            registered = WTFMove(caches);
+        }
+        /** embedder owned client data is kept, such vm must call destory before release */
+        if(!vm->clientData){
+            vm->clientData = new VMCachesTeardown(vm);
+        }
+        if(old){
+            JSLockHolder locker(vm);
+            old = nullptr;
         }
     }
 
+    static Vector<RefPtr<VMCaches>, 4> unregister_caches(VM* vm){
+        Vector<RefPtr<VMCaches>, 4> removed;
+        LockHolder holder(vmCachesLock);
+        for(auto it = vmCachesRegistry.begin(); it != vmCachesRegistry.end();){
+            if(!vm || it->first == vm){
+                removed.append(WTFMove(it->second));
+                it = vmCachesRegistry.erase(it);
+            }else{
+                ++it;
+            }
+        }
+        return removed;
+    }
 
+    /**
+     * vm destructor holds the vm lock while client data is deleted, strong handles are released under it
+     */
+    VMCachesTeardown::~VMCachesTeardown(){
+        unregister_caches(vm);
+    }
+
+    RefPtr<VMCaches> caches_for_vm(VM* vm){
+        LockHolder holder(vmCachesLock);
+        auto it = vmCachesRegistry.find(vm);
+        if(it == vmCachesRegistry.end()){
+            return nullptr;
+        }
+        return it->second;
+    }
 
     /**
-     * check is circle reference and  max deep
+     * refs of matched caches, taken under registry lock. caller locks each vm before touching content,
+     * registry lock is never held while waiting for a vm lock.
      */
-    inline bool check_js_deep_and_circle_reference(JSObject* object, Vector<JSObject*, 16>& objectStack){
-        for (unsigned i = 0; i < objectStack.size(); i++) {
-            if (objectStack.at(i) == object) {
-                return true;
+    static Vector<RefPtr<VMCaches>, 4> caches_matching(VM* vm){
+        Vector<RefPtr<VMCaches>, 4> matched;
+        LockHolder holder(vmCachesLock);
+        for(auto& it : vmCachesRegistry){
+            if(!vm || it.first == vm){
+                matched.append(it.second);
             }
         }
-        if(objectStack.size() > WSON_MAX_DEEP){
-            return true;
+        return matched;
+    }
+
+    void setIdentifierCacheMaxLength(uint32_t length){
+        identifierCacheMaxLength.store(length, std::memory_order_relaxed);
+    }
+
+    void setSparseArrayAsMap(bool enable){
+        sparseArrayAsMap.store(enable, std::memory_order_relaxed);
+    }
+
+    IdentifierCacheStats identifierCacheStats(VM* vm){
+        IdentifierCacheStats stats;
+        for(RefPtr<VMCaches>& caches : caches_matching(vm)){
+            JSLockHolder locker(caches->vm);
+            stats.hits += caches->identifierStats.hits;
+            stats.misses += caches->identifierStats.misses;
+            stats.evictions += caches->identifierStats.evictions;
+            caches = nullptr;
         }
-        return false;
+        return stats;
+    }
+
+    void resetIdentifierCacheStats(VM* vm){
+        for(RefPtr<VMCaches>& caches : caches_matching(vm)){
+            JSLockHolder locker(caches->vm);
+            caches->identifierStats = IdentifierCacheStats();
+            caches = nullptr;
+        }
+    }
+
+    /**
+     * caches still used by a running operation are released when it returns
+     */
+    void destory(VM* vm){
+        for(RefPtr<VMCaches>& caches : unregister_caches(vm)){
+            JSLockHolder locker(caches->vm);
+            caches = nullptr;
+        }
+    }
+
+    void remove_value_cache_entry(ValueCache* valueCache, std::list<ValueCacheEntry>::iterator it){
+        valueCache->stats.bytes -= it->payload.size();
+        valueCache->stats.count--;
+        valueCache->index.erase(it->key);
+        valueCache->entries.erase(it);
+    }
+
+    void enableValueCache(VM* vm, size_t maxBytes){
+        JSLockHolder locker(vm);
+        RefPtr<VMCaches> caches = caches_for_vm(vm);
+        if(!caches){
+            if(maxBytes == 0){
+                return;
+            }
+            init(vm);
+            caches = caches_for_vm(vm);
+        }
+        delete caches->valueCache;
+        caches->valueCache = nullptr;
+        if(maxBytes == 0){
+            return;
+        }
+        caches->valueCache = new ValueCache();
+        caches->valueCache->maxBytes = maxBytes;
+    }
+
+    void clearValueCache(VM* vm){
+        for(RefPtr<VMCaches>& caches : caches_matching(vm)){
+            JSLockHolder locker(caches->vm);
+            delete caches->valueCache;
+            caches->valueCache = nullptr;
+            caches = nullptr;
+        }
+    }
+
+    ValueCacheStats valueCacheStats(VM* vm){
+        ValueCacheStats stats;
+        for(RefPtr<VMCaches>& caches : caches_matching(vm)){
+            JSLockHolder locker(caches->vm);
+            if(ValueCache* valueCache = caches->valueCache){
+                stats.hits += valueCache->stats.hits;
+                stats.misses += valueCache->stats.misses;
+                stats.evictions += valueCache->stats.evictions;
+                stats.bytes += valueCache->stats.bytes;
+                stats.count += valueCache->stats.count;
+            }
+            caches = nullptr;
+        }
+        return stats;
     }
 
     /**
-      * djb2-hash-function
-      */
-    inline uint32_t hash(const UChar* utf16, const int length){
-        uint32_t  hash = 5381;
-        for(int i=0;i<length; i++){
-            hash = ((hash << 5) + hash) + utf16[i];
+     * exact payload bytes is key, hash is only for lookup, bytes is compared on hit
+     */
+    JSValue wson_to_js_value_cached(ExecState* exec, wson_buffer* buffer, VMCaches* caches){
+        ValueCache* valueCache = caches->valueCache;
+        const uint8_t* payload = (const uint8_t*)buffer->data + buffer->position;
+        uint32_t length = buffer->length - buffer->position;
+        uint64_t key = wson_hash_bytes(payload, length);
+        auto it = valueCache->index.find(key);
+        if(it != valueCache->index.end()){
+            std::list<ValueCacheEntry>::iterator entry = it->second;
+            if(entry->payload.size() == length && memcmp(entry->payload.data(), payload, length) == 0){
+                valueCache->entries.splice(valueCache->entries.begin(), valueCache->entries, entry);
+                valueCache->stats.hits++;
+                buffer->position = buffer->length;
+                return entry->value.get();
+            }
+            remove_value_cache_entry(valueCache, entry);
+        }
+        valueCache->stats.misses++;
+        JSValue value = decode_js_value(exec, buffer, caches);
+        if(length > valueCache->maxBytes){
+            return value;
         }
-        return hash;
+        /** shared between callers, so no one can modify it */
+        freeze_js_value(exec, value, 0);
+        valueCache->entries.emplace_front();
+        ValueCacheEntry& entry = valueCache->entries.front();
+        entry.key = key;
+        entry.payload.append(payload, length);
+        entry.value.set(exec->vm(), value);
+        valueCache->index[key] = valueCache->entries.begin();
+        valueCache->stats.bytes += length;
+        valueCache->stats.count++;
+        while(valueCache->stats.bytes > valueCache->maxBytes){
+            remove_value_cache_entry(valueCache, std::prev(valueCache->entries.end()));
+            valueCache->stats.evictions++;
+        }
+        return value;
     }
 
-    inline uint32_t hash2(const UChar* utf16, const int length){
-        uint32_t  hash = 5381;
-        hash = ((hash << 5) + hash) + utf16[0];
-        if(length > 1){
-            hash = ((hash << 5) + hash) + utf16[length-1];
+    void freeze_js_value(ExecState* exec, JSValue val, uint32_t deep){
+        if(!val.isObject() || deep > WSON_MAX_DEEP){
+            return;
+        }
+        JSObject* object = asObject(val);
+        if(isJSArray(val)){
+            JSArray* array = asArray(val);
+            uint32_t length = array->length();
+            for(uint32_t index=0; index<length; index++){
+                freeze_js_value(exec, array->getIndex(exec, index), deep + 1);
+            }
+        }else{
+            VM& vm = exec->vm();
+#ifdef __ANDROID__
+            PropertyNameArray objectPropertyNames(exec, PropertyNameMode::Strings);
+#else
+            PropertyNameArray objectPropertyNames(&vm, PropertyNameMode::Strings, PrivateSymbolMode::Exclude);
+#endif
+            object->methodTable()->getOwnPropertyNames(object, exec, objectPropertyNames, EnumerationMode());
+            for(uint32_t i=0; i<objectPropertyNames.size(); i++){
+                freeze_js_value(exec, object->get(exec, objectPropertyNames[i]), deep + 1);
+            }
         }
-        return hash;
+        objectConstructorFreeze(exec, object);
     }
 
+
+
     /**
-     * most of json identifer is repeat, cache can improve performance fixme 
-     * cache global, improve performance
+     * check is circle reference and  max deep, object is pushed to context when not
      */
-    inline Identifier makeIdentifer(VM* vm, IdentifierCache* localIdentifiers, const int& localCount, const UChar* utf16, const size_t length){
+    inline bool check_js_deep_and_circle_reference(JSObject* object, EncodeContext& context){
+        if(context.objectStack.size() > WSON_MAX_DEEP){
+            return true;
+        }
+        if(!context.visited.add(object).isNewEntry){
+            return true;
+        }
+        context.objectStack.append(object);
+        return false;
+    }
+
+    inline void pop_js_object(EncodeContext& context){
+        context.visited.remove(context.objectStack.last());
+        context.objectStack.removeLast();
+    }
+
+    /**
+     * crc32c, hardware instruction when target has sse4.2 or armv8 crc, otherwise table
+     */
+    inline uint32_t crc32c(const uint8_t* data, size_t length){
+        uint32_t crc = 0xFFFFFFFF;
+#if defined(__SSE4_2__) && defined(__x86_64__)
+        uint64_t crc64 = crc;
+        for(; length >= sizeof(uint64_t); data += sizeof(uint64_t), length -= sizeof(uint64_t)){
+            uint64_t word;
+            memcpy(&word, data, sizeof(uint64_t));
+            crc64 = _mm_crc32_u64(crc64, word);
+        }
+        crc = (uint32_t)crc64;
+        for(; length > 0; data++, length--){
+            crc = _mm_crc32_u8(crc, *data);
+        }
+#elif defined(__ARM_FEATURE_CRC32) && defined(__aarch64__)
+        for(; length >= sizeof(uint64_t); data += sizeof(uint64_t), length -= sizeof(uint64_t)){
+            uint64_t word;
+            memcpy(&word, data, sizeof(uint64_t));
+            crc = __crc32cd(crc, word);
+        }
+        for(; length > 0; data++, length--){
+            crc = __crc32cb(crc, *data);
+        }
+#else
+        /** function local static, c++11 guarantees thread safe one time initialization */
+        static const struct crc32c_table {
+            uint32_t values[256];
+            crc32c_table(){
+                for(uint32_t i=0; i<256; i++){
+                    uint32_t value = i;
+                    for(int bit=0; bit<8; bit++){
+                        value = (value & 1) ? (value >> 1) ^ 0x82F63B78 : value >> 1;
+                    }
+                    values[i] = value;
+                }
+            }
+        } table;
+        for(; length > 0; data++, length--){
+            crc = table.values[(crc ^ *data) & 0xFF] ^ (crc >> 8);
+        }
+#endif
+        return ~crc;
+    }
+
+    /**
+     * most of json identifer is repeat, cache can improve performance.
+     * hit entry is moved one way forward, miss is inserted at way 0 and last way is evicted
+     */
+    inline Identifier makeIdentifer(VM* vm, DecodeContext& context, const UChar* utf16, const size_t length){
         if(length <= 0){
            return vm->propertyNames->emptyIdentifier;
         }
-        if (utf16[0] <= 0 || utf16[0] >= 127 || length > 32){//only cache short identifier
+        if (length > identifierCacheMaxLength.load(std::memory_order_relaxed)){
             return  Identifier::fromString(vm, utf16, length);
         }
-
-        IdentifierCache cache;
-        uint32_t key= hash(utf16, length);
-        uint32_t localIndex = (localCount - 1) & key;
-        cache = localIdentifiers[localIndex];
-        if(cache.length == length
-           && cache.key == key
-           && memcmp((void*)cache.utf16, (void*)utf16, length*sizeof(UChar)) == 0
-           && !cache.identifer.isNull()){
-            return cache.identifer;
+        uint32_t key = crc32c((const uint8_t*)utf16, length*sizeof(UChar));
+        uint32_t sets = context.identifierCount/WSON_IDENTIFIER_CACHE_WAYS;
+        IdentifierCache* set = context.identifiers + (key & (sets - 1))*WSON_IDENTIFIER_CACHE_WAYS;
+        for(int way=0; way<WSON_IDENTIFIER_CACHE_WAYS; way++){
+            const IdentifierCache& cache = set[way];
+            if(cache.key == key
+               && cache.length == length
+               && memcmp((void*)cache.utf16.characters16(), (void*)utf16, length*sizeof(UChar)) == 0){
+                context.identifierStats->hits++;
+                WSON_STATS_ADD(identifierCacheHits, 1);
+                if(way > 0){
+                    std::swap(set[way], set[way - 1]);
+                    return set[way - 1].identifer;
+                }
+                return cache.identifer;
+            }
         }
+        context.identifierStats->misses++;
+        WSON_STATS_ADD(identifierCacheMisses, 1);
+        if(set[WSON_IDENTIFIER_CACHE_WAYS - 1].length > 0){
+            context.identifierStats->evictions++;
+        }
+        for(int way=WSON_IDENTIFIER_CACHE_WAYS - 1; way > 0; way--){
+            set[way] = WTFMove(set[way - 1]);
+        }
+        IdentifierCache& cache = set[0];
         UChar* destination;
-        String string = String::createUninitialized(length, destination);
+        cache.utf16 = String::createUninitialized(length, destination);
         memcpy((void*)destination, (void*)utf16, length*sizeof(UChar));
-        Identifier identifier = Identifier::fromString(vm, string);
-        cache.identifer = identifier;
+        cache.identifer = Identifier::fromString(vm, cache.utf16);
         cache.length = length;
         cache.key = key;
-        cache.utf16 = destination;
-        localIdentifiers[localIndex] = cache;
-        return identifier;
+        return cache.identifer;
     }
 
-    JSValue wson_to_js_value(ExecState* exec, wson_buffer* buffer,  IdentifierCache* localIdentifiers, const int& localCount){
+    /**
+     * look ahead element tags without consume, ArrayWithInt32 if all element is int,
+     * ArrayWithDouble if all element is number and none is NaN, otherwise NonArray.
+     * double butterfly can not hold NaN, it is the hole marker, so NaN take generic path.
+     */
+    static IndexingType wson_number_array_indexing_type(wson_buffer* buffer, uint32_t length){
+        const uint8_t* data = (const uint8_t*)buffer->data;
+        uint32_t position = buffer->position;
+        wson_buffer peek = *buffer;
+        IndexingType indexingType = ArrayWithInt32;
+        for(uint32_t i=0; i<length; i++){
+            if(position >= buffer->length){
+                return NonArray;
+            }
+            switch (data[position++]) {
+                case WSON_NUMBER_INT_TYPE:
+                    while(position < buffer->length && (data[position] & 0x80)){
+                        position++;
+                    }
+                    position++;
+                    break;
+                case WSON_NUMBER_FLOAT_TYPE:
+                    if(buffer->length - position < sizeof(float)){
+                        return NonArray;
+                    }
+                    peek.position = position;
+                    if(std::isnan(wson_next_float(&peek))){
+                        return NonArray;
+                    }
+                    position += sizeof(float);
+                    indexingType = ArrayWithDouble;
+                    break;
+                case WSON_NUMBER_DOUBLE_TYPE:
+                    if(buffer->length - position < sizeof(double)){
+                        return NonArray;
+                    }
+                    peek.position = position;
+                    if(std::isnan(wson_next_double(&peek))){
+                        return NonArray;
+                    }
+                    position += sizeof(double);
+                    indexingType = ArrayWithDouble;
+                    break;
+                case WSON_NUMBER_LONG_TYPE:
+                    position += sizeof(uint64_t);
+                    indexingType = ArrayWithDouble;
+                    break;
+                default:
+                    return NonArray;
+            }
+        }
+        return position <= buffer->length ? indexingType : NonArray;
+    }
+
+    /**
+     * element is written straight into int32 or double butterfly, number value not allocate,
+     * so no gc can happen during initialization. return null if vector can not be allocated.
+     */
+    static JSArray* wson_to_js_number_array(ExecState* exec, wson_buffer* buffer, uint32_t length, IndexingType indexingType){
+        VM& vm = exec->vm();
+        Structure* structure = exec->lexicalGlobalObject()->arrayStructureForIndexingTypeDuringAllocation(indexingType);
+        ObjectInitializationScope scope(vm);
+        JSArray* array = JSArray::tryCreateUninitializedRestricted(scope, structure, length);
+        if(!array){
+            return nullptr;
+        }
+        for(uint32_t i=0; i<length; i++){
+            JSValue value;
+            switch (wson_next_type(buffer)) {
+                case WSON_NUMBER_INT_TYPE:
+                    value = jsNumber(wson_next_int(buffer));
+                    break;
+                case WSON_NUMBER_FLOAT_TYPE:
+                    value = jsNumber(wson_next_float(buffer));
+                    break;
+                case WSON_NUMBER_DOUBLE_TYPE:
+                    value = jsNumber(wson_next_double(buffer));
+                    break;
+                default:
+                    value = jsNumber(wson_next_long(buffer));
+                    break;
+            }
+            array->initializeIndex(scope, i, value);
+        }
+        return array;
+    }
+
+    JSValue wson_to_js_value(ExecState* exec, wson_buffer* buffer, DecodeContext& context){
         uint8_t  type = wson_next_type(buffer);
         switch (type) {
             case WSON_STRING_TYPE:
@@ -251,12 +945,39 @@ namespace wson {
                     return jsString(exec, s);
                 }
                 break;
+            case WSON_EXTEND_TYPE:{
+                    uint32_t length = wson_next_uint(buffer);
+                    void* src = wson_next_bts(buffer, length);
+                    RefPtr<ArrayBuffer> arrayBuffer = ArrayBuffer::tryCreate(src, length);
+                    if(!arrayBuffer){
+                        return jsNull();
+                    }
+                    return JSArrayBuffer::create(exec->vm(), exec->lexicalGlobalObject()->arrayBufferStructure(ArrayBufferSharingMode::Default),
+                                                 WTFMove(arrayBuffer));
+                }
+                break;
             case WSON_ARRAY_TYPE:{
                     uint32_t length = wson_next_uint(buffer);
-                    JSArray* array = constructEmptyArray(exec, 0);
+                    if(length > 0){
+                        IndexingType indexingType = wson_number_array_indexing_type(buffer, length);
+                        if(indexingType != NonArray){
+                            JSArray* array = wson_to_js_number_array(exec, buffer, length, indexingType);
+                            if(array){
+                                return array;
+                            }
+                        }
+                    }
+                    VM& vm = exec->vm();
+                    /** every element take at least one byte, so bad length can not over allocate */
+                    uint32_t remain = buffer->length > buffer->position ? buffer->length - buffer->position : 0;
+                    JSArray* array = JSArray::tryCreate(vm, exec->lexicalGlobalObject()->arrayStructureForIndexingTypeDuringAllocation(ArrayWithUndecided),
+                                                        0, std::min(length, remain));
+                    if(!array){
+                        array = constructEmptyArray(exec, 0);
+                    }
                     for(uint32_t i=0; i<length; i++){
                         if(wson_has_next(buffer)){
-                            array->putDirectIndex(exec, i, wson_to_js_value(exec, buffer, localIdentifiers, localCount));
+                            array->putDirectIndex(exec, i, wson_to_js_value(exec, buffer, context));
                         }else{
                             break;
                         }
@@ -265,25 +986,17 @@ namespace wson {
                 }
                 break;
             case WSON_MAP_TYPE:{
+                  if(context.lazy){
+                      return wson_to_js_map_lazy(exec, buffer, context);
+                  }
                   uint32_t length = wson_next_uint(buffer);
+                  if(length > 0 && length <= JSFinalObject::maxInlineCapacity()
+                     && context.structures){
+                      return wson_to_js_object_shared_structure(exec, buffer, length, context);
+                  }
                   JSObject* object = constructEmptyObject(exec);
-                  VM& vm = exec->vm();
-                  for(uint32_t i=0; i<length; i++){
-                      if(wson_has_next(buffer)){
-                          int propertyLength = wson_next_uint(buffer);
-                          const UChar* data = (const UChar*)wson_next_bts(buffer, propertyLength);
-                          Identifier  identifer = makeIdentifer(&vm, localIdentifiers, localCount, data, propertyLength/sizeof(UChar));
-                          PropertyName name = identifer;
-                          if (std::optional<uint32_t> index = parseIndex(name)){
-                              object->putDirectIndex(exec, index.value(), wson_to_js_value(exec, buffer, localIdentifiers, localCount));
-                          }else{
-                              object->putDirect(vm, name, wson_to_js_value(exec, buffer, localIdentifiers, localCount));
-                          }
-                      }else{
-                          break;
-                      }
-                   }
-                   return object;
+                  wson_put_js_map_entries(exec, buffer, object, length, context);
+                  return object;
                 }
                 break;   
            case WSON_NUMBER_INT_TYPE:{
@@ -328,46 +1041,393 @@ namespace wson {
     }
 
     
-    JSValue call_object_js_value_to_json(ExecState* exec, JSValue val, VM& vm, Identifier* identifier){
-     
-        JSObject* object = asObject(val);
-        PropertySlot slot(object, PropertySlot::InternalMethodType::Get);
+    /**
+     * keys and values are decoded first, if same key sequence is seen before, object is created with
+     * its final structure and values are stored by inline offset, no transition walk and no storage grow.
+     * map with index key or duplicate key is not cached.
+     */
+    JSValue wson_to_js_object_shared_structure(ExecState* exec, wson_buffer* buffer, uint32_t length, DecodeContext& context){
+        VM& vm = exec->vm();
+        Vector<Identifier, 16> identifiers;
+        MarkedArgumentBuffer values;
+        bool cacheable = true;
+        uint32_t hash = length;
+        for(uint32_t i=0; i<length; i++){
+            if(!wson_has_next(buffer)){
+                cacheable = false;
+                break;
+            }
+            int propertyLength = wson_next_uint(buffer);
+            const UChar* data = (const UChar*)wson_next_bts(buffer, propertyLength);
+            Identifier identifer = makeIdentifer(&vm, context, data, propertyLength/sizeof(UChar));
+            if(parseIndex(identifer)){
+                cacheable = false;
+            }
+            hash = (hash ^ (uint32_t)(((uintptr_t)identifer.impl()) >> 4))*0x9E3779B1;
+            identifiers.append(identifer);
+            values.append(wson_to_js_value(exec, buffer, context));
+        }
+        JSGlobalObject* globalObject = exec->lexicalGlobalObject();
+        StructureCache& cache = context.structures[(hash >> 7) & (WSON_STRUCTURE_CACHE_COUNT - 1)];
+        if(cacheable && cache.structure.get() && cache.keys.size() == length
+           && cache.structure->globalObject() == globalObject){
+            bool match = true;
+            for(uint32_t i=0; i<length; i++){
+                if(cache.keys[i] != identifiers[i].impl()){
+                    match = false;
+                    break;
+                }
+            }
+            if(match){
+                Structure* structure = cache.structure.get();
+                JSObject* object = constructEmptyObject(exec, structure);
+                for(uint32_t i=0; i<length; i++){
+                    // offset store bypasses put, keep inferred type and replacement watchpoint as put does
+                    structure->willStoreValueForExistingTransition(vm, identifiers[i], values.at(i), false);
+                    object->putDirect(vm, (PropertyOffset)i, values.at(i));
+                }
+                return object;
+            }
+        }
+        JSObject* object = cacheable ? constructEmptyObject(exec, globalObject->objectPrototype(), length) : constructEmptyObject(exec);
+        for(uint32_t i=0; i<identifiers.size(); i++){
+            PropertyName name = identifiers[i];
+            if (std::optional<uint32_t> index = parseIndex(name)){
+                object->putDirectIndex(exec, index.value(), values.at(i));
+            }else{
+                object->putDirect(vm, name, values.at(i));
+            }
+        }
+        if(!cacheable){
+            return object;
+        }
+        Structure* structure = object->structure(vm);
+        if(structure->isDictionary() || structure->outOfLineCapacity() > 0){
+            return object;
+        }
+        for(uint32_t i=0; i<length; i++){
+            if(structure->get(vm, identifiers[i]) != (PropertyOffset)i){
+                return object;
+            }
+        }
+        cache.structure.set(vm, structure);
+        cache.keys.clear();
+        for(uint32_t i=0; i<length; i++){
+            cache.keys.append(identifiers[i].impl());
+        }
+        return object;
+    }
+
+    void wson_put_js_map_entries(ExecState* exec, wson_buffer* buffer, JSObject* object, uint32_t length, DecodeContext& context){
+        VM& vm = exec->vm();
+        for(uint32_t i=0; i<length; i++){
+            if(wson_has_next(buffer)){
+                int propertyLength = wson_next_uint(buffer);
+                const UChar* data = (const UChar*)wson_next_bts(buffer, propertyLength);
+                Identifier  identifer = makeIdentifer(&vm, context, data, propertyLength/sizeof(UChar));
+                PropertyName name = identifer;
+                if (std::optional<uint32_t> index = parseIndex(name)){
+                    object->putDirectIndex(exec, index.value(), wson_to_js_value(exec, buffer, context));
+                }else{
+                    object->putDirect(vm, name, wson_to_js_value(exec, buffer, context));
+                }
+            }else{
+                break;
+            }
+        }
+    }
+
+    /**
+     * like wson_skip_value, but never move over buffer end, return false if value is truncated or too deep
+     */
+    static bool wson_skip_js_value(wson_buffer* buffer, uint32_t deep){
+        if(!wson_has_next(buffer) || deep > WSON_MAX_DEEP){
+            return false;
+        }
+        switch ((uint8_t)wson_next_type(buffer)) {
+            case WSON_STRING_TYPE:
+            case WSON_NUMBER_BIG_INT_TYPE:
+            case WSON_NUMBER_BIG_DECIMAL_TYPE:
+            case WSON_EXTEND_TYPE:{
+                    uint32_t length = wson_next_uint(buffer);
+                    if(buffer->position > buffer->length || length > buffer->length - buffer->position){
+                        return false;
+                    }
+                    buffer->position += length;
+                }
+                break;
+            case WSON_NUMBER_INT_TYPE:
+                wson_next_uint(buffer);
+                break;
+            case WSON_NUMBER_FLOAT_TYPE:
+                buffer->position += sizeof(float);
+                break;
+            case WSON_NUMBER_DOUBLE_TYPE:
+            case WSON_NUMBER_LONG_TYPE:
+                buffer->position += sizeof(uint64_t);
+                break;
+            case WSON_MAP_TYPE:{
+                    uint32_t length = wson_next_uint(buffer);
+                    for(uint32_t i=0; i<length; i++){
+                        if(!wson_has_next(buffer)){
+                            return false;
+                        }
+                        uint32_t propertyLength = wson_next_uint(buffer);
+                        if(buffer->position > buffer->length || propertyLength > buffer->length - buffer->position){
+                            return false;
+                        }
+                        buffer->position += propertyLength;
+                        if(!wson_skip_js_value(buffer, deep + 1)){
+                            return false;
+                        }
+                    }
+                }
+                break;
+            case WSON_ARRAY_TYPE:{
+                    uint32_t length = wson_next_uint(buffer);
+                    for(uint32_t i=0; i<length; i++){
+                        if(!wson_skip_js_value(buffer, deep + 1)){
+                            return false;
+                        }
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+        return buffer->position <= buffer->length;
+    }
+
+    static Structure* lazy_object_structure(VM& vm, VMCaches* caches, JSGlobalObject* globalObject, JSValue prototype, bool materialized){
+        Strong<Structure>* cache = nullptr;
+        if(caches){
+            cache = materialized ? &caches->materializedStructure : &caches->lazyStructure;
+            Structure* structure = cache->get();
+            if(structure && structure->globalObject() == globalObject && structure->storedPrototype() == prototype){
+                return structure;
+            }
+        }
+        Structure* structure = WsonLazyObject::createStructure(vm, globalObject, prototype, materialized);
+        if(cache){
+            cache->set(vm, structure);
+        }
+        return structure;
+    }
+
+    /**
+     * buffer is after map type. map not less than lazyBytes is skipped and deferred, smaller map is decoded
+     * at once without lazy check, its children are smaller too.
+     */
+    JSValue wson_to_js_map_lazy(ExecState* exec, wson_buffer* buffer, DecodeContext& context){
+        LazyPayload* lazy = context.lazy;
+        uint32_t start = buffer->position - 1;
+        if(buffer->length - start >= lazy->lazyBytes){
+            buffer->position = start;
+            if(wson_skip_js_value(buffer, 0) && buffer->position - start >= lazy->lazyBytes){
+                VM& vm = exec->vm();
+                if(!context.lazyStructure){
+                    JSGlobalObject* globalObject = exec->lexicalGlobalObject();
+                    context.lazyStructure = lazy_object_structure(vm, caches_for_vm(&vm).get(), globalObject, globalObject->objectPrototype(), false);
+                }
+                return WsonLazyObject::create(vm, context.lazyStructure, lazy, start, buffer->position - start);
+            }
+        }
+        buffer->position = start;
+        context.lazy = nullptr;
+        JSValue value = wson_to_js_value(exec, buffer, context);
+        context.lazy = lazy;
+        return value;
+    }
+
+    /**
+     * payload is released first, so access during decode goes to base. old structure is shared by
+     * all placeholders, its transition watchpoint is fired before switch.
+     */
+    void WsonLazyObject::materialize(ExecState* exec){
+        VM& vm = exec->vm();
+        RefPtr<LazyPayload> payload = WTFMove(m_payload);
+        RefPtr<VMCaches> caches = caches_for_vm(&vm);
+        Structure* structure = this->structure(vm);
+        structure->didTransitionFromThisStructure();
+        setStructure(vm, lazy_object_structure(vm, caches.get(), structure->globalObject(), getPrototypeDirect(vm), true));
+        wson_buffer buffer = {payload->bytes.data(), m_position + 1, m_position + m_length};
+        decode_js_value_lazy(exec, &buffer, payload.get(), caches.get(), this);
+    }
+
+    bool WsonLazyObject::getOwnPropertySlot(JSObject* object, ExecState* exec, PropertyName propertyName, PropertySlot& slot){
+        materializeIfNeeded(object, exec);
+        return Base::getOwnPropertySlot(object, exec, propertyName, slot);
+    }
+
+    bool WsonLazyObject::getOwnPropertySlotByIndex(JSObject* object, ExecState* exec, unsigned propertyName, PropertySlot& slot){
+        materializeIfNeeded(object, exec);
+        return Base::getOwnPropertySlotByIndex(object, exec, propertyName, slot);
+    }
+
+    bool WsonLazyObject::put(JSCell* cell, ExecState* exec, PropertyName propertyName, JSValue value, PutPropertySlot& slot){
+        materializeIfNeeded(cell, exec);
+        return Base::put(cell, exec, propertyName, value, slot);
+    }
+
+    bool WsonLazyObject::putByIndex(JSCell* cell, ExecState* exec, unsigned propertyName, JSValue value, bool shouldThrow){
+        materializeIfNeeded(cell, exec);
+        return Base::putByIndex(cell, exec, propertyName, value, shouldThrow);
+    }
+
+    bool WsonLazyObject::deleteProperty(JSCell* cell, ExecState* exec, PropertyName propertyName){
+        materializeIfNeeded(cell, exec);
+        return Base::deleteProperty(cell, exec, propertyName);
+    }
+
+    bool WsonLazyObject::deletePropertyByIndex(JSCell* cell, ExecState* exec, unsigned propertyName){
+        materializeIfNeeded(cell, exec);
+        return Base::deletePropertyByIndex(cell, exec, propertyName);
+    }
+
+    bool WsonLazyObject::defineOwnProperty(JSObject* object, ExecState* exec, PropertyName propertyName, const PropertyDescriptor& descriptor, bool shouldThrow){
+        materializeIfNeeded(object, exec);
+        return Base::defineOwnProperty(object, exec, propertyName, descriptor, shouldThrow);
+    }
+
+    bool WsonLazyObject::preventExtensions(JSObject* object, ExecState* exec){
+        materializeIfNeeded(object, exec);
+        return Base::preventExtensions(object, exec);
+    }
+
+    void WsonLazyObject::getOwnPropertyNames(JSObject* object, ExecState* exec, PropertyNameArray& names, EnumerationMode mode){
+        materializeIfNeeded(object, exec);
+        Base::getOwnPropertyNames(object, exec, names, mode);
+    }
+
+    void WsonLazyObject::getOwnNonIndexPropertyNames(JSObject* object, ExecState* exec, PropertyNameArray& names, EnumerationMode mode){
+        materializeIfNeeded(object, exec);
+        Base::getOwnNonIndexPropertyNames(object, exec, names, mode);
+    }
+
+    void WsonLazyObject::getPropertyNames(JSObject* object, ExecState* exec, PropertyNameArray& names, EnumerationMode mode){
+        materializeIfNeeded(object, exec);
+        Base::getPropertyNames(object, exec, names, mode);
+    }
+
+    /**
+     * decoded value is never callable, so toJSON of placeholder not materialized can only come from prototype
+     */
+    static inline JSObject* to_json_lookup_object(VM& vm, JSObject* object){
+        WsonLazyObject* lazy = jsDynamicCast<WsonLazyObject*>(vm, object);
+        if(!lazy || lazy->isMaterialized()){
+            return object;
+        }
+        JSValue prototype = object->getPrototypeDirect(vm);
+        return prototype.isObject() ? asObject(prototype) : nullptr;
+    }
+
+    /**
+     * structure with dictionary kind, static property not reified or custom property lookup may own
+     * toJSON without transition, it is not cached
+     */
+    static inline bool is_to_json_cacheable(Structure* structure){
+        return !structure->isDictionary() && !structure->typeInfo().overridesGetOwnPropertySlot()
+               && (!TypeInfo::hasStaticPropertyTable(structure->typeInfo().inlineTypeFlags()) || structure->staticPropertiesReified());
+    }
+
+    static inline bool is_to_json_absent(VM& vm, JSObject* object, ToJSONCache& cache){
+        if(cache.structure.get() != object->structure(vm)){
+            return false;
+        }
+        JSValue prototype = object->getPrototypeDirect(vm);
+        for(const Strong<Structure>& structure : cache.prototypes){
+            if(!prototype.isObject() || asObject(prototype)->structure(vm) != structure.get()){
+                return false;
+            }
+            prototype = asObject(prototype)->getPrototypeDirect(vm);
+        }
+        return prototype.isNull();
+    }
+
+    static void remember_to_json_absent(VM& vm, JSObject* object, ToJSONCache& cache){
+        if(!is_to_json_cacheable(object->structure(vm))){
+            return;
+        }
+        Vector<Strong<Structure>, 2> prototypes;
+        JSValue prototype = object->getPrototypeDirect(vm);
+        while(prototype.isObject()){
+            Structure* structure = asObject(prototype)->structure(vm);
+            if(!is_to_json_cacheable(structure)){
+                return;
+            }
+            prototypes.append(Strong<Structure>(vm, structure));
+            prototype = asObject(prototype)->getPrototypeDirect(vm);
+        }
+        if(!prototype.isNull()){
+            return;
+        }
+        cache.structure.set(vm, object->structure(vm));
+        cache.prototypes = WTFMove(prototypes);
+    }
+
+    /**
+     * callable toJSON of val, or empty value. absent toJSON is cached by structure of lookup object,
+     * so object tree without toJSON is checked by structure compare only.
+     */
+    static JSValue to_json_function(ExecState* exec, JSValue val, VM& vm, EncodeContext& context, CallType& callType, CallData& callData){
+        JSObject* object = to_json_lookup_object(vm, asObject(val));
+        if(!object){
+            return JSValue();
+        }
+        ToJSONCache* cache = nullptr;
+        if(context.toJSONCache){
+            cache = &context.toJSONCache[(((uintptr_t)object->structure(vm)) >> 4) & (WSON_TO_JSON_CACHE_COUNT - 1)];
+            if(is_to_json_absent(vm, object, *cache)){
+                return JSValue();
+            }
+        }
+        PropertySlot slot(val, PropertySlot::InternalMethodType::Get);
         bool hasProperty = object->getPropertySlot(exec, vm.propertyNames->toJSON, slot);
-        if (hasProperty){
-            JSValue toJSONFunction = slot.getValue(exec, vm.propertyNames->toJSON);
-            CallType callType;
-            CallData callData;
-            if (toJSONFunction.isCallable(callType, callData)){
-                MarkedArgumentBuffer args;
-                args.append(jsString(exec, identifier->string()));
-                return call(exec, asObject(toJSONFunction), callType, callData, val, args);
+        if (!hasProperty){
+            if(cache){
+                remember_to_json_absent(vm, object, *cache);
             }
+            return JSValue();
+        }
+        JSValue toJSONFunction = slot.getValue(exec, vm.propertyNames->toJSON);
+        if (!toJSONFunction.isCallable(callType, callData)){
+            return JSValue();
+        }
+        return toJSONFunction;
+    }
+
+    JSValue call_object_js_value_to_json(ExecState* exec, JSValue val, VM& vm, Identifier* identifier, EncodeContext& context){
+        CallType callType;
+        CallData callData;
+        JSValue toJSONFunction = to_json_function(exec, val, vm, context, callType, callData);
+        if (toJSONFunction){
+            MarkedArgumentBuffer args;
+            args.append(jsString(exec, identifier->string()));
+            return call(exec, asObject(toJSONFunction), callType, callData, val, args);
         }
         return val;
     }
     
-    JSValue call_object_js_value_to_json(ExecState* exec, JSValue val, VM& vm, uint32_t index){
-        JSObject* object = asObject(val);
-        PropertySlot slot(object, PropertySlot::InternalMethodType::Get);
-        bool hasProperty = object->getPropertySlot(exec, vm.propertyNames->toJSON, slot);
-        if (hasProperty){
-            JSValue toJSONFunction = slot.getValue(exec, vm.propertyNames->toJSON);
-            CallType callType;
-            CallData callData;
-            if (toJSONFunction.isCallable(callType, callData)){
-                MarkedArgumentBuffer args;
-                if(index <= 9){
-                    args.append(vm.smallStrings.singleCharacterString(index + '0'));
-                }else{
-                    args.append(jsNontrivialString(&vm, vm.numericStrings.add(index)));
-                }
-                return call(exec, asObject(toJSONFunction), callType, callData, val, args);
+    JSValue call_object_js_value_to_json(ExecState* exec, JSValue val, VM& vm, uint32_t index, EncodeContext& context){
+        CallType callType;
+        CallData callData;
+        JSValue toJSONFunction = to_json_function(exec, val, vm, context, callType, callData);
+        if (toJSONFunction){
+            MarkedArgumentBuffer args;
+            if(index <= 9){
+                args.append(vm.smallStrings.singleCharacterString(index + '0'));
+            }else{
+                args.append(jsNontrivialString(&vm, vm.numericStrings.add(index)));
             }
+            return call(exec, asObject(toJSONFunction), callType, callData, val, args);
         }
         return val;
     }
     
-    void wson_push_js_value(ExecState* exec, JSValue val, wson_buffer* buffer, Vector<JSObject*, 16>& objectStack){
+    void wson_push_js_value(ExecState* exec, JSValue val, wson_buffer* buffer, EncodeContext& context){
+        if(context.failed){
+            return;
+        }
         // check json function
         if(val.isNull() || val.isUndefined() || val.isEmpty()){
             wson_push_type_null(buffer);
@@ -410,22 +1470,12 @@ namespace wson {
 
         if(isJSArray(val)){
             JSArray* array = asArray(val);
-            if(check_js_deep_and_circle_reference(array, objectStack)){
+            if(check_js_deep_and_circle_reference(array, context)){
                 wson_push_type_null(buffer);
                 return;
             }
-            VM& vm = exec->vm();
-            uint32_t length = array->length();
-            wson_push_type_array(buffer, length);
-            objectStack.append(array);
-            for(uint32_t index=0; index<length; index++){
-                JSValue ele = array->getIndex(exec, index);
-                if(ele.isObject()){
-                     ele = call_object_js_value_to_json(exec, ele, vm, index);
-                }
-                wson_push_js_value(exec, ele, buffer, objectStack);
-            }
-            objectStack.removeLast();
+            wson_push_js_array(exec, array, buffer, context);
+            pop_js_object(context);
             return;
         }
 
@@ -433,10 +1483,20 @@ namespace wson {
             JSObject* object = asObject(val);
             VM& vm = exec->vm();
 
+            if (WsonLazyObject* lazy = jsDynamicCast<WsonLazyObject*>(vm, object)){
+                if(!lazy->isMaterialized()){
+                    wson_push_bytes(buffer, lazy->bytes(), lazy->length());
+                    return;
+                }
+            }
             if (object->inherits(vm, StringObject::info())){
                 wson_push_js_string(exec, object->toString(exec), buffer);
                 return;
             }
+            if (ArrayBuffer* arrayBuffer = toPossiblySharedArrayBuffer(vm, object)){
+                wson_push_type_extend(buffer, arrayBuffer->data(), arrayBuffer->byteLength());
+                return;
+            }
             if (object->inherits(vm, NumberObject::info())){
                 JSValue number = jsNumber(object->toNumber(exec));
                 if(number.isInt32()){
@@ -469,10 +1529,14 @@ namespace wson {
                 return;
             }
 
-            if(check_js_deep_and_circle_reference(object, objectStack)){
+            if(check_js_deep_and_circle_reference(object, context)){
                 wson_push_type_null(buffer);
                 return;
             }
+            if(wson_push_js_object_by_structure(exec, object, buffer, context)){
+                pop_js_object(context);
+                return;
+            }
 #ifdef __ANDROID__
             PropertyNameArray objectPropertyNames(exec, PropertyNameMode::Strings);
 #else
@@ -482,6 +1546,29 @@ namespace wson {
             methodTable->getOwnPropertyNames(object, exec, objectPropertyNames, EnumerationMode());
             PropertySlot slot(object, PropertySlot::InternalMethodType::Get);
             uint32_t size = objectPropertyNames.size();
+            if(context.mode == EncodeSinglePass){
+                uint32_t sizePosition = wson_push_type_map_reserve(buffer);
+                uint32_t mapSize = 0;
+                for(uint32_t i=0; i<size; i++){
+                    Identifier& propertyName = objectPropertyNames[i];
+                    if(!methodTable->getOwnPropertySlot(object, exec, propertyName, slot)){
+                        continue;
+                    }
+                    JSValue propertyValue = slot.getValue(exec, propertyName);
+                    if(propertyValue.isUndefined() || propertyValue.isFunction()){
+                        continue;
+                    }
+                    if(propertyValue.isObject()){
+                        propertyValue = call_object_js_value_to_json(exec, propertyValue, vm, &propertyName, context);
+                    }
+                    wson_push_js_identifier(propertyName , buffer);
+                    wson_push_js_value(exec, propertyValue, buffer, context);
+                    mapSize++;
+                }
+                wson_patch_uint_fixed(buffer, sizePosition, mapSize);
+                pop_js_object(context);
+                return;
+            }
             /**map should skip null or function */
             /** first check skip null or function,calc null or function */
             uint32_t undefinedOrFunctionSize  = 0;
@@ -498,7 +1585,6 @@ namespace wson {
             }
             /** skip them undefined or function value */
             wson_push_type_map(buffer, size - undefinedOrFunctionSize);
-            objectStack.append(object);
             for(uint32_t i=0; i<size; i++){
                  Identifier& propertyName = objectPropertyNames[i];
                  if(methodTable->getOwnPropertySlot(object, exec, propertyName, slot)){
@@ -507,13 +1593,13 @@ namespace wson {
                           continue;
                      }
                      if(propertyValue.isObject()){
-                         propertyValue = call_object_js_value_to_json(exec, propertyValue, vm, &propertyName);
+                         propertyValue = call_object_js_value_to_json(exec, propertyValue, vm, &propertyName, context);
                      }
                      wson_push_js_identifier(propertyName , buffer);
-                     wson_push_js_value(exec, propertyValue, buffer,objectStack);
+                     wson_push_js_value(exec, propertyValue, buffer, context);
                  }
             }
-            objectStack.removeLast();
+            pop_js_object(context);
             return;
         }
         
@@ -531,14 +1617,255 @@ namespace wson {
         }
 #ifdef __ANDROID__
         LOGE("weex wson err value type is not handled, treat as null, json value %s %d %d ", JSONStringify(exec, val, 0).utf8().data(), val.isFunction(), val.tag());
-        for(size_t i=0; i<objectStack.size(); i++){
-            LOGE("weex wson err value type is not handled, treat as null, root json value %s", JSONStringify(exec, objectStack[i], 0).utf8().data());
+        for(size_t i=0; i<context.objectStack.size(); i++){
+            LOGE("weex wson err value type is not handled, treat as null, root json value %s", JSONStringify(exec, context.objectStack[i], 0).utf8().data());
         }
 #endif
         wson_push_type_null(buffer);
     }
 
+    /**
+     * read element from butterfly, return false if index is not in butterfly of int32, double, contiguous
+     * or array storage shape, caller then use getIndex. value is empty for hole.
+     * butterfly is read again for every index, toJSON of previous element may change the array.
+     */
+    static inline bool js_array_fast_index(JSArray* array, uint32_t index, JSValue& value){
+        Butterfly* butterfly = array->butterfly();
+        switch (array->indexingType() & IndexingShapeMask) {
+            case Int32Shape:
+            case ContiguousShape:
+                if(index >= butterfly->publicLength()){
+                    return false;
+                }
+                value = butterfly->contiguous()[index].get();
+                return true;
+            case DoubleShape:{
+                    if(index >= butterfly->publicLength()){
+                        return false;
+                    }
+                    double number = butterfly->contiguousDouble()[index];
+                    value = number == number ? jsDoubleNumber(number) : JSValue();
+                    return true;
+                }
+            case ArrayStorageShape:
+            case SlowPutArrayStorageShape:{
+                    ArrayStorage* storage = butterfly->arrayStorage();
+                    if(index >= storage->vectorLength() || index >= storage->length() || storage->m_sparseMap){
+                        return false;
+                    }
+                    value = storage->m_vector[index].get();
+                    return true;
+                }
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * array storage without sparse map has no element at or after vector length, like [1, 2] with length
+     * set to 1e7 or new Array(1e7) with few stores, so the rest of array is hole
+     */
+    static inline bool js_array_storage_tail_is_hole(JSArray* array, uint32_t index){
+        IndexingType shape = array->indexingType() & IndexingShapeMask;
+        if(shape != ArrayStorageShape && shape != SlowPutArrayStorageShape){
+            return false;
+        }
+        ArrayStorage* storage = array->butterfly()->arrayStorage();
+        return !storage->m_sparseMap && index >= storage->vectorLength();
+    }
+
+    /**
+     * array storage with sparse map, only existed index is visited, hole between is pushed as null run,
+     * or whole array is pushed as map of index keys and length. elements are read before any toJSON call.
+     * return false if array has no sparse map or has accessor element, nothing is pushed.
+     */
+    static bool wson_push_js_sparse_array(ExecState* exec, JSArray* array, uint32_t length, wson_buffer* buffer, EncodeContext& context){
+        IndexingType shape = array->indexingType() & IndexingShapeMask;
+        if(shape != ArrayStorageShape && shape != SlowPutArrayStorageShape){
+            return false;
+        }
+        ArrayStorage* storage = array->butterfly()->arrayStorage();
+        SparseArrayValueMap* map = storage->m_sparseMap.get();
+        if(!map){
+            return false;
+        }
+        Vector<uint32_t> indexes;
+        for(auto it = map->begin(); it != map->end(); ++it){
+            if(it->value.attributes & (static_cast<unsigned>(PropertyAttribute::Accessor) | static_cast<unsigned>(PropertyAttribute::CustomAccessor))){
+                return false;
+            }
+            if(it->key < length){
+                indexes.append((uint32_t)it->key);
+            }
+        }
+        uint32_t vectorLength = std::min(storage->vectorLength(), length);
+        for(uint32_t index=0; index<vectorLength; index++){
+            if(storage->m_vector[index]){
+                indexes.append(index);
+            }
+        }
+        std::sort(indexes.begin(), indexes.end());
+        MarkedArgumentBuffer values;
+        for(uint32_t index : indexes){
+            values.append(array->getIndex(exec, index));
+        }
+        VM& vm = exec->vm();
+        if(context.sparseArrayAsMap){
+            wson_push_type_map(buffer, indexes.size() + 1);
+            for(size_t i=0; i<indexes.size(); i++){
+                JSValue ele = values.at(i);
+                if(ele.isObject()){
+                    ele = call_object_js_value_to_json(exec, ele, vm, indexes[i], context);
+                }
+                wson_push_js_identifier(Identifier::from(exec, indexes[i]), buffer);
+                wson_push_js_value(exec, ele, buffer, context);
+            }
+            wson_push_js_identifier(vm.propertyNames->length, buffer);
+            wson_push_js_value(exec, jsNumber(length), buffer, context);
+            return true;
+        }
+        wson_push_type_array(buffer, length);
+        uint32_t next = 0;
+        for(size_t i=0; i<indexes.size(); i++){
+            if(!wson_push_type_nulls(buffer, indexes[i] - next)){
+                context.failed = true;
+                return true;
+            }
+            JSValue ele = values.at(i);
+            if(ele.isObject()){
+                ele = call_object_js_value_to_json(exec, ele, vm, indexes[i], context);
+            }
+            wson_push_js_value(exec, ele, buffer, context);
+            next = indexes[i] + 1;
+        }
+        if(!wson_push_type_nulls(buffer, length - next)){
+            context.failed = true;
+        }
+        return true;
+    }
+
+    /**
+     * hole read through sane original prototype chain is undefined, pushed as null without lookup,
+     * hole tail of array storage is pushed as one null run
+     */
+    void wson_push_js_array(ExecState* exec, JSArray* array, wson_buffer* buffer, EncodeContext& context){
+        VM& vm = exec->vm();
+        JSGlobalObject* globalObject = exec->lexicalGlobalObject();
+        uint32_t length = array->length();
+        bool holeIsNull = array->getPrototypeDirect(vm) == globalObject->arrayPrototype()
+                          && globalObject->arrayPrototypeChainIsSane();
+        if(holeIsNull && wson_push_js_sparse_array(exec, array, length, buffer, context)){
+            return;
+        }
+        wson_push_type_array(buffer, length);
+        for(uint32_t index=0; index<length; index++){
+            if(holeIsNull && js_array_storage_tail_is_hole(array, index)){
+                if(!wson_push_type_nulls(buffer, length - index)){
+                    context.failed = true;
+                }
+                break;
+            }
+            JSValue ele;
+            if(!js_array_fast_index(array, index, ele) || (!ele && !holeIsNull)){
+                ele = array->getIndex(exec, index);
+            }
+            if(ele.isObject()){
+                 ele = call_object_js_value_to_json(exec, ele, vm, index, context);
+            }
+            wson_push_js_value(exec, ele, buffer, context);
+            if(context.failed){
+                break;
+            }
+        }
+    }
+
+    static RefPtr<EncodedKeys> encoded_keys_for_structure(VM& vm, EncodedKeysCache* encodedKeys, Structure* structure){
+        EncodedKeysCache& cache = encodedKeys[(((uintptr_t)structure) >> 4) & (WSON_ENCODED_KEYS_CACHE_COUNT - 1)];
+        if(cache.structure.get() == structure){
+            return cache.keys;
+        }
+        RefPtr<EncodedKeys> keys = adoptRef(new EncodedKeys());
+        wson_buffer* buffer = wson_buffer_new();
+        bool valid = true;
+        structure->forEachPropertyConcurrently([&] (const PropertyMapEntry& entry) -> bool {
+            if(entry.attributes & (static_cast<unsigned>(PropertyAttribute::Accessor) | static_cast<unsigned>(PropertyAttribute::CustomAccessor))){
+                valid = false;
+                return false;
+            }
+            if((entry.attributes & static_cast<unsigned>(PropertyAttribute::DontEnum)) || entry.key->isSymbol()){
+                return true;
+            }
+            keys->offsets.append(entry.offset);
+            keys->uids.append(entry.key);
+            wson_push_js_identifier(Identifier::fromUid(&vm, entry.key), buffer);
+            keys->ends.append(buffer->position);
+            return true;
+        });
+        if(valid){
+            keys->bytes.append((uint8_t*)buffer->data, buffer->position);
+        }
+        wson_buffer_free(buffer);
+        if(!valid){
+            return nullptr;
+        }
+        cache.structure.set(vm, structure);
+        cache.keys = keys;
+        return keys;
+    }
+
+    /**
+     * plain object with non dictionary structure and no accessor, properties are walked from structure,
+     * values are read by offset and keys are copied from encoded keys of structure.
+     * return false if object is not suitable, nothing is pushed.
+     */
+    bool wson_push_js_object_by_structure(ExecState* exec, JSObject* object, wson_buffer* buffer, EncodeContext& context){
+        VM& vm = exec->vm();
+        if(!context.encodedKeys || object->type() != FinalObjectType){
+            return false;
+        }
+        Structure* structure = object->structure(vm);
+        if(structure->isDictionary() || !structure->canAccessPropertiesQuicklyForEnumeration()
+           || hasIndexedProperties(structure->indexingType())){
+            return false;
+        }
+        RefPtr<EncodedKeys> keys = encoded_keys_for_structure(vm, context.encodedKeys, structure);
+        if(!keys){
+            return false;
+        }
+        uint32_t length = keys->offsets.size();
+        MarkedArgumentBuffer values;
+        uint32_t mapSize = 0;
+        for(uint32_t i=0; i<length; i++){
+            JSValue value = object->getDirect(keys->offsets[i]);
+            values.append(value);
+            if(!value.isUndefined() && !value.isFunction()){
+                mapSize++;
+            }
+        }
+        wson_push_type_map(buffer, mapSize);
+        const uint8_t* bytes = keys->bytes.data();
+        uint32_t start = 0;
+        for(uint32_t i=0; i<length; i++){
+            uint32_t end = keys->ends[i];
+            JSValue value = values.at(i);
+            if(!value.isUndefined() && !value.isFunction()){
+                if(value.isObject()){
+                    Identifier propertyName = Identifier::fromUid(&vm, keys->uids[i]);
+                    value = call_object_js_value_to_json(exec, value, vm, &propertyName, context);
+                }
+                wson_push_bytes(buffer, bytes + start, end - start);
+                WSON_STATS_ADD(encodePropertyBytes, end - start);
+                wson_push_js_value(exec, value, buffer, context);
+            }
+            start = end;
+        }
+        return true;
+    }
+
     inline void wson_push_js_string(ExecState* exec,  JSValue val, wson_buffer* buffer){
+#ifdef WSON_STATS
+        uint32_t statsStart = buffer->position;
+#endif
         String s = val.toWTFString(exec);
         size_t length = s.length();
         if (s.is8Bit()) {
@@ -560,10 +1887,14 @@ namespace wson {
            wson_push_uint(buffer, length*sizeof(UChar));
            wson_push_bytes(buffer, s.characters16(), s.length()*sizeof(UChar));
         }
-
+        WSON_STATS_ADD(encodeValues[WSON_STRING_TYPE], 1);
+        WSON_STATS_ADD(encodeBytes[WSON_STRING_TYPE], buffer->position - statsStart);
     }
 
     inline void wson_push_js_identifier(Identifier val, wson_buffer* buffer){
+#ifdef WSON_STATS
+         uint32_t statsStart = buffer->position;
+#endif
          String s = val.string();
          size_t  length = s.length();
          if (s.is8Bit()) {
@@ -584,5 +1915,6 @@ namespace wson {
            wson_push_uint(buffer, length*sizeof(UChar));
            wson_push_bytes(buffer, s.characters16(), s.length()*sizeof(UChar));
         }
+        WSON_STATS_ADD(encodePropertyBytes, buffer->position - statsStart);
     }
 }
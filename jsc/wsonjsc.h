@@ -14,21 +14,102 @@
 #include "IdentifierInlines.h"
 #include "LocalScope.h"
 #include "BooleanObject.h"
+#include "JSArrayBuffer.h"
 #include "wson.h"
 
 using namespace JSC;
 
 
 namespace wson {
-    wson_buffer* toWson(ExecState* state, JSValue val);
+    /**
+     * EncodeCompact read every property twice, first pass count map size, so size is minimal varint.
+     * EncodeSinglePass read every property once, map size is fixed 5 bytes varint patched after entries.
+     */
+    enum EncodeMode{
+        EncodeCompact,
+        EncodeSinglePass
+    };
+
+    wson_buffer* toWson(ExecState* state, JSValue val, EncodeMode mode = EncodeCompact);
     JSValue toJSValue(ExecState* state, wson_buffer* buffer);
     JSValue toJSValue(ExecState* state, void* buffer, int length);
 
+    /**
+     * adopt encoded bytes as ArrayBuffer without copy, bytes are freed when ArrayBuffer is collected.
+     * buffer is released and must not be used after.
+     */
+    JSArrayBuffer* toArrayBuffer(ExecState* state, wson_buffer* buffer);
+    JSArrayBuffer* toWsonArrayBuffer(ExecState* state, JSValue val, EncodeMode mode = EncodeCompact);
+
+    /**
+     * decode in place from ArrayBuffer, SharedArrayBuffer or a view on them, return jsNull if value
+     * is not a buffer. shared buffer must not be written by other threads while decoding.
+     * lazyBytes 0 decode all at once, otherwise decode like toJSValueLazy.
+     */
+    JSValue toJSValueFromArrayBuffer(ExecState* state, JSValue value, uint32_t lazyBytes = 0);
+
+    /**
+     * lazy decode for big payload, map whose encoded bytes is not less than lazyBytes is created as placeholder
+     * object, it decodes its properties into itself on first property access. root and arrays are decoded at once.
+     * payload is copied once and shared by placeholders, so buffer can be released after return.
+     * placeholder not accessed yet is written back by toWson with its original bytes.
+     */
+    JSValue toJSValueLazy(ExecState* state, wson_buffer* buffer, uint32_t lazyBytes = 1024*4);
+
     /**
      * performance improve wson toJSValue. very big import improve
+     * identifierCacheSize is entries of vm identifier cache, rounded up to power of two.
+     * every vm has own caches, init each vm after created. caches are released with the vm through
+     * vm client data, which init installs only when vm has none and which is then owned by the vm.
+     * an embedder installing own client data must do it before init, or delete the one installed by
+     * init before replacing it; such vm must call destory before the vm is released.
+     * vms on different threads can use their caches at same time.
+     */
+    void init(VM* vm, uint32_t identifierCacheSize = 1024*4);
+    /**
+     * release caches of vm, all vms if null. operation running on the vm keeps its caches until it returns.
+     * takes lock of each released vm, so it must not be called while another vm lock is held
+     */
+    void destory(VM* vm = nullptr);
+
+    struct IdentifierCacheStats{
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    /**
+     * longer map key is not cached, default 64 utf-16 chars. settings are global and can be changed from any thread
+     */
+    void setIdentifierCacheMaxLength(uint32_t length);
+
+    /**
+     * sparse array is written as map of its index keys and length instead of array with null holes,
+     * so decoder get array like object. default false
+     */
+    void setSparseArrayAsMap(bool enable);
+    /**
+     * stats of vm, sum of all vms if null
+     */
+    IdentifierCacheStats identifierCacheStats(VM* vm = nullptr);
+    void resetIdentifierCacheStats(VM* vm = nullptr);
+
+    struct ValueCacheStats{
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t bytes = 0;
+        size_t count = 0;
+    };
+
+    /**
+     * opt-in decoded value cache, toJSValue on same payload return shared deep frozen value.
+     * maxBytes is total payload bytes kept, 0 disable and release cached values.
+     * vm is initialized with default caches if init is not called for it.
      */
-    void init(VM* vm);
-    void destory();
+    void enableValueCache(VM* vm, size_t maxBytes);
+    void clearValueCache(VM* vm = nullptr);
+    ValueCacheStats valueCacheStats(VM* vm = nullptr);
 }
 
 
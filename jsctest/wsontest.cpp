@@ -125,6 +125,9 @@ static EncodedJSValue JSC_HOST_CALL functionToWson(ExecState* exec);
 static EncodedJSValue JSC_HOST_CALL functionParseWson(ExecState* exec);
 static EncodedJSValue JSC_HOST_CALL functionWsonInit(ExecState* exec);
 static EncodedJSValue JSC_HOST_CALL functionWsonDestroy(ExecState* exec);
+static EncodedJSValue JSC_HOST_CALL functionWsonValueCache(ExecState* exec);
+static EncodedJSValue JSC_HOST_CALL functionWsonValueCacheStats(ExecState* exec);
+static EncodedJSValue JSC_HOST_CALL functionWsonIdentifierCacheStats(ExecState* exec);
 static EncodedJSValue JSC_HOST_CALL functionBenchmark(ExecState* exec);
 
 
@@ -162,10 +165,13 @@ protected:
         addFunction(vm, "readFile", functionReadFile, 2);
         addFunction(vm, "quit", functionQuit, 1);
         addFunction(vm, "log", functionLog, 1);
-        addFunction(vm, "wsonInit", functionWsonInit, 0);
+        addFunction(vm, "wsonInit", functionWsonInit, 1);
         addFunction(vm, "wsonDestroy", functionWsonDestroy, 0);
-        addFunction(vm, "toWson", functionToWson, 1);
-        addFunction(vm, "parseWson", functionParseWson, 1);
+        addFunction(vm, "wsonValueCache", functionWsonValueCache, 1);
+        addFunction(vm, "wsonValueCacheStats", functionWsonValueCacheStats, 0);
+        addFunction(vm, "wsonIdentifierCacheStats", functionWsonIdentifierCacheStats, 0);
+        addFunction(vm, "toWson", functionToWson, 2);
+        addFunction(vm, "parseWson", functionParseWson, 2);
         addFunction(vm, "wsonJsonBenchmark", functionBenchmark, 1);
     }
     
@@ -354,17 +360,50 @@ int main(int argc, char* argv[]){
 
 
 EncodedJSValue JSC_HOST_CALL functionWsonInit(ExecState* exec){
-    wson::init(&exec->vm());
+    JSValue size = exec->argument(0);
+    if(size.isNumber() && size.asNumber() > 0){
+        wson::init(&exec->vm(), (uint32_t)size.asNumber());
+    }else{
+        wson::init(&exec->vm());
+    }
     return JSValue::encode(jsBoolean(true));
 }
 
 EncodedJSValue JSC_HOST_CALL functionWsonDestroy(ExecState* exec){
     if(exec){
-       wson::destory();
+       wson::destory(&exec->vm());
     }
     return JSValue::encode(jsBoolean(true));
 }
 
+EncodedJSValue JSC_HOST_CALL functionWsonValueCache(ExecState* exec){
+    double maxBytes = exec->argument(0).toNumber(exec);
+    wson::enableValueCache(&exec->vm(), maxBytes > 0 ? (size_t)maxBytes : 0);
+    return JSValue::encode(jsBoolean(true));
+}
+
+EncodedJSValue JSC_HOST_CALL functionWsonValueCacheStats(ExecState* exec){
+    VM& vm = exec->vm();
+    wson::ValueCacheStats stats = wson::valueCacheStats(&vm);
+    JSObject* result = constructEmptyObject(exec);
+    result->putDirect(vm, Identifier::fromString(&vm, "hits"), jsNumber(stats.hits));
+    result->putDirect(vm, Identifier::fromString(&vm, "misses"), jsNumber(stats.misses));
+    result->putDirect(vm, Identifier::fromString(&vm, "evictions"), jsNumber(stats.evictions));
+    result->putDirect(vm, Identifier::fromString(&vm, "bytes"), jsNumber(stats.bytes));
+    result->putDirect(vm, Identifier::fromString(&vm, "count"), jsNumber(stats.count));
+    return JSValue::encode(result);
+}
+
+EncodedJSValue JSC_HOST_CALL functionWsonIdentifierCacheStats(ExecState* exec){
+    VM& vm = exec->vm();
+    wson::IdentifierCacheStats stats = wson::identifierCacheStats(&vm);
+    JSObject* result = constructEmptyObject(exec);
+    result->putDirect(vm, Identifier::fromString(&vm, "hits"), jsNumber(stats.hits));
+    result->putDirect(vm, Identifier::fromString(&vm, "misses"), jsNumber(stats.misses));
+    result->putDirect(vm, Identifier::fromString(&vm, "evictions"), jsNumber(stats.evictions));
+    return JSValue::encode(result);
+}
+
 EncodedJSValue JSC_HOST_CALL functionParseWson(ExecState* exec)
 {
     VM& vm = exec->vm();
@@ -375,10 +414,8 @@ EncodedJSValue JSC_HOST_CALL functionParseWson(ExecState* exec)
         printf("error type wson in parse wson \n");
         return JSValue::encode(jsNull());
     }
-    JSUint8Array* array = (JSUint8Array*)asObject(value);
-    uint8_t* ptr = array->typedVector();
-    wson_buffer* buffer = wson_buffer_from(ptr, array->byteLength());
-    JSValue result = wson::toJSValue(exec, buffer);
+    uint32_t lazyBytes = exec->argument(1).isNumber() ? exec->argument(1).toUInt32(exec) : 0;
+    JSValue result = wson::toJSValueFromArrayBuffer(exec, value, lazyBytes);
     return JSValue::encode(result);
 }
 
@@ -389,15 +426,12 @@ EncodedJSValue JSC_HOST_CALL functionToWson(ExecState* exec)
     auto scope = DECLARE_THROW_SCOPE(vm);
     JSValue value = exec->argument(0);
     RETURN_IF_EXCEPTION(scope, encodedJSValue());
-    wson_buffer* buffer = wson::toWson(exec, value);;
+    wson::EncodeMode mode = exec->argument(1).toBoolean(exec) ? wson::EncodeSinglePass : wson::EncodeCompact;
+    RefPtr<ArrayBuffer> arrayBuffer = wson::toWsonArrayBuffer(exec, value, mode)->impl();
     Structure* structure = exec->lexicalGlobalObject()->typedArrayStructure(TypeUint8);
-    auto length = buffer->position;
-    const void* data = buffer->data;
-    JSObject* result = createUint8TypedArray(exec, structure, ArrayBuffer::createFromBytes(data, length, [] (void* p) {
-        free(p); }), 0, length);
+    unsigned length = arrayBuffer->byteLength();
+    JSObject* result = createUint8TypedArray(exec, structure, WTFMove(arrayBuffer), 0, length);
     RETURN_IF_EXCEPTION(scope, encodedJSValue());
-    buffer->data = NULL;
-    free(buffer);
     return JSValue::encode(result);
 }
 
@@ -131,6 +131,249 @@ var wsonTestSuit = {
         console.log("pass number type test ");
     },
     
+    /**
+     * same payload decode return shared frozen value
+     **/
+    testValueCache : function(){
+        var json = {"type":"template", "items":[], "style":{"width":750, "height":100}};
+        for(var i=0; i<20; i++){
+            json.items.push({"id":i, "text":"item " + i});
+        }
+        var wson = toWson(json);
+        wsonValueCache(1024*1024);
+        var first = parseWson(wson);
+        var second = parseWson(wson);
+        var stats = wsonValueCacheStats();
+        wsonValueCache(0);
+        if(first !== second || !Object.isFrozen(second.items[0]) || stats.hits != 1 || stats.misses != 1
+           || !treeEquals(json, second)){
+            quit("testValueCacheFailed hits " + stats.hits + " misses " + stats.misses + "\n");
+        }
+        console.log("pass value cache test ");
+    },
+
+    /**
+     * repeated keys should hit identifier cache
+     **/
+    testIdentifierCache : function(){
+        var json = [];
+        for(var i=0; i<100; i++){
+            json.push({"id":i, "name":"item", "price":i*2, "count":1, "checked":false});
+        }
+        var wson = toWson(json);
+        var before = wsonIdentifierCacheStats();
+        var back = parseWson(wson);
+        var after = wsonIdentifierCacheStats();
+        if(!treeEquals(json, back) || after.hits - before.hits < 490){
+            quit("testIdentifierCacheFailed hits " + (after.hits - before.hits) + "\n");
+        }
+        console.log("pass identifier cache test misses " + (after.misses - before.misses));
+    },
+
+    /**
+     * records with same keys share structure, index key and key order change still decode right
+     **/
+    testSharedStructure : function(){
+        var json = [];
+        for(var i=0; i<1000; i++){
+            json.push({"id":i, "title":"record " + i, "price":i/3, "tags":["a", "b"]});
+        }
+        json.push({"title":"other order", "id":-1});
+        json.push({"0":"index", "name":"index key"});
+        var wson = toWson(json);
+        var start = new Date().getTime();
+        var back;
+        for(var n=0; n<100; n++){
+            back = parseWson(wson);
+        }
+        var end = new Date().getTime();
+        back[1].extra = true;
+        if(!treeEquals(json, parseWson(wson)) || back[0].extra !== undefined){
+            quit("testSharedStructureFailed\n");
+        }
+        console.log("pass shared structure test used " + (end - start) + "ms");
+    },
+
+    testNumberArray : function(){
+        var ints = [];
+        var doubles = [];
+        var mixed = [];
+        for(var i=0; i<10000; i++){
+            ints.push(i*(i%2 == 0 ? 1 : -1));
+            doubles.push(i/7);
+            mixed.push(i%3 == 0 ? "item" + i : i);
+        }
+        doubles.push(NaN);
+        var wson = toWson({"ints":ints, "doubles":doubles, "mixed":mixed, "empty":[], "nans":[NaN, 0.5, NaN]});
+        var back = parseWson(wson);
+        back.ints.push("tail");
+        back.doubles[0] = {};
+        if(!treeEquals(ints, parseWson(toWson(ints))) || !treeEquals(mixed, back.mixed)
+           || back.ints.length != 10001 || back.doubles.length != 10001 || back.empty.length != 0
+           || back.doubles[7] != 1 || !isNaN(back.doubles[10000])
+           || back.nans.length != 3 || !isNaN(back.nans[0]) || back.nans[1] != 0.5 || !isNaN(back.nans[2])){
+            quit("testNumberArrayFailed\n");
+        }
+        console.log("pass number array test");
+    },
+
+    testSinglePassEncode : function(){
+        var json = {"name":"single pass", "skip":undefined, "fn":function(){}, "list":[]};
+        for(var i=0; i<200; i++){
+            json.list.push({"id":i, "child":{"value":i/3, "hidden":undefined}});
+        }
+        json.self = json;
+        json.list.push(json.list);
+        var compact = toWson(json);
+        var single = toWson(json, true);
+        var back = parseWson(single);
+        if(!treeEquals(parseWson(compact), back) || back.self !== null || back.fn !== undefined
+           || back.list[200] !== null || back.list[0].child.value !== 0){
+            quit("testSinglePassEncodeFailed\n");
+        }
+        console.log("pass single pass encode test compact " + compact.length + " single " + single.length);
+    },
+
+    testStructureEncode : function(){
+        var json = [];
+        for(var i=0; i<1000; i++){
+            json.push({"id":i, "name":"\u4e2d\u56fd" + i, "skip":undefined, "child":{"date":new Date(0)}});
+        }
+        var hidden = {"id":-1};
+        Object.defineProperty(hidden, "secret", {value:1, enumerable:false});
+        var accessor = {"id":-2, get name(){ return "getter"; }};
+        json.push(hidden, accessor);
+        var start = new Date().getTime();
+        var wson;
+        for(var n=0; n<100; n++){
+            wson = toWson(json);
+        }
+        var end = new Date().getTime();
+        var back = parseWson(wson);
+        if(!treeEquals(JSON.parse(JSON.stringify(json)), back) || back[1000].secret !== undefined
+           || back[1001].name != "getter" || "skip" in back[0]){
+            quit("testStructureEncodeFailed\n");
+        }
+        console.log("pass structure encode test used " + (end - start) + "ms");
+    },
+
+    testArrayBuffer : function(){
+        var json = {"name":"array buffer", "list":[1, 2.5, "three"]};
+        var wson = toWson(json);
+        var copy = new Uint8Array(new ArrayBuffer(wson.length + 8), 8, wson.length);
+        copy.set(wson);
+        if(!treeEquals(json, parseWson(wson.buffer)) || !treeEquals(json, parseWson(copy))
+           || parseWson(new ArrayBuffer(0)) !== null){
+            quit("testArrayBufferFailed\n");
+        }
+        if(typeof SharedArrayBuffer != "undefined"){
+            var shared = new Uint8Array(new SharedArrayBuffer(wson.length));
+            shared.set(wson);
+            if(!treeEquals(json, parseWson(shared.buffer))){
+                quit("testArrayBufferFailed shared\n");
+            }
+        }
+        console.log("pass array buffer test");
+    },
+
+    testBinary : function(){
+        var bytes = new Uint8Array([0, 255, 16, 119, 115]);
+        var back = parseWson(toWson({"blob":bytes.buffer, "name":"binary"}));
+        var view = new Uint8Array(back.blob);
+        if(!(back.blob instanceof ArrayBuffer) || view.length != 5 || view[1] != 255 || view[4] != 115
+           || back.name != "binary"){
+            quit("testBinaryFailed\n");
+        }
+        console.log("pass binary test");
+    },
+
+    testLazyDecode : function(){
+        var json = {"name":"lazy", "items":[], "detail":{"small":{"id":1}}};
+        for(var i=0; i<64; i++){
+            json.items.push({"id":i, "title":"item title " + i, "tags":["a", "b"]});
+            json.detail["key" + i] = {"value":i, "text":"detail text " + i};
+        }
+        var wson = toWson(json);
+        var back = parseWson(wson.buffer, 256);
+        if(back.name != "lazy" || back.items.length != 64 || back.items[63].title != "item title 63"){
+            quit("testLazyDecodeFailed top level\n");
+        }
+        var relay = toWson(back);
+        if(relay.length != wson.length || !treeEquals(json, parseWson(relay.buffer))){
+            quit("testLazyDecodeFailed relay\n");
+        }
+        back.detail.extra = "extra";
+        if(back.detail.extra != "extra" || back.detail.key10.value != 10
+           || Object.keys(back.detail).length != 66 || !("small" in back.detail)){
+            quit("testLazyDecodeFailed write\n");
+        }
+        var copy = parseWson(wson.buffer, 256);
+        if(!treeEquals(json, copy) || JSON.stringify(copy) != JSON.stringify(json)){
+            quit("testLazyDecodeFailed equals\n");
+        }
+        console.log("pass lazy decode test");
+    },
+
+    testToJSONCache : function(){
+        var Point = function(x){
+            this.x = x;
+        };
+        var points = [new Point(1), new Point(2)];
+        for(var i=0; i<3; i++){
+            if(parseWson(toWson(points))[1].x != 2){
+                quit("testToJSONCacheFailed absent\n");
+            }
+        }
+        Point.prototype.toJSON = function(){
+            return "point " + this.x;
+        };
+        var back = parseWson(toWson(points));
+        if(back[0] != "point 1" || back[1] != "point 2"){
+            quit("testToJSONCacheFailed prototype\n");
+        }
+        delete Point.prototype.toJSON;
+        points[0].toJSON = function(){
+            return "own";
+        };
+        back = parseWson(toWson(points));
+        if(back[0] != "own" || back[1].x != 2){
+            quit("testToJSONCacheFailed own\n");
+        }
+        console.log("pass toJSON cache test");
+    },
+
+    testSparseArray : function(){
+        var sparse = [];
+        sparse[5] = "five";
+        sparse[1000000] = {"id":1};
+        var back = parseWson(toWson(sparse));
+        if(back.length != 1000001 || back[5] != "five" || back[1000000].id != 1
+           || back[0] !== null || back[6] !== null){
+            quit("testSparseArrayFailed sparse\n");
+        }
+        var holey = [1, , 3];
+        var doubles = [1.5, , 2.5];
+        var objects = [{"a":1}, , "text"];
+        back = parseWson(toWson([holey, doubles, objects]));
+        if(back[0][1] !== null || back[0][2] != 3 || back[1][1] !== null || back[1][2] != 2.5
+           || back[2][1] !== null || back[2][0].a != 1){
+            quit("testSparseArrayFailed holey\n");
+        }
+        var truncated = [1, 2];
+        truncated.length = 10000000;
+        var allocated = new Array(10000000);
+        allocated[0] = "first";
+        allocated[3] = 3;
+        var start = new Date().getTime();
+        back = parseWson(toWson([truncated, allocated]));
+        var used = new Date().getTime() - start;
+        if(back[0].length != 10000000 || back[0][1] != 2 || back[0][2] !== null || back[0][9999999] !== null
+           || back[1].length != 10000000 || back[1][0] != "first" || back[1][3] != 3 || back[1][9999999] !== null){
+            quit("testSparseArrayFailed storage tail\n");
+        }
+        console.log("pass sparse array test, storage tail used " + used + "ms");
+    },
+
     testString : function(){
         var _self = this;
         _self.testNormal("中国");
@@ -421,6 +664,17 @@ function runWsonTestSuit(){
     console.log(JSON.stringify(back));
     
     
+    wsonTestSuit.testValueCache();
+    wsonTestSuit.testIdentifierCache();
+    wsonTestSuit.testSharedStructure();
+    wsonTestSuit.testNumberArray();
+    wsonTestSuit.testSinglePassEncode();
+    wsonTestSuit.testStructureEncode();
+    wsonTestSuit.testArrayBuffer();
+    wsonTestSuit.testBinary();
+    wsonTestSuit.testLazyDecode();
+    wsonTestSuit.testToJSONCache();
+    wsonTestSuit.testSparseArray();
     /**
     wsonTestSuit.testDateType();
     wsonTestSuit.testNumber();